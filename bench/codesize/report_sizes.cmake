@@ -0,0 +1,34 @@
+#
+# Prints the code size of functions in an object file.
+#
+# Usage: cmake -DNM=<nm> -DOBJ=<file.o> -DSYMBOLS=<a,b,...> -P report_sizes.cmake
+#
+# The hot size is that of the symbol itself; GCC moves blocks it considers
+# unlikely into a separate <symbol>.cold fragment, reported on its own.
+#
+
+execute_process(COMMAND ${NM} -S ${OBJ}
+  OUTPUT_VARIABLE listing
+  RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+  message(FATAL_ERROR "${NM} failed on ${OBJ}")
+endif()
+
+string(REPLACE "\n" ";" lines "${listing}")
+
+function(symbol_size name out)
+  set(size 0)
+  foreach(line IN LISTS lines)
+    if(line MATCHES "^[0-9a-fA-F]+ ([0-9a-fA-F]+) [tTwW] _?${name}$")
+      math(EXPR size "0x${CMAKE_MATCH_1}")
+    endif()
+  endforeach()
+  set(${out} ${size} PARENT_SCOPE)
+endfunction()
+
+string(REPLACE "," ";" SYMBOLS "${SYMBOLS}")
+foreach(sym IN LISTS SYMBOLS)
+  symbol_size(${sym} hot)
+  symbol_size(${sym}.cold cold)
+  message(STATUS "${sym}: ${hot} bytes hot, ${cold} bytes cold")
+endforeach()
@@ -0,0 +1,54 @@
+#
+# Writes a translation unit that instantiates COUNT distinct expected
+# specializations, each used the way ordinary code uses it: constructed from a
+# value and from an error, copied, converted, assigned across alternatives and
+# transformed.
+#
+# Usage: cmake -DCOUNT=<n> -DOUT=<file.cpp> -P generate.cmake
+#
+
+if(NOT COUNT)
+  set(COUNT 1000)
+endif()
+
+set(source "// Generated by generate.cmake; do not edit.\n\n")
+string(APPEND source "#include <expected/expected.hpp>\n\n")
+string(APPEND source "#include <string>\n#include <utility>\n\n")
+
+math(EXPR last "${COUNT} - 1")
+foreach(i RANGE ${last})
+  string(APPEND source "\
+struct value_${i} {
+    int v;
+    std::string s;
+};
+struct error_${i} {
+    int code;
+};
+struct wide_error_${i} {
+    wide_error_${i}(const error_${i}& e) : code(e.code) {}
+    long code;
+};
+
+bst::expected<value_${i}, error_${i}> make_${i}(int x) {
+    if (x > ${i})
+        return value_${i}{x, {}};
+    return bst::unexpected(error_${i}{x});
+}
+
+int use_${i}(int x) {
+    auto r = make_${i}(x);
+    auto c = r;
+    c = std::move(r);
+    bst::expected<value_${i}, error_${i}> d = bst::unexpected(error_${i}{1});
+    d = c;
+    bst::expected<value_${i}, wide_error_${i}> w(d);
+    bst::expected<void, error_${i}> v = bst::unexpected(error_${i}{2});
+    return w.transform([](const value_${i}& u) { return u.v; }).value_or(0) +
+           v.has_value();
+}
+
+")
+endforeach()
+
+file(WRITE ${OUT} "${source}")
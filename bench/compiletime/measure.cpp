@@ -0,0 +1,56 @@
+//
+// Runs a command and reports how long it took and the peak resident memory of
+// the processes it started, for timing the compiler on the translation unit
+// written by generate.cmake.
+//
+// Usage: std-expected-compile-time-driver <label> <command> [args...]
+//
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::fprintf(stderr, "usage: %s <label> <command> [args...]\n",
+                     argv[0]);
+        return 2;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const pid_t pid = fork();
+    if (pid == 0) {
+        execvp(argv[2], argv + 2);
+        std::perror(argv[2]);
+        std::_Exit(127);
+    }
+    if (pid < 0) {
+        std::perror("fork");
+        return 1;
+    }
+
+    int status = 0;
+    rusage usage{};
+    wait4(pid, &status, 0, &usage);
+    const std::chrono::duration<double> wall =
+        std::chrono::steady_clock::now() - start;
+
+    // Collects the compiler proper, which the driver waited for in turn.
+    rusage children{};
+    getrusage(RUSAGE_CHILDREN, &children);
+    long peak_kb = children.ru_maxrss > usage.ru_maxrss ? children.ru_maxrss
+                                                        : usage.ru_maxrss;
+#ifdef __APPLE__
+    peak_kb /= 1024; // reported in bytes
+#endif
+
+    std::printf("%s: %.2f s wall, %ld MB peak\n", argv[1], wall.count(),
+                peak_kb / 1024);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        return 1;
+    return 0;
+}
@@ -0,0 +1,93 @@
+//
+// Value/error flips through assignment when the alternatives may throw, with
+// the default strong guarantee and with expected_basic_guarantee.
+//
+// The value is a large record that is nothrow copyable, the error a
+// diagnostic whose copies and moves may throw. Under the strong guarantee,
+// switching from the value to the error first moves the record aside so
+// that it can be restored; under the basic guarantee the diagnostic is
+// built in place. Each iteration does one flip in each direction.
+//
+
+#include <expected/expected.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace {
+
+struct record {
+    std::array<std::byte, 512> bytes{};
+};
+
+// Tag keeps the two policies apart as distinct error types.
+template <int Tag>
+struct diagnostic {
+    diagnostic() noexcept = default;
+    explicit diagnostic(std::string what) noexcept(false)
+        : what(std::move(what)) {}
+    diagnostic(const diagnostic&) noexcept(false) = default;
+    diagnostic(diagnostic&& rhs) noexcept(false) : what(std::move(rhs.what)) {}
+    diagnostic& operator=(const diagnostic&) = default;
+    diagnostic& operator=(diagnostic&&) = default;
+
+    std::string what;
+};
+
+using strong_diagnostic = diagnostic<0>;
+using basic_diagnostic = diagnostic<1>;
+
+} // namespace
+
+template <>
+struct bst::expected_basic_guarantee<record, basic_diagnostic>
+    : std::true_type {};
+
+namespace {
+
+template <class Diagnostic>
+void BM_CopyAssignFlip(benchmark::State& state) {
+    using E = bst::expected<record, Diagnostic>;
+    const E value(std::in_place);
+    const E error(bst::unexpect, "diagnostic text beyond the inline buffer");
+    E target(value);
+
+    for (auto _ : state) {
+        target = error;
+        benchmark::DoNotOptimize(target);
+        target = value;
+        benchmark::DoNotOptimize(target);
+    }
+}
+
+template <class Diagnostic>
+void BM_UnexpectedAssignFlip(benchmark::State& state) {
+    using E = bst::expected<record, Diagnostic>;
+    const bst::unexpected<Diagnostic> error(
+        std::in_place, "diagnostic text beyond the inline buffer");
+    const record value{};
+    E target(value);
+
+    for (auto _ : state) {
+        target = error;
+        benchmark::DoNotOptimize(target);
+        target = value;
+        benchmark::DoNotOptimize(target);
+    }
+}
+
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_CopyAssignFlip, strong_diagnostic)
+    ->Name("BM_CopyAssignFlip/strong");
+BENCHMARK_TEMPLATE(BM_CopyAssignFlip, basic_diagnostic)
+    ->Name("BM_CopyAssignFlip/basic");
+BENCHMARK_TEMPLATE(BM_UnexpectedAssignFlip, strong_diagnostic)
+    ->Name("BM_UnexpectedAssignFlip/strong");
+BENCHMARK_TEMPLATE(BM_UnexpectedAssignFlip, basic_diagnostic)
+    ->Name("BM_UnexpectedAssignFlip/basic");
@@ -0,0 +1,275 @@
+//
+// bst::expected against the alternatives: std::expected (when the standard
+// library provides it), exceptions and std::error_code out-parameters.
+//
+// Build the std-expected-bench-csv target, or run with
+// --benchmark_out=<file> --benchmark_out_format=csv, to record the results
+// for regression tracking.
+//
+
+#include <expected/expected.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <random>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#if __has_include(<expected>)
+#include <expected>
+#endif
+
+#if defined(__cpp_lib_expected) && __cpp_lib_expected >= 202202L
+#define BST_BENCH_HAS_STD_EXPECTED
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define BST_BENCH_NOINLINE [[gnu::noinline]]
+#elif defined(_MSC_VER)
+#define BST_BENCH_NOINLINE __declspec(noinline)
+#else
+#define BST_BENCH_NOINLINE
+#endif
+
+namespace {
+
+//
+// Each family names an expected template and its unexpect tag, so that the
+// same benchmark bodies run against bst::expected and std::expected.
+//
+
+struct bst_family {
+    template <class T, class E>
+    using expected = bst::expected<T, E>;
+    template <class E>
+    using unexpected = bst::unexpected<E>;
+    static constexpr bst::unexpect_t unexpect = bst::unexpect;
+};
+
+#ifdef BST_BENCH_HAS_STD_EXPECTED
+struct std_family {
+    template <class T, class E>
+    using expected = std::expected<T, E>;
+    template <class E>
+    using unexpected = std::unexpected<E>;
+    static constexpr std::unexpect_t unexpect = std::unexpect;
+};
+#endif
+
+const std::error_code failure = std::make_error_code(std::errc::invalid_argument);
+
+// A pattern of failures with the given percentage, repeated by the loops.
+std::vector<char> failure_pattern(int percent) {
+    std::mt19937 gen(42);
+    std::bernoulli_distribution fail(percent / 100.0);
+    std::vector<char> v(1024);
+    for (auto& f : v)
+        f = fail(gen);
+    return v;
+}
+
+//------------------------------------------------------------------------------
+// Construction, assignment, swap and value_or
+
+template <class F>
+void BM_Construct(benchmark::State& state) {
+    using E = typename F::template expected<std::string, std::error_code>;
+    const std::string value = "short value";
+    const bool error = state.range(0) != 0;
+
+    for (auto _ : state) {
+        if (error) {
+            E e(F::unexpect, failure);
+            benchmark::DoNotOptimize(e);
+        } else {
+            E e(value);
+            benchmark::DoNotOptimize(e);
+        }
+    }
+}
+
+// Each iteration flips the target from value to error and back, which goes
+// through reinit_expected in both directions.
+template <class F>
+void BM_CopyAssignFlip(benchmark::State& state) {
+    using E = typename F::template expected<std::string, std::error_code>;
+    const E value("short value");
+    const E error(F::unexpect, failure);
+    E target(value);
+
+    for (auto _ : state) {
+        target = error;
+        benchmark::DoNotOptimize(target);
+        target = value;
+        benchmark::DoNotOptimize(target);
+    }
+}
+
+template <class F>
+void BM_MoveAssignFlip(benchmark::State& state) {
+    using E = typename F::template expected<std::string, std::error_code>;
+    E target("short value");
+
+    for (auto _ : state) {
+        target = E(F::unexpect, failure);
+        benchmark::DoNotOptimize(target);
+        target = E("short value");
+        benchmark::DoNotOptimize(target);
+    }
+}
+
+template <class F>
+void BM_SwapMixed(benchmark::State& state) {
+    using E = typename F::template expected<std::string, std::error_code>;
+    E a("short value");
+    E b(F::unexpect, failure);
+
+    for (auto _ : state) {
+        a.swap(b);
+        benchmark::DoNotOptimize(a);
+        benchmark::DoNotOptimize(b);
+    }
+}
+
+template <class F>
+void BM_ValueOr(benchmark::State& state) {
+    using E = typename F::template expected<int, std::error_code>;
+    std::vector<E> v;
+    int i = 0;
+    for (char fail : failure_pattern(static_cast<int>(state.range(0)))) {
+        if (fail)
+            v.emplace_back(F::unexpect, failure);
+        else
+            v.emplace_back(i++);
+    }
+
+    for (auto _ : state) {
+        long sum = 0;
+        for (const auto& e : v)
+            sum += e.value_or(0);
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * v.size());
+}
+
+//------------------------------------------------------------------------------
+// Error propagation through depth frames, failing at the bottom at the given
+// percentage of calls.
+
+template <class F>
+BST_BENCH_NOINLINE typename F::template expected<int, std::error_code>
+propagate_expected(int depth, bool fail) {
+    using unexpected = typename F::template unexpected<std::error_code>;
+    if (depth == 0) {
+        if (fail)
+            return unexpected(failure);
+        return 0;
+    }
+    auto r = propagate_expected<F>(depth - 1, fail);
+    if (!r)
+        return unexpected(std::move(r).error());
+    return *r + 1;
+}
+
+struct failure_exception {
+    std::error_code code;
+};
+
+BST_BENCH_NOINLINE int propagate_exception(int depth, bool fail) {
+    if (depth == 0) {
+        if (fail)
+            throw failure_exception{failure};
+        return 0;
+    }
+    return propagate_exception(depth - 1, fail) + 1;
+}
+
+BST_BENCH_NOINLINE int propagate_error_code(int depth, bool fail,
+                                            std::error_code& ec) {
+    if (depth == 0) {
+        if (fail)
+            ec = failure;
+        return 0;
+    }
+    int r = propagate_error_code(depth - 1, fail, ec);
+    if (ec)
+        return 0;
+    return r + 1;
+}
+
+template <class F>
+void BM_PropagateExpected(benchmark::State& state) {
+    const int depth = static_cast<int>(state.range(0));
+    const auto pattern = failure_pattern(static_cast<int>(state.range(1)));
+    std::size_t i = 0;
+
+    for (auto _ : state) {
+        auto r = propagate_expected<F>(depth, pattern[i++ % pattern.size()]);
+        benchmark::DoNotOptimize(r);
+    }
+}
+
+void BM_PropagateException(benchmark::State& state) {
+    const int depth = static_cast<int>(state.range(0));
+    const auto pattern = failure_pattern(static_cast<int>(state.range(1)));
+    std::size_t i = 0;
+
+    for (auto _ : state) {
+        try {
+            int r = propagate_exception(depth, pattern[i++ % pattern.size()]);
+            benchmark::DoNotOptimize(r);
+        } catch (const failure_exception& e) {
+            benchmark::DoNotOptimize(e.code);
+        }
+    }
+}
+
+void BM_PropagateErrorCode(benchmark::State& state) {
+    const int depth = static_cast<int>(state.range(0));
+    const auto pattern = failure_pattern(static_cast<int>(state.range(1)));
+    std::size_t i = 0;
+
+    for (auto _ : state) {
+        std::error_code ec;
+        int r = propagate_error_code(depth, pattern[i++ % pattern.size()], ec);
+        benchmark::DoNotOptimize(r);
+        benchmark::DoNotOptimize(ec);
+    }
+}
+
+void propagation_args(benchmark::internal::Benchmark* b) {
+    b->ArgNames({"depth", "error_pct"});
+    b->ArgsProduct({{1, 4, 16, 64}, {0, 1, 10, 50}});
+}
+
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_Construct, bst_family)->ArgName("error")->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_CopyAssignFlip, bst_family);
+BENCHMARK_TEMPLATE(BM_MoveAssignFlip, bst_family);
+BENCHMARK_TEMPLATE(BM_SwapMixed, bst_family);
+BENCHMARK_TEMPLATE(BM_ValueOr, bst_family)
+    ->ArgName("error_pct")
+    ->Arg(0)
+    ->Arg(10)
+    ->Arg(50);
+BENCHMARK_TEMPLATE(BM_PropagateExpected, bst_family)->Apply(propagation_args);
+
+#ifdef BST_BENCH_HAS_STD_EXPECTED
+BENCHMARK_TEMPLATE(BM_Construct, std_family)->ArgName("error")->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_CopyAssignFlip, std_family);
+BENCHMARK_TEMPLATE(BM_MoveAssignFlip, std_family);
+BENCHMARK_TEMPLATE(BM_SwapMixed, std_family);
+BENCHMARK_TEMPLATE(BM_ValueOr, std_family)
+    ->ArgName("error_pct")
+    ->Arg(0)
+    ->Arg(10)
+    ->Arg(50);
+BENCHMARK_TEMPLATE(BM_PropagateExpected, std_family)->Apply(propagation_args);
+#endif
+
+BENCHMARK(BM_PropagateException)->Apply(propagation_args);
+BENCHMARK(BM_PropagateErrorCode)->Apply(propagation_args);
@@ -0,0 +1,100 @@
+//
+// Error propagation written three ways: hand-written branches, BST_TRY, and
+// co_await in a coroutine returning expected.
+//
+// Each variant calls three fallible leaves and sums their values; the
+// failure pattern is shared, so the variants do the same work. The
+// coroutine numbers include allocating and freeing the frame whenever the
+// compiler does not elide it.
+//
+
+#include <expected/coroutine.hpp>
+#include <expected/try.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+using result = bst::expected<int, std::string>;
+
+[[gnu::noinline]] result leaf(int v, bool fail) {
+    if (fail)
+        return bst::unexpected(std::string("leaf failed"));
+    return v;
+}
+
+[[gnu::noinline]] result manual(int v, const char* fail) {
+    auto a = leaf(v, fail[0]);
+    if (!a)
+        return bst::unexpected(std::move(a).error());
+    auto b = leaf(v + 1, fail[1]);
+    if (!b)
+        return bst::unexpected(std::move(b).error());
+    auto c = leaf(v + 2, fail[2]);
+    if (!c)
+        return bst::unexpected(std::move(c).error());
+    return *a + *b + *c;
+}
+
+#ifdef BST_TRY
+[[gnu::noinline]] result with_try(int v, const char* fail) {
+    return BST_TRY(leaf(v, fail[0])) + BST_TRY(leaf(v + 1, fail[1])) +
+           BST_TRY(leaf(v + 2, fail[2]));
+}
+#endif
+
+[[gnu::noinline]] result with_co_await(int v, const char* fail) {
+    int a = co_await leaf(v, fail[0]);
+    int b = co_await leaf(v + 1, fail[1]);
+    int c = co_await leaf(v + 2, fail[2]);
+    co_return a + b + c;
+}
+
+// Each leaf fails at percent / 3 percent, so about percent of the calls fail.
+std::vector<char> failure_pattern(int percent) {
+    std::mt19937 gen(7);
+    std::bernoulli_distribution fail(percent / 300.0);
+    std::vector<char> v(3 * 1024);
+    for (auto& f : v)
+        f = fail(gen);
+    return v;
+}
+
+template <result (*F)(int, const char*)>
+void BM_Propagate(benchmark::State& state) {
+    const auto pattern = failure_pattern(static_cast<int>(state.range(0)));
+    std::size_t i = 0;
+    for (auto _ : state) {
+        auto r = F(static_cast<int>(i), pattern.data() + i);
+        benchmark::DoNotOptimize(r);
+        i = (i + 3) % pattern.size();
+    }
+}
+
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_Propagate, manual)
+    ->Name("BM_Propagate/manual")
+    ->ArgName("error_pct")
+    ->Arg(0)
+    ->Arg(10)
+    ->Arg(50);
+#ifdef BST_TRY
+BENCHMARK_TEMPLATE(BM_Propagate, with_try)
+    ->Name("BM_Propagate/bst_try")
+    ->ArgName("error_pct")
+    ->Arg(0)
+    ->Arg(10)
+    ->Arg(50);
+#endif
+BENCHMARK_TEMPLATE(BM_Propagate, with_co_await)
+    ->Name("BM_Propagate/co_await")
+    ->ArgName("error_pct")
+    ->Arg(0)
+    ->Arg(10)
+    ->Arg(50);
@@ -0,0 +1,132 @@
+//
+// Failure paths with bst::error against the usual heterogeneous error types:
+// a heap-allocated polymorphic error, and a std::variant of domain errors.
+//
+// Each benchmark reports allocs_per_iter, counted by the replacement global
+// operator new below; for bst::error it is zero.
+//
+
+#include <expected/error.hpp>
+#include <expected/expected.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <string>
+#include <variant>
+
+namespace {
+
+std::atomic<std::size_t> allocations{0};
+
+} // namespace
+
+// Kept out of line: once these are inlined, GCC sees malloc paired with
+// operator delete, or operator new with free, and warns that they mismatch.
+[[gnu::noinline]] void* operator new(std::size_t n) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(n ? n : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+[[gnu::noinline]] void operator delete(void* p) noexcept { std::free(p); }
+[[gnu::noinline]] void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+enum class db_errc { timeout = 1, conflict };
+enum class net_errc { refused = 1, reset };
+
+class db_domain final : public bst::error_domain {
+public:
+    const char* name() const noexcept override { return "db"; }
+    std::string message(const bst::error& e) const override {
+        return "db error " + std::to_string(e.code());
+    }
+};
+
+const bst::error_domain& error_domain_of(db_errc) {
+    static const db_domain domain;
+    return domain;
+}
+
+// The polymorphic alternative.
+struct error_base {
+    virtual ~error_base() = default;
+    virtual int code() const noexcept = 0;
+};
+
+struct db_error final : error_base {
+    explicit db_error(db_errc e) : e(e) {}
+    int code() const noexcept override { return static_cast<int>(e); }
+    db_errc e;
+};
+
+// The variant alternative.
+struct db_err {
+    db_errc e;
+};
+struct net_err {
+    net_errc e;
+};
+struct parse_err {
+    std::uint32_t offset;
+    std::uint32_t length;
+};
+
+using erased_result = bst::expected<int, bst::error>;
+using polymorphic_result = bst::expected<int, std::unique_ptr<error_base>>;
+using variant_result =
+    bst::expected<int, std::variant<db_err, net_err, parse_err>>;
+
+[[gnu::noinline]] erased_result fail_erased(int i) {
+    if (i & 1)
+        return bst::unexpected(bst::error(db_errc::timeout));
+    return bst::unexpected(bst::error(db_errc::conflict));
+}
+
+[[gnu::noinline]] polymorphic_result fail_polymorphic(int i) {
+    return bst::unexpected<std::unique_ptr<error_base>>(
+        std::make_unique<db_error>(i & 1 ? db_errc::timeout
+                                         : db_errc::conflict));
+}
+
+[[gnu::noinline]] variant_result fail_variant(int i) {
+    return bst::unexpected(std::variant<db_err, net_err, parse_err>(
+        db_err{i & 1 ? db_errc::timeout : db_errc::conflict}));
+}
+
+template <class Result, Result (*Fail)(int)>
+void BM_Fail(benchmark::State& state) {
+    const auto before = allocations.load(std::memory_order_relaxed);
+    int i = 0;
+    for (auto _ : state) {
+        Result r = Fail(++i);
+        benchmark::DoNotOptimize(r);
+        // Copy the error on, as a caller propagating it would.
+        Result copy = bst::unexpected(std::move(r).error());
+        benchmark::DoNotOptimize(copy);
+    }
+    const auto after = allocations.load(std::memory_order_relaxed);
+    state.counters["allocs_per_iter"] = benchmark::Counter(
+        static_cast<double>(after - before),
+        benchmark::Counter::kAvgIterations);
+    state.counters["error_size"] =
+        static_cast<double>(sizeof(typename Result::error_type));
+}
+
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_Fail, erased_result, fail_erased)
+    ->Name("BM_Fail/bst_error");
+BENCHMARK_TEMPLATE(BM_Fail, polymorphic_result, fail_polymorphic)
+    ->Name("BM_Fail/unique_ptr");
+BENCHMARK_TEMPLATE(BM_Fail, variant_result, fail_variant)
+    ->Name("BM_Fail/variant");
@@ -0,0 +1,110 @@
+//
+// Bulk state queries on std::vector<expected> against expected_array.
+//
+// The vector tests has_value() element by element, with the flag interleaved
+// with the payload; expected_array answers the same queries from its packed
+// validity bitmap. One slot in eight holds an error.
+//
+
+#include <expected/expected_array.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+enum class errc : int { failed = 1 };
+
+using result = bst::expected<std::int64_t, errc>;
+
+std::vector<result> make_vector(std::int64_t n) {
+    std::vector<result> v;
+    v.reserve(static_cast<std::size_t>(n));
+    for (std::int64_t i = 0; i < n; ++i) {
+        if (i % 8 == 5)
+            v.emplace_back(bst::unexpect, errc::failed);
+        else
+            v.emplace_back(i);
+    }
+    return v;
+}
+
+void BM_CountVector(benchmark::State& state) {
+    const auto v = make_vector(state.range(0));
+    for (auto _ : state) {
+        auto n = std::count_if(v.begin(), v.end(),
+                               [](const result& e) { return e.has_value(); });
+        benchmark::DoNotOptimize(n);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_CountArray(benchmark::State& state) {
+    const auto v = make_vector(state.range(0));
+    const bst::expected_array<std::int64_t, errc> a(v.begin(), v.end());
+    for (auto _ : state) {
+        auto n = a.count_values();
+        benchmark::DoNotOptimize(n);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_PartitionVector(benchmark::State& state) {
+    const auto v = make_vector(state.range(0));
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto w = v;
+        state.ResumeTiming();
+        auto it = std::partition(w.begin(), w.end(), [](const result& e) {
+            return e.has_value();
+        });
+        benchmark::DoNotOptimize(it);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_PartitionArray(benchmark::State& state) {
+    const auto v = make_vector(state.range(0));
+    const bst::expected_array<std::int64_t, errc> a(v.begin(), v.end());
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto w = a;
+        state.ResumeTiming();
+        auto n = w.partition();
+        benchmark::DoNotOptimize(n);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_ValuesOrVector(benchmark::State& state) {
+    const auto v = make_vector(state.range(0));
+    std::vector<std::int64_t> out(v.size());
+    for (auto _ : state) {
+        std::transform(v.begin(), v.end(), out.begin(),
+                       [](const result& e) { return e.value_or(0); });
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_ValuesOrArray(benchmark::State& state) {
+    const auto v = make_vector(state.range(0));
+    const bst::expected_array<std::int64_t, errc> a(v.begin(), v.end());
+    for (auto _ : state) {
+        auto out = a.values_or(0);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+} // namespace
+
+BENCHMARK(BM_CountVector)->Range(1 << 10, 1 << 20);
+BENCHMARK(BM_CountArray)->Range(1 << 10, 1 << 20);
+BENCHMARK(BM_PartitionVector)->Range(1 << 10, 1 << 20);
+BENCHMARK(BM_PartitionArray)->Range(1 << 10, 1 << 20);
+BENCHMARK(BM_ValuesOrVector)->Range(1 << 10, 1 << 20);
+BENCHMARK(BM_ValuesOrArray)->Range(1 << 10, 1 << 20);
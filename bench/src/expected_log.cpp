@@ -0,0 +1,143 @@
+//
+// An expected_log of 128M 16-byte records, 1% of them errors: a little over
+// 2 GiB of values on local disk. Appending them all and flushing, and then
+// reading the file back with cold caches: scanning only the errors, which
+// reads the bitmaps, indexes and errors, against reading every entry.
+//
+// The file is written to the directory named by BST_BENCH_LOG_DIR, or else
+// the temporary directory, and removed at exit. Before each scan the file's
+// pages are dropped from the page cache, so the scans read from the disk.
+// Each benchmark runs once.
+//
+
+#include <expected/expected_log.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <random>
+#include <system_error>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+enum class errc : std::int32_t { failed = 1 };
+
+struct record {
+    std::int64_t id;
+    double amount;
+};
+
+using log_type = bst::expected_log<record, errc>;
+
+constexpr std::uint64_t entries = std::uint64_t(1) << 27;
+
+struct log_file {
+    std::filesystem::path path;
+
+    log_file() {
+        const char* dir = std::getenv("BST_BENCH_LOG_DIR");
+        path = (dir ? std::filesystem::path(dir)
+                    : std::filesystem::temp_directory_path()) /
+               "bst_expected_log_bench.log";
+    }
+
+    ~log_file() {
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+    }
+};
+
+const log_file file;
+
+// Appends the entries, with errors scattered at random, and flushes.
+bool write_log() {
+    auto log = log_type::create(file.path);
+    if (!log)
+        return false;
+    std::mt19937_64 gen(3);
+    std::bernoulli_distribution fail(0.01);
+    for (std::uint64_t i = 0; i < entries; ++i) {
+        const auto pushed =
+            fail(gen) ? log->push_back(bst::unexpected(errc::failed))
+                      : log->push_back(record{static_cast<std::int64_t>(i),
+                                              0.5 * static_cast<double>(i)});
+        if (!pushed)
+            return false;
+    }
+    return log->flush().has_value();
+}
+
+void drop_cache() {
+    const int fd = ::open(file.path.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        ::close(fd);
+    }
+}
+
+void set_counters(benchmark::State& state) {
+    state.SetItemsProcessed(state.iterations() *
+                            static_cast<std::int64_t>(entries));
+    state.counters["file_GiB"] =
+        static_cast<double>(std::filesystem::file_size(file.path)) /
+        (1 << 30);
+}
+
+void BM_LogAppend(benchmark::State& state) {
+    for (auto _ : state) {
+        if (!write_log())
+            state.SkipWithError("cannot write the log");
+    }
+    set_counters(state);
+}
+
+template <bool ErrorsOnly>
+void BM_LogScan(benchmark::State& state) {
+    if (!std::filesystem::exists(file.path) && !write_log()) {
+        state.SkipWithError("cannot write the log");
+        return;
+    }
+    for (auto _ : state) {
+        state.PauseTiming();
+        drop_cache();
+        state.ResumeTiming();
+
+        auto log = log_type::open(file.path);
+        if (!log) {
+            state.SkipWithError("cannot open the log");
+            break;
+        }
+        std::uint64_t sum = 0;
+        if constexpr (ErrorsOnly) {
+            log->for_each_error(
+                [&](std::uint64_t i, const errc& e) {
+                    sum += i + static_cast<std::uint64_t>(e);
+                });
+        } else {
+            for (std::uint64_t i = 0; i < log->size(); ++i) {
+                const auto x = (*log)[i];
+                sum += x ? static_cast<std::uint64_t>(x->id)
+                         : static_cast<std::uint64_t>(x.error());
+            }
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    set_counters(state);
+}
+
+void BM_LogScanErrors(benchmark::State& state) { BM_LogScan<true>(state); }
+void BM_LogScanAll(benchmark::State& state) { BM_LogScan<false>(state); }
+
+} // namespace
+
+BENCHMARK(BM_LogAppend)->Iterations(1)->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK(BM_LogScanErrors)->Iterations(1)->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK(BM_LogScanAll)->Iterations(1)->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
@@ -0,0 +1,79 @@
+//
+// Handing 16K results from a producer thread to a consumer, through one
+// bst::expected_slot or std::promise / std::future pair per result.
+//
+// Each iteration creates the slots or promises, starts the producer, and
+// waits for every result in order, so the cost of creating the shared state
+// is included. Every tenth result is an error.
+//
+
+#include <expected/expected_slot.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr std::size_t results = 1 << 14;
+
+using result = bst::expected<std::uint64_t, int>;
+
+result produce(std::size_t i) {
+    if (i % 10 == 0)
+        return bst::unexpected(static_cast<int>(i));
+    return i * 3;
+}
+
+std::uint64_t consume(const result& r) {
+    return r ? *r : static_cast<std::uint64_t>(r.error());
+}
+
+void BM_Promise(benchmark::State& state) {
+    for (auto _ : state) {
+        std::vector<std::promise<result>> promises(results);
+        std::vector<std::future<result>> futures;
+        futures.reserve(results);
+        for (auto& p : promises)
+            futures.push_back(p.get_future());
+
+        std::thread producer([&] {
+            for (std::size_t i = 0; i < results; ++i)
+                promises[i].set_value(produce(i));
+        });
+        std::uint64_t sum = 0;
+        for (auto& f : futures)
+            sum += consume(f.get());
+        producer.join();
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * results);
+}
+
+void BM_Slot(benchmark::State& state) {
+    for (auto _ : state) {
+        auto slots =
+            std::make_unique<bst::expected_slot<std::uint64_t, int>[]>(
+                results);
+
+        std::thread producer([&] {
+            for (std::size_t i = 0; i < results; ++i)
+                slots[i].publish(produce(i));
+        });
+        std::uint64_t sum = 0;
+        for (std::size_t i = 0; i < results; ++i)
+            sum += consume(slots[i].wait());
+        producer.join();
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * results);
+}
+
+} // namespace
+
+BENCHMARK(BM_Promise)->Unit(benchmark::kMicrosecond)->UseRealTime();
+BENCHMARK(BM_Slot)->Unit(benchmark::kMicrosecond)->UseRealTime();
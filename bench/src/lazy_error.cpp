@@ -0,0 +1,64 @@
+//
+// Failure-heavy loops with eager and lazy error payloads.
+//
+// Every call fails and the caller only checks has_value() before retrying,
+// which is where an eagerly formatted message is pure overhead. The Read
+// variants also look at the error, to show what materializing it costs.
+//
+
+#include <expected/lazy_error.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <cstdio>
+#include <string>
+
+namespace {
+
+struct parse_error {
+    int line;
+    std::string message;
+};
+
+std::string format_error(int line, const char* token) {
+    char buf[128];
+    std::snprintf(buf, sizeof buf, "line %d: unexpected token '%s' in input",
+                  line, token);
+    return buf;
+}
+
+[[gnu::noinline]] bst::expected<int, parse_error> parse_eager(int line) {
+    return bst::unexpected(parse_error{line, format_error(line, "}")});
+}
+
+[[gnu::noinline]] bst::expected<int, bst::lazy_error<parse_error>>
+parse_lazy(int line) {
+    return bst::unexpected_lazy(
+        [line] { return parse_error{line, format_error(line, "}")}; });
+}
+
+template <auto Parse>
+void BM_CheckOnly(benchmark::State& state) {
+    int line = 0;
+    for (auto _ : state) {
+        auto r = Parse(++line);
+        benchmark::DoNotOptimize(r.has_value());
+    }
+}
+
+template <auto Parse>
+void BM_ReadError(benchmark::State& state) {
+    int line = 0;
+    for (auto _ : state) {
+        auto r = Parse(++line);
+        const parse_error& e = r.error();
+        benchmark::DoNotOptimize(e.message.data());
+    }
+}
+
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_CheckOnly, parse_eager)->Name("BM_CheckOnly/eager");
+BENCHMARK_TEMPLATE(BM_CheckOnly, parse_lazy)->Name("BM_CheckOnly/lazy");
+BENCHMARK_TEMPLATE(BM_ReadError, parse_eager)->Name("BM_ReadError/eager");
+BENCHMARK_TEMPLATE(BM_ReadError, parse_lazy)->Name("BM_ReadError/lazy");
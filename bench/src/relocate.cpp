@@ -0,0 +1,62 @@
+//
+// Regrowth cost of std::vector against relocating_vector.
+//
+// std::vector moves and destroys each element when it reallocates, while
+// relocating_vector memmoves trivially relocatable elements. Both containers
+// start empty and grow by push_back, so the timings are dominated by the
+// reallocations.
+//
+
+#include <expected/relocate.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace {
+
+enum class errc : int { failed = 1 };
+
+using small_result = bst::expected<std::unique_ptr<int>, errc>;
+using large_result = bst::expected<std::unique_ptr<int>, std::shared_ptr<int>>;
+
+template <class Vector>
+void grow(benchmark::State& state) {
+    using result = typename Vector::value_type;
+    const auto n = state.range(0);
+
+    for (auto _ : state) {
+        Vector v;
+        for (std::int64_t i = 0; i < n; ++i) {
+            if (i % 8)
+                v.push_back(result(nullptr));
+            else
+                v.push_back(
+                    result(bst::unexpect, typename result::error_type{}));
+        }
+        benchmark::DoNotOptimize(v.data());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+void BM_StdVectorGrowSmall(benchmark::State& state) {
+    grow<std::vector<small_result>>(state);
+}
+void BM_RelocatingVectorGrowSmall(benchmark::State& state) {
+    grow<bst::relocating_vector<small_result>>(state);
+}
+void BM_StdVectorGrowLarge(benchmark::State& state) {
+    grow<std::vector<large_result>>(state);
+}
+void BM_RelocatingVectorGrowLarge(benchmark::State& state) {
+    grow<bst::relocating_vector<large_result>>(state);
+}
+
+} // namespace
+
+BENCHMARK(BM_StdVectorGrowSmall)->RangeMultiplier(16)->Range(16, 1 << 20);
+BENCHMARK(BM_RelocatingVectorGrowSmall)->RangeMultiplier(16)->Range(16, 1 << 20);
+BENCHMARK(BM_StdVectorGrowLarge)->RangeMultiplier(16)->Range(16, 1 << 20);
+BENCHMARK(BM_RelocatingVectorGrowLarge)->RangeMultiplier(16)->Range(16, 1 << 20);
@@ -0,0 +1,216 @@
+//
+// Throughput of the binary encodings of 1M expecteds, at error rates of 1%
+// and 10%: one record per expected, encoded, decoded into copies and read in
+// place, and the columnar encoding of the whole array, encoded, decoded and
+// read in place through its value column.
+//
+// The payloads are a 64-bit integer and a 24-byte struct. bytes_per_second
+// counts the bytes of the encoding, so the GB/s of the record and the column
+// runs compare the same work on different layouts. The error rate is given in
+// percent.
+//
+
+#include <expected/serialize.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace {
+
+enum class errc : int { failed = 1 };
+
+struct point {
+    double x, y, z;
+};
+
+constexpr std::size_t size = 1 << 20;
+
+template <class T>
+T make_value(std::size_t i) {
+    if constexpr (std::is_same_v<T, point>)
+        return {static_cast<double>(i), 1.0, 2.0};
+    else
+        return static_cast<T>(i);
+}
+
+template <class T>
+std::vector<bst::expected<T, errc>> make_input(std::int64_t percent) {
+    std::mt19937 gen(9);
+    std::bernoulli_distribution fail(static_cast<double>(percent) / 100);
+    std::vector<bst::expected<T, errc>> v;
+    v.reserve(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        if (fail(gen))
+            v.emplace_back(bst::unexpect, errc::failed);
+        else
+            v.emplace_back(make_value<T>(i));
+    }
+    return v;
+}
+
+double first_field(const point& p) { return p.x; }
+double first_field(std::int64_t x) { return static_cast<double>(x); }
+
+// Storage aligned for the encodings, and the bytes of it in use.
+struct buffer {
+    std::vector<std::uint64_t> words;
+    std::size_t used = 0;
+
+    explicit buffer(std::size_t bytes) : words((bytes + 7) / 8) {}
+
+    std::span<std::byte> bytes() {
+        return std::as_writable_bytes(std::span(words));
+    }
+    std::span<const std::byte> encoded() const {
+        return std::as_bytes(std::span(words)).first(used);
+    }
+};
+
+template <class T>
+std::size_t encode_records(const std::vector<bst::expected<T, errc>>& v,
+                           buffer& b) {
+    std::size_t used = 0;
+    for (const auto& x : v)
+        used += *bst::encode(x, b.bytes().subspan(used));
+    return used;
+}
+
+template <class T>
+buffer encoded_records(const std::vector<bst::expected<T, errc>>& v) {
+    std::size_t n = 0;
+    for (const auto& x : v)
+        n += bst::encoded_size(x);
+    buffer b(n);
+    b.used = encode_records(v, b);
+    return b;
+}
+
+template <class T>
+buffer encoded_columns(const std::vector<bst::expected<T, errc>>& v) {
+    buffer b(bst::encoded_columns_size(v));
+    b.used = *bst::encode_columns(v, b.bytes());
+    return b;
+}
+
+void set_bytes(benchmark::State& state, const buffer& b) {
+    state.SetBytesProcessed(state.iterations() *
+                            static_cast<std::int64_t>(b.used));
+}
+
+//------------------------------------------------------------------------------
+// Records
+
+template <class T>
+void BM_EncodeRecords(benchmark::State& state) {
+    const auto v = make_input<T>(state.range(0));
+    auto b = encoded_records(v);
+    for (auto _ : state) {
+        auto n = encode_records(v, b);
+        benchmark::DoNotOptimize(n);
+        benchmark::ClobberMemory();
+    }
+    set_bytes(state, b);
+}
+
+template <class T>
+void BM_DecodeRecords(benchmark::State& state) {
+    const auto v = make_input<T>(state.range(0));
+    const auto b = encoded_records(v);
+    std::vector<bst::expected<T, errc>> out(size);
+    for (auto _ : state) {
+        auto in = b.encoded();
+        for (auto& x : out) {
+            x = *bst::decode<T, errc>(in);
+            in = in.subspan(*bst::record_size(in));
+        }
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+    }
+    set_bytes(state, b);
+}
+
+template <class T>
+void BM_ViewRecords(benchmark::State& state) {
+    const auto v = make_input<T>(state.range(0));
+    const auto b = encoded_records(v);
+    for (auto _ : state) {
+        double sum = 0;
+        auto in = b.encoded();
+        while (!in.empty()) {
+            const auto r = *bst::view_record<T, errc>(in);
+            if (r.has_value())
+                sum += first_field(*r);
+            in = in.subspan(r.size());
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    set_bytes(state, b);
+}
+
+//------------------------------------------------------------------------------
+// Columns
+
+template <class T>
+void BM_EncodeColumns(benchmark::State& state) {
+    const auto v = make_input<T>(state.range(0));
+    auto b = encoded_columns(v);
+    for (auto _ : state) {
+        auto n = bst::encode_columns(v, b.bytes());
+        benchmark::DoNotOptimize(n);
+        benchmark::ClobberMemory();
+    }
+    set_bytes(state, b);
+}
+
+template <class T>
+void BM_DecodeColumns(benchmark::State& state) {
+    const auto v = make_input<T>(state.range(0));
+    const auto b = encoded_columns(v);
+    std::vector<bst::expected<T, errc>> out(size);
+    for (auto _ : state) {
+        bst::view_columns<T, errc>(b.encoded())->decode(out);
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+    }
+    set_bytes(state, b);
+}
+
+template <class T>
+void BM_ViewColumns(benchmark::State& state) {
+    const auto v = make_input<T>(state.range(0));
+    const auto b = encoded_columns(v);
+    for (auto _ : state) {
+        double sum = 0;
+        for (const T& x : bst::view_columns<T, errc>(b.encoded())->values())
+            sum += first_field(x);
+        benchmark::DoNotOptimize(sum);
+    }
+    set_bytes(state, b);
+}
+
+void error_rates(benchmark::internal::Benchmark* b) {
+    b->ArgName("error_pct");
+    for (int rate : {1, 10})
+        b->Arg(rate);
+}
+
+} // namespace
+
+BENCHMARK(BM_EncodeRecords<std::int64_t>)->Apply(error_rates);
+BENCHMARK(BM_DecodeRecords<std::int64_t>)->Apply(error_rates);
+BENCHMARK(BM_ViewRecords<std::int64_t>)->Apply(error_rates);
+BENCHMARK(BM_EncodeColumns<std::int64_t>)->Apply(error_rates);
+BENCHMARK(BM_DecodeColumns<std::int64_t>)->Apply(error_rates);
+BENCHMARK(BM_ViewColumns<std::int64_t>)->Apply(error_rates);
+BENCHMARK(BM_EncodeRecords<point>)->Apply(error_rates);
+BENCHMARK(BM_DecodeRecords<point>)->Apply(error_rates);
+BENCHMARK(BM_ViewRecords<point>)->Apply(error_rates);
+BENCHMARK(BM_EncodeColumns<point>)->Apply(error_rates);
+BENCHMARK(BM_DecodeColumns<point>)->Apply(error_rates);
+BENCHMARK(BM_ViewColumns<point>)->Apply(error_rates);
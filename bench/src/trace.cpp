@@ -0,0 +1,92 @@
+//
+// The cost of tracing errors, in a loop of calls of which 0.1%, 1% or 10%
+// fail: a plain error, a traced error that only records its source location,
+// and a traced error that also captures a backtrace of up to
+// BST_EXPECTED_TRACE_DEPTH frames.
+//
+// The failing function sits a few calls deep, so that the backtraces have
+// frames to walk. The error rate is given per mille.
+//
+
+#include <expected/trace.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace {
+
+enum class errc { overflow = 1 };
+
+std::vector<std::uint8_t> failures(std::int64_t per_mille) {
+    std::mt19937 gen(11);
+    std::bernoulli_distribution fail(static_cast<double>(per_mille) / 1000);
+    std::vector<std::uint8_t> v(1 << 16);
+    for (auto& f : v)
+        f = fail(gen);
+    return v;
+}
+
+[[gnu::noinline]] bst::expected<std::uint64_t, errc> plain(std::uint64_t x,
+                                                           bool fail) {
+    if (fail)
+        return bst::unexpected(errc::overflow);
+    return x * 3 + 1;
+}
+
+[[gnu::noinline]] bst::expected<std::uint64_t, bst::traced<errc>>
+traced(std::uint64_t x, bool fail) {
+    if (fail)
+        return bst::unexpected_traced(errc::overflow);
+    return x * 3 + 1;
+}
+
+template <auto F>
+[[gnu::noinline]] auto middle(std::uint64_t x, bool fail) {
+    return F(x, fail).transform([](std::uint64_t v) { return v ^ (v >> 7); });
+}
+
+template <auto F>
+[[gnu::noinline]] auto outer(std::uint64_t x, bool fail) {
+    return middle<F>(x, fail).transform([](std::uint64_t v) { return v + 1; });
+}
+
+template <auto F>
+void run(benchmark::State& state) {
+    const auto fail = failures(state.range(0));
+    std::size_t i = 0;
+    std::uint64_t sum = 0;
+    for (auto _ : state) {
+        auto r = outer<F>(i, fail[i & (fail.size() - 1)]);
+        sum += r ? *r : 1;
+        ++i;
+    }
+    benchmark::DoNotOptimize(sum);
+}
+
+void BM_Plain(benchmark::State& state) { run<plain>(state); }
+
+void BM_TracedLocation(benchmark::State& state) {
+    bst::enable_error_backtraces(false);
+    run<traced>(state);
+}
+
+void BM_TracedBacktrace(benchmark::State& state) {
+    bst::enable_error_backtraces(true);
+    run<traced>(state);
+    bst::enable_error_backtraces(false);
+}
+
+void error_rates(benchmark::internal::Benchmark* b) {
+    b->ArgName("errors_per_mille");
+    for (int rate : {1, 10, 100})
+        b->Arg(rate);
+}
+
+} // namespace
+
+BENCHMARK(BM_Plain)->Apply(error_rates);
+BENCHMARK(BM_TracedLocation)->Apply(error_rates);
+BENCHMARK(BM_TracedBacktrace)->Apply(error_rates);
@@ -0,0 +1,119 @@
+//
+// "All values or the first error" over 4096 independent fallible jobs: a
+// serial loop over a vector of expecteds, bst::traverse without a policy, and
+// bst::traverse under the seq and par execution policies.
+//
+// Each job does a fixed amount of arithmetic. The error position is given as
+// a percentage of the way through the jobs, 100 meaning no error, so the
+// short-circuit can be seen. With TBB, the par runs are repeated at 1, 4 and
+// all cores.
+//
+
+#include <expected/algorithm.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <execution>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+#ifdef BST_BENCH_HAS_TBB
+#include <tbb/global_control.h>
+#endif
+
+namespace {
+
+constexpr std::size_t jobs = 4096;
+
+using result = bst::expected<std::uint64_t, int>;
+
+result job(std::uint64_t seed) {
+    if (seed == 0)
+        return bst::unexpected(-1);
+    std::uint64_t x = seed;
+    for (int i = 0; i < 256; ++i)
+        x = x * 6364136223846793005u + 1442695040888963407u;
+    return x;
+}
+
+// Seeds for the jobs, with a zero, which fails, at pct percent of the way.
+std::vector<std::uint64_t> seeds(int pct) {
+    std::vector<std::uint64_t> v(jobs);
+    std::iota(v.begin(), v.end(), std::uint64_t{1});
+    if (pct < 100)
+        v[jobs * static_cast<std::size_t>(pct) / 100] = 0;
+    return v;
+}
+
+void BM_SerialLoop(benchmark::State& state) {
+    const auto in = seeds(static_cast<int>(state.range(0)));
+    for (auto _ : state) {
+        std::vector<result> results;
+        results.reserve(in.size());
+        for (auto s : in)
+            results.push_back(job(s));
+        auto r = bst::collect(results);
+        benchmark::DoNotOptimize(r);
+    }
+}
+
+void BM_Traverse(benchmark::State& state) {
+    const auto in = seeds(static_cast<int>(state.range(0)));
+    for (auto _ : state) {
+        auto r = bst::traverse(in, job);
+        benchmark::DoNotOptimize(r);
+    }
+}
+
+void BM_TraverseSeq(benchmark::State& state) {
+    const auto in = seeds(static_cast<int>(state.range(0)));
+    for (auto _ : state) {
+        auto r = bst::traverse(std::execution::seq, in, job);
+        benchmark::DoNotOptimize(r);
+    }
+}
+
+void BM_TraversePar(benchmark::State& state) {
+    const auto in = seeds(static_cast<int>(state.range(0)));
+#ifdef BST_BENCH_HAS_TBB
+    tbb::global_control threads(
+        tbb::global_control::max_allowed_parallelism,
+        static_cast<std::size_t>(state.range(1)));
+#endif
+    for (auto _ : state) {
+        auto r = bst::traverse(std::execution::par, in, job);
+        benchmark::DoNotOptimize(r);
+    }
+}
+
+void error_positions(benchmark::internal::Benchmark* b) {
+    b->ArgName("error_at_pct");
+    for (int pct : {10, 50, 100})
+        b->Arg(pct);
+}
+
+void error_positions_and_cores(benchmark::internal::Benchmark* b) {
+    b->ArgNames({"error_at_pct", "cores"});
+    const auto all =
+        static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+#ifdef BST_BENCH_HAS_TBB
+    std::vector<int> cores{1, 4, all};
+    std::sort(cores.begin(), cores.end());
+    cores.erase(std::unique(cores.begin(), cores.end()), cores.end());
+#else
+    const std::vector<int> cores{all};
+#endif
+    for (int pct : {10, 50, 100})
+        for (int c : cores)
+            b->Args({pct, c});
+}
+
+} // namespace
+
+BENCHMARK(BM_SerialLoop)->Apply(error_positions);
+BENCHMARK(BM_Traverse)->Apply(error_positions);
+BENCHMARK(BM_TraverseSeq)->Apply(error_positions);
+BENCHMARK(BM_TraversePar)->Apply(error_positions_and_cores)->UseRealTime();
@@ -0,0 +1,168 @@
+//
+// Validating 10K config records of 200 integer fields, each field failing
+// with probability 1%, so that about 87% of the records have at least one
+// error and most of those have two or more.
+//
+// FirstError stops at the first bad field. The others report every bad
+// field, collecting the errors into a std::vector or a
+// bst::error_list<field_error, 8>. Combine validates a 6-field record with
+// bst::combine, against nested and_then calls, which stop at the first error.
+//
+
+#include <expected/validated.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr std::size_t records = 10'000;
+constexpr std::size_t fields = 200;
+
+struct field_error {
+    std::uint16_t field;
+    std::uint16_t reason;
+    std::int32_t value;
+};
+
+using record = std::array<std::int32_t, fields>;
+
+const std::vector<record>& input() {
+    static const std::vector<record> v = [] {
+        std::mt19937 gen(5);
+        std::uniform_int_distribution<std::int32_t> good(0, 1000);
+        std::bernoulli_distribution bad(0.01);
+        std::vector<record> v(records);
+        for (auto& r : v)
+            for (auto& f : r)
+                f = bad(gen) ? -1 : good(gen);
+        return v;
+    }();
+    return v;
+}
+
+bst::expected<std::int32_t, field_error> check(std::uint16_t field,
+                                               std::int32_t v) {
+    if (v < 0)
+        return bst::unexpected(field_error{field, 1, v});
+    return v;
+}
+
+void BM_FirstError(benchmark::State& state) {
+    const auto& in = input();
+    for (auto _ : state) {
+        std::size_t failed = 0;
+        for (const auto& r : in) {
+            std::int64_t sum = 0;
+            for (std::uint16_t i = 0; i < fields; ++i) {
+                auto c = check(i, r[i]);
+                if (!c) {
+                    ++failed;
+                    break;
+                }
+                sum += *c;
+            }
+            benchmark::DoNotOptimize(sum);
+        }
+        benchmark::DoNotOptimize(failed);
+    }
+}
+
+void BM_VectorErrors(benchmark::State& state) {
+    const auto& in = input();
+    for (auto _ : state) {
+        std::size_t reported = 0;
+        for (const auto& r : in) {
+            std::vector<field_error> errors;
+            std::int64_t sum = 0;
+            for (std::uint16_t i = 0; i < fields; ++i) {
+                auto c = check(i, r[i]);
+                if (c)
+                    sum += *c;
+                else
+                    errors.push_back(c.error());
+            }
+            reported += errors.size();
+            benchmark::DoNotOptimize(sum);
+        }
+        benchmark::DoNotOptimize(reported);
+    }
+}
+
+void BM_ErrorList(benchmark::State& state) {
+    const auto& in = input();
+    for (auto _ : state) {
+        std::size_t reported = 0;
+        for (const auto& r : in) {
+            bst::error_list<field_error, 8> errors;
+            std::int64_t sum = 0;
+            for (std::uint16_t i = 0; i < fields; ++i) {
+                auto c = check(i, r[i]);
+                if (c)
+                    sum += *c;
+                else
+                    errors.push_back(c.error());
+            }
+            reported += errors.size();
+            benchmark::DoNotOptimize(sum);
+        }
+        benchmark::DoNotOptimize(reported);
+    }
+}
+
+struct endpoint {
+    std::int32_t port, timeout, retries, backlog, workers, queue;
+};
+
+void BM_CombineAndThen(benchmark::State& state) {
+    const auto& in = input();
+    for (auto _ : state) {
+        std::size_t ok = 0;
+        for (const auto& r : in) {
+            auto e = check(0, r[0]).and_then([&](std::int32_t a) {
+                return check(1, r[1]).and_then([&](std::int32_t b) {
+                    return check(2, r[2]).and_then([&](std::int32_t c) {
+                        return check(3, r[3]).and_then([&](std::int32_t d) {
+                            return check(4, r[4]).and_then(
+                                [&](std::int32_t f) {
+                                    return check(5, r[5]).transform(
+                                        [&](std::int32_t g) {
+                                            return endpoint{a, b, c, d, f, g};
+                                        });
+                                });
+                        });
+                    });
+                });
+            });
+            ok += e.has_value();
+        }
+        benchmark::DoNotOptimize(ok);
+    }
+}
+
+void BM_Combine(benchmark::State& state) {
+    const auto& in = input();
+    for (auto _ : state) {
+        std::size_t ok = 0;
+        for (const auto& r : in) {
+            auto e = bst::zip(
+                [](auto... v) { return endpoint{v...}; }, check(0, r[0]),
+                check(1, r[1]), check(2, r[2]), check(3, r[3]), check(4, r[4]),
+                check(5, r[5]));
+            ok += e.has_value();
+        }
+        benchmark::DoNotOptimize(ok);
+    }
+}
+
+} // namespace
+
+BENCHMARK(BM_FirstError)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_VectorErrors)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_ErrorList)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_CombineAndThen)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_Combine)->Unit(benchmark::kMicrosecond);
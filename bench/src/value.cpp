@@ -0,0 +1,43 @@
+//
+// Cost per call of value() in a tight loop, with the throw inline at the
+// call site and with it outlined into a cold function.
+//
+// For instructions per call, run with --benchmark_perf_counters=INSTRUCTIONS
+// (requires Google Benchmark built with libpfm); the counter is reported per
+// iteration, and each iteration makes range(0) calls.
+//
+
+#include "value_loop.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+namespace {
+
+std::vector<value_loop_result> make_values(std::size_t n) {
+    std::vector<value_loop_result> v;
+    v.reserve(n);
+    for (std::size_t i = 0; i < n; ++i)
+        v.emplace_back(static_cast<long>(i));
+    return v;
+}
+
+void BM_ValueInlineThrow(benchmark::State& state) {
+    const auto v = make_values(state.range(0));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(sum_values_inline_throw(v.data(), v.size()));
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_ValueOutlinedThrow(benchmark::State& state) {
+    const auto v = make_values(state.range(0));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(sum_values(v.data(), v.size()));
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+} // namespace
+
+BENCHMARK(BM_ValueInlineThrow)->Arg(1 << 10)->Arg(1 << 16);
+BENCHMARK(BM_ValueOutlinedThrow)->Arg(1 << 10)->Arg(1 << 16);
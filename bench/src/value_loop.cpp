@@ -0,0 +1,38 @@
+//
+// Tight loops over value(), kept in their own translation unit so that
+// std-expected-codesize can report the size of each loop's code.
+//
+// sum_values_inline_throw() spells out value() the way it used to be written,
+// with the throw expression inline at the call site; sum_values() calls the
+// library's value(), which throws from an out-of-line cold function.
+//
+
+#include "value_loop.hpp"
+
+#include <cstddef>
+
+namespace {
+
+template <class T, class E>
+const T& inline_throw_value(const bst::expected<T, E>& e) {
+    if (e.has_value())
+        return *e;
+    throw bst::bad_expected_access(e.error());
+}
+
+} // namespace
+
+extern "C" long sum_values_inline_throw(const value_loop_result* p,
+                                        std::size_t n) {
+    long sum = 0;
+    for (std::size_t i = 0; i < n; ++i)
+        sum += inline_throw_value(p[i]);
+    return sum;
+}
+
+extern "C" long sum_values(const value_loop_result* p, std::size_t n) {
+    long sum = 0;
+    for (std::size_t i = 0; i < n; ++i)
+        sum += p[i].value();
+    return sum;
+}
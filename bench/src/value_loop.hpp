@@ -0,0 +1,16 @@
+#ifndef BST_EXPECTED_BENCH_VALUE_LOOP_HPP_
+#define BST_EXPECTED_BENCH_VALUE_LOOP_HPP_
+
+#include <expected/expected.hpp>
+
+#include <cstddef>
+#include <string>
+
+// A non-trivial error type, so that constructing the exception is costly.
+using value_loop_result = bst::expected<long, std::string>;
+
+extern "C" long sum_values_inline_throw(const value_loop_result* p,
+                                        std::size_t n);
+extern "C" long sum_values(const value_loop_result* p, std::size_t n);
+
+#endif
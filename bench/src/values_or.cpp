@@ -0,0 +1,92 @@
+//
+// Replacing the errors in an array of 1M expecteds with a fallback, at error
+// rates from 0% to 50%: value_or() called element by element, against the
+// bulk values_or(), which blends each payload with the fallback instead of
+// branching on its state.
+//
+// The errors are scattered at random, so a branch on the state is
+// unpredictable once they are not rare. The payloads are a 64-bit integer
+// and a 24-byte struct. The error rate is given in percent.
+//
+
+#include <expected/algorithm.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <random>
+#include <type_traits>
+#include <vector>
+
+namespace {
+
+enum class errc : int { failed = 1 };
+
+struct point {
+    double x, y, z;
+};
+
+constexpr std::size_t size = 1 << 20;
+
+template <class T>
+T make_value(std::size_t i) {
+    if constexpr (std::is_same_v<T, point>)
+        return {static_cast<double>(i), 1.0, 2.0};
+    else
+        return static_cast<T>(i);
+}
+
+template <class T>
+std::vector<bst::expected<T, errc>> make_input(std::int64_t percent) {
+    std::mt19937 gen(5);
+    std::bernoulli_distribution fail(static_cast<double>(percent) / 100);
+    std::vector<bst::expected<T, errc>> v;
+    v.reserve(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        if (fail(gen))
+            v.emplace_back(bst::unexpect, errc::failed);
+        else
+            v.emplace_back(make_value<T>(i));
+    }
+    return v;
+}
+
+template <class T>
+void BM_ValueOr(benchmark::State& state) {
+    const auto v = make_input<T>(state.range(0));
+    std::vector<T> out(size);
+    const T fallback{};
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < size; ++i)
+            out[i] = v[i].value_or(fallback);
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * std::int64_t{size});
+}
+
+template <class T>
+void BM_ValuesOr(benchmark::State& state) {
+    const auto v = make_input<T>(state.range(0));
+    std::vector<T> out(size);
+    const T fallback{};
+    for (auto _ : state) {
+        auto n = bst::values_or(v, fallback, out);
+        benchmark::DoNotOptimize(n);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * std::int64_t{size});
+}
+
+void error_rates(benchmark::internal::Benchmark* b) {
+    b->ArgName("error_pct");
+    for (int rate : {0, 1, 5, 10, 25, 50})
+        b->Arg(rate);
+}
+
+} // namespace
+
+BENCHMARK(BM_ValueOr<std::int64_t>)->Apply(error_rates);
+BENCHMARK(BM_ValuesOr<std::int64_t>)->Apply(error_rates);
+BENCHMARK(BM_ValueOr<point>)->Apply(error_rates);
+BENCHMARK(BM_ValuesOr<point>)->Apply(error_rates);
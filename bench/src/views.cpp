@@ -0,0 +1,124 @@
+//
+// Separating the values of 10M expecteds from their errors: copying each
+// alternative into its own vector and then processing those, against the
+// lazy bst::views adaptors over the original vector.
+//
+// The records are 24 bytes, and 10% of the elements hold errors. Each
+// benchmark sums the values and counts the errors, or runs the same
+// and_then step and then does so.
+//
+
+#include <expected/views.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr std::size_t elements = 10'000'000;
+
+struct record {
+    std::uint64_t id;
+    std::uint64_t size;
+    std::uint64_t checksum;
+};
+
+using result = bst::expected<record, int>;
+
+const std::vector<result>& input() {
+    static const std::vector<result> v = [] {
+        std::mt19937 gen(7);
+        std::bernoulli_distribution fail(0.1);
+        std::vector<result> v;
+        v.reserve(elements);
+        for (std::size_t i = 0; i < elements; ++i) {
+            if (fail(gen))
+                v.emplace_back(bst::unexpect, static_cast<int>(i % 100));
+            else
+                v.emplace_back(record{i, i % 4096, i * 31});
+        }
+        return v;
+    }();
+    return v;
+}
+
+result validate(const record& r) {
+    if (r.size == 0)
+        return bst::unexpected(-1);
+    return record{r.id, r.size, r.checksum ^ r.size};
+}
+
+void BM_MaterializeThenFilter(benchmark::State& state) {
+    const auto& in = input();
+    for (auto _ : state) {
+        std::vector<record> values;
+        std::vector<int> errors;
+        for (const auto& x : in) {
+            if (x)
+                values.push_back(*x);
+            else
+                errors.push_back(x.error());
+        }
+        std::uint64_t sum = 0;
+        for (const auto& r : values)
+            sum += r.size;
+        benchmark::DoNotOptimize(sum);
+        benchmark::DoNotOptimize(errors.size());
+    }
+}
+
+void BM_Views(benchmark::State& state) {
+    const auto& in = input();
+    for (auto _ : state) {
+        std::uint64_t sum = 0;
+        for (const record& r : in | bst::views::values)
+            sum += r.size;
+        std::size_t errors = 0;
+        for (int e : in | bst::views::errors) {
+            benchmark::DoNotOptimize(e);
+            ++errors;
+        }
+        benchmark::DoNotOptimize(sum);
+        benchmark::DoNotOptimize(errors);
+    }
+}
+
+void BM_AndThenMaterialized(benchmark::State& state) {
+    const auto& in = input();
+    for (auto _ : state) {
+        std::vector<result> validated;
+        validated.reserve(in.size());
+        for (const auto& x : in)
+            validated.push_back(x.and_then(validate));
+        std::vector<record> values;
+        for (const auto& x : validated)
+            if (x)
+                values.push_back(*x);
+        std::uint64_t sum = 0;
+        for (const auto& r : values)
+            sum += r.checksum;
+        benchmark::DoNotOptimize(sum);
+    }
+}
+
+void BM_AndThenView(benchmark::State& state) {
+    const auto& in = input();
+    for (auto _ : state) {
+        std::uint64_t sum = 0;
+        for (const record& r :
+             in | bst::views::and_then(validate) | bst::views::values)
+            sum += r.checksum;
+        benchmark::DoNotOptimize(sum);
+    }
+}
+
+} // namespace
+
+BENCHMARK(BM_MaterializeThenFilter)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Views)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_AndThenMaterialized)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_AndThenView)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,438 @@
+#ifndef BST_EXPECTED_ALGORITHM_HPP_
+#define BST_EXPECTED_ALGORITHM_HPP_
+
+//
+// Algorithms over ranges of expected values.
+//
+
+/*
+Overview
+========
+
+namespace bst {
+
+template <std::ranges::input_range R>
+    expected<std::vector<T>, E> collect(R&& r);
+
+template <std::ranges::input_range R, class F>
+    expected<std::vector<U>, E> traverse(R&& r, F f);
+template <class ExecutionPolicy, std::ranges::random_access_range R, class F>
+    expected<std::vector<U>, E>
+    traverse(ExecutionPolicy&& policy, R&& r, const F& f);
+
+template <std::ranges::contiguous_range R, std::ranges::contiguous_range O>
+    std::size_t values_or(const R& r, const T& fallback, O&& out);
+template <std::ranges::contiguous_range R, std::ranges::contiguous_range D,
+          std::ranges::contiguous_range O>
+    std::size_t select_values(const R& r, const D& fallbacks, O&& out);
+template <std::ranges::contiguous_range R, std::ranges::contiguous_range O>
+    std::size_t errors_or(const R& r, const E& fallback, O&& out);
+
+} // namespace bst
+
+where the elements of r, or the results of f, are expected<T, E> or
+expected<U, E>.
+
+*/
+
+
+#include <expected/expected.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <execution>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <memory>
+#include <optional>
+#include <ranges>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+namespace bst {
+
+namespace detail {
+template <class R>
+using range_expected_t =
+    std::remove_cvref_t<std::ranges::range_reference_t<R>>;
+
+template <class R, class F>
+using traverse_result_t = std::remove_cvref_t<
+    std::invoke_result_t<F&, std::ranges::range_reference_t<R>>>;
+
+// Forwards an element of r: moved when r is an rvalue container, which owns
+// its elements, and otherwise passed on as the range yields it.
+template <class R, class It>
+constexpr decltype(auto) forward_element(It& it) {
+    if constexpr (std::is_lvalue_reference_v<R> ||
+                  std::ranges::borrowed_range<R> || std::ranges::view<R>)
+        return *it;
+    else
+        return std::ranges::iter_move(it);
+}
+
+template <class R>
+constexpr std::size_t reserve_size(R& r) {
+    if constexpr (std::ranges::sized_range<R>)
+        return static_cast<std::size_t>(std::ranges::size(r));
+    else if constexpr (std::ranges::forward_range<R>)
+        return static_cast<std::size_t>(std::ranges::distance(r));
+    else
+        return 0;
+}
+} // namespace detail
+
+
+
+//
+// collect
+//
+// All the values of a range of expecteds, in order, or its first error. The
+// result is allocated once for forward ranges; the scan stops at the first
+// error.
+//
+
+template <std::ranges::input_range R>
+    requires detail::is_expected<detail::range_expected_t<R>>::value &&
+             (!std::is_void_v<
+                 typename detail::range_expected_t<R>::value_type>)
+constexpr auto collect(R&& r) {
+    using X = detail::range_expected_t<R>;
+    using T = typename X::value_type;
+    using E = typename X::error_type;
+    using result = expected<std::vector<T>, E>;
+
+    std::vector<T> values;
+    values.reserve(detail::reserve_size(r));
+    for (auto it = std::ranges::begin(r); it != std::ranges::end(r); ++it) {
+        decltype(auto) x = detail::forward_element<R>(it);
+        if (!x.has_value())
+            return result(unexpect,
+                          std::forward<decltype(x)>(x).error());
+        values.push_back(*std::forward<decltype(x)>(x));
+    }
+    return result(std::in_place, std::move(values));
+}
+
+
+
+//
+// traverse
+//
+// Applies f, which returns an expected, to each element of a range, giving
+// all the values or the first error.
+//
+// The sequential form stops at the first error. The form taking an
+// execution policy runs the calls as that policy allows, so f must be safe
+// to call concurrently under parallel policies. Once a call fails, calls on
+// later elements that have not yet started are skipped; calls on earlier
+// elements still run, so the error returned is the one at the lowest index,
+// as in the sequential form. An exception thrown by f is likewise treated
+// as a failure at its index: it is caught, and once every call has finished
+// the one from the lowest failing index is rethrown, where std::for_each
+// under a policy would call std::terminate. The result is allocated once
+// when its value type is default constructible, and written in place.
+//
+
+template <std::ranges::input_range R, class F>
+    requires detail::is_expected<detail::traverse_result_t<R, F>>::value
+constexpr auto traverse(R&& r, F f) {
+    using X = detail::traverse_result_t<R, F>;
+    using U = typename X::value_type;
+    using E = typename X::error_type;
+    using result = expected<std::vector<U>, E>;
+
+    static_assert(!std::is_void_v<U>, "f must return a non-void value");
+
+    std::vector<U> values;
+    values.reserve(detail::reserve_size(r));
+    for (auto it = std::ranges::begin(r); it != std::ranges::end(r); ++it) {
+        X x = std::invoke(f, *it);
+        if (!x.has_value())
+            return result(unexpect, std::move(x).error());
+        values.push_back(*std::move(x));
+    }
+    return result(std::in_place, std::move(values));
+}
+
+namespace detail {
+// The lowest failing index seen so far, and its error or exception.
+template <class E>
+class first_failure {
+public:
+    static constexpr std::size_t none = std::size_t(-1);
+
+    // Calls on elements past a recorded failure need not run.
+    bool skip(std::size_t i) const noexcept {
+        return i > index_.load(std::memory_order_relaxed);
+    }
+
+    template <class G>
+    void record(std::size_t i, G&& error) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (i < index_.load(std::memory_order_relaxed)) {
+            error_.emplace(std::forward<G>(error));
+            exception_ = nullptr;
+            index_.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    void record_exception(std::size_t i, std::exception_ptr e) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (i < index_.load(std::memory_order_relaxed)) {
+            error_.reset();
+            exception_ = std::move(e);
+            index_.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    void rethrow_if_exception() const {
+        if (exception_)
+            std::rethrow_exception(exception_);
+    }
+
+    bool failed() const noexcept {
+        return index_.load(std::memory_order_relaxed) != none;
+    }
+
+    E&& error() && noexcept { return std::move(*error_); }
+
+private:
+    std::atomic<std::size_t> index_{none};
+    std::mutex mutex_;
+    std::optional<E> error_;
+    std::exception_ptr exception_;
+};
+
+// Writes each result into its slot of out, which has one slot per element of
+// r; slots past a failure are left as they were.
+template <class ExecutionPolicy, class R, class F, class Slot, class E>
+void traverse_into(ExecutionPolicy&& policy, R& r, const F& f, Slot* out,
+                   std::size_t n, first_failure<E>& failure) {
+    auto first = std::ranges::begin(r);
+    std::for_each(std::forward<ExecutionPolicy>(policy), out, out + n,
+                  [&](Slot& slot) {
+                      const auto i = static_cast<std::size_t>(&slot - out);
+                      if (failure.skip(i))
+                          return;
+                      BST_EXPECTED_TRY {
+                          auto x = std::invoke(f, first[i]);
+                          if (x.has_value())
+                              slot = *std::move(x);
+                          else
+                              failure.record(i, std::move(x).error());
+                      } BST_EXPECTED_CATCH_ALL {
+                          failure.record_exception(i,
+                                                   std::current_exception());
+                      }
+                  });
+}
+} // namespace detail
+
+template <class ExecutionPolicy, std::ranges::random_access_range R, class F>
+    requires std::is_execution_policy_v<
+                 std::remove_cvref_t<ExecutionPolicy>> &&
+             std::ranges::sized_range<R> &&
+             detail::is_expected<
+                 detail::traverse_result_t<R, const F&>>::value
+auto traverse(ExecutionPolicy&& policy, R&& r, const F& f) {
+    using X = detail::traverse_result_t<R, const F&>;
+    using U = typename X::value_type;
+    using E = typename X::error_type;
+    using result = expected<std::vector<U>, E>;
+
+    static_assert(!std::is_void_v<U>, "f must return a non-void value");
+
+    const auto n = static_cast<std::size_t>(std::ranges::size(r));
+    detail::first_failure<E> failure;
+
+    // std::vector<bool> packs its elements, so concurrent writes to
+    // neighbouring slots would race; stage those through optionals.
+    if constexpr (std::is_default_constructible_v<U> &&
+                  !std::is_same_v<U, bool>) {
+        std::vector<U> values(n);
+        detail::traverse_into(std::forward<ExecutionPolicy>(policy), r, f,
+                              values.data(), n, failure);
+        failure.rethrow_if_exception();
+        if (failure.failed())
+            return result(unexpect, std::move(failure).error());
+        return result(std::in_place, std::move(values));
+    } else {
+        std::vector<std::optional<U>> slots(n);
+        detail::traverse_into(std::forward<ExecutionPolicy>(policy), r, f,
+                              slots.data(), n, failure);
+        failure.rethrow_if_exception();
+        if (failure.failed())
+            return result(unexpect, std::move(failure).error());
+        std::vector<U> values;
+        values.reserve(n);
+        for (auto& slot : slots)
+            values.push_back(std::move(*slot));
+        return result(std::in_place, std::move(values));
+    }
+}
+
+
+
+//
+// values_or, select_values, errors_or
+//
+// Bulk forms of value_or over a contiguous range of expecteds, writing into
+// out, which must have at least as many elements as r. values_or puts
+// fallback in place of each error, and select_values the element of
+// fallbacks at the same index; errors_or is the mirror image, writing each
+// error and fallback for each value. Each returns the number of elements
+// that were taken from r.
+//
+// When both alternatives are trivially copyable, each element is read from
+// the payload's bytes whatever the state, and blended with the fallback
+// under a mask built from has_value(). The loop then has no branch to
+// mispredict when errors are scattered, and vectorizes where the layout
+// allows it. Other types are copied with a branch per element.
+//
+
+namespace detail {
+template <class R>
+using range_value_type_t = typename range_expected_t<R>::value_type;
+
+template <class R>
+using range_error_type_t = typename range_expected_t<R>::error_type;
+
+template <class R>
+concept bulk_input = is_expected<range_expected_t<R>>::value &&
+                     !std::is_void_v<range_value_type_t<R>>;
+
+template <class O, class U>
+concept bulk_output = std::is_same_v<std::ranges::range_value_t<O>, U> &&
+                      std::ranges::output_range<O, const U&> &&
+                      std::is_copy_assignable_v<U>;
+
+template <class X>
+inline constexpr bool bulk_selectable =
+    std::is_trivially_copyable_v<typename X::error_type> &&
+    (std::is_void_v<typename X::value_type> ||
+     std::is_trivially_copyable_v<typename X::value_type>);
+
+// An unsigned integer as wide as U, or void if there is none.
+template <class U>
+using blend_word_t = std::conditional_t<
+    sizeof(U) == 1, std::uint8_t,
+    std::conditional_t<
+        sizeof(U) == 2, std::uint16_t,
+        std::conditional_t<
+            sizeof(U) == 4, std::uint32_t,
+            std::conditional_t<sizeof(U) == 8, std::uint64_t, void>>>>;
+
+// Selects between x and d under mask, which is all ones or all zeros.
+template <class W>
+constexpr W blend_bits(W x, W d, W mask) noexcept {
+    return static_cast<W>((x & mask) | (d & ~mask));
+}
+
+// Copies the bytes at from, which may hold a U or not, to to if take is set,
+// and the bytes of fallback otherwise. Done on the bytes rather than on U so
+// that whatever happens to sit in the storage of an inactive alternative is
+// never read as a U. Wider types go 64 bits at a time.
+template <class U>
+void blend(U* to, const void* from, const U& fallback, bool take) noexcept {
+    using word = blend_word_t<U>;
+    if constexpr (!std::is_void_v<word>) {
+        word x, d;
+        std::memcpy(&x, from, sizeof(U));
+        std::memcpy(&d, std::addressof(fallback), sizeof(U));
+        const word r = blend_bits(x, d, static_cast<word>(word(0) - take));
+        std::memcpy(to, &r, sizeof(U));
+    } else {
+        const auto* x = static_cast<const unsigned char*>(from);
+        const auto* d =
+            reinterpret_cast<const unsigned char*>(std::addressof(fallback));
+        auto* r = reinterpret_cast<unsigned char*>(to);
+        const std::uint64_t mask = std::uint64_t(0) - take;
+        std::size_t k = 0;
+        for (; k + 8 <= sizeof(U); k += 8) {
+            std::uint64_t xw, dw;
+            std::memcpy(&xw, x + k, 8);
+            std::memcpy(&dw, d + k, 8);
+            const std::uint64_t rw = blend_bits(xw, dw, mask);
+            std::memcpy(r + k, &rw, 8);
+        }
+        for (; k != sizeof(U); ++k)
+            r[k] = blend_bits(x[k], d[k], static_cast<unsigned char>(mask));
+    }
+}
+
+// The kernel behind the three: out[i] is the payload of xs[i] when its state
+// is Value, and fallback(i) otherwise.
+template <bool Value, class X, class U, class Fallback>
+std::size_t select_n(const X* xs, std::size_t n, U* out, Fallback fallback) {
+    std::size_t taken = 0;
+    for (std::size_t i = 0; i != n; ++i) {
+        const bool take = xs[i].has_value() == Value;
+        if constexpr (bulk_selectable<X>) {
+            const void* payload;
+            if constexpr (Value)
+                payload = std::addressof(*xs[i]);
+            else
+                payload = std::addressof(xs[i].error());
+            blend(out + i, payload, fallback(i), take);
+        } else if (take) {
+            if constexpr (Value)
+                out[i] = *xs[i];
+            else
+                out[i] = xs[i].error();
+        } else {
+            out[i] = fallback(i);
+        }
+        taken += take;
+    }
+    return taken;
+}
+} // namespace detail
+
+template <std::ranges::contiguous_range R, std::ranges::contiguous_range O>
+    requires detail::bulk_input<R> &&
+             detail::bulk_output<O, detail::range_value_type_t<R>>
+std::size_t values_or(const R& r,
+                      const detail::range_value_type_t<R>& fallback,
+                      O&& out) {
+    return detail::select_n<true>(
+        std::ranges::data(r), std::ranges::size(r), std::ranges::data(out),
+        [&](std::size_t) -> decltype(auto) { return fallback; });
+}
+
+template <std::ranges::contiguous_range R, std::ranges::contiguous_range D,
+          std::ranges::contiguous_range O>
+    requires detail::bulk_input<R> &&
+             std::is_same_v<std::ranges::range_value_t<D>,
+                            detail::range_value_type_t<R>> &&
+             detail::bulk_output<O, detail::range_value_type_t<R>>
+std::size_t select_values(const R& r, const D& fallbacks, O&& out) {
+    const auto* d = std::ranges::data(fallbacks);
+    return detail::select_n<true>(
+        std::ranges::data(r), std::ranges::size(r), std::ranges::data(out),
+        [d](std::size_t i) -> decltype(auto) { return d[i]; });
+}
+
+template <std::ranges::contiguous_range R, std::ranges::contiguous_range O>
+    requires detail::is_expected<detail::range_expected_t<R>>::value &&
+             detail::bulk_output<O, detail::range_error_type_t<R>>
+std::size_t errors_or(const R& r,
+                      const detail::range_error_type_t<R>& fallback,
+                      O&& out) {
+    return detail::select_n<false>(
+        std::ranges::data(r), std::ranges::size(r), std::ranges::data(out),
+        [&](std::size_t) -> decltype(auto) { return fallback; });
+}
+
+} // namespace bst
+
+
+
+#endif
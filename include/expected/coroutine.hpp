@@ -0,0 +1,201 @@
+#ifndef BST_EXPECTED_COROUTINE_HPP_
+#define BST_EXPECTED_COROUTINE_HPP_
+
+//
+// expected as a coroutine return type, with co_await short-circuiting on
+// errors.
+//
+
+/*
+Overview
+========
+
+template <class T, class E, class... Args>
+struct std::coroutine_traits<bst::expected<T, E>, Args...>;
+
+Within a coroutine returning bst::expected<T, E>:
+
+    co_await x      // x an expected<U, G>: yields the value, or completes
+                    // the coroutine with unexpected(error)
+    co_return v;    // anything expected<T, E> is constructible from
+
+*/
+
+
+#include <expected/expected.hpp>
+
+#include <coroutine>
+#include <exception>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+
+//
+// A coroutine returning expected runs to completion before returning to
+// its caller: it never suspends except to bail out on an error, at which
+// point the error is moved from the awaited expected straight into the
+// result and the frame is destroyed. Each co_await therefore costs what the
+// equivalent hand-written branch does, plus the frame allocation, which the
+// compiler may elide.
+//
+// co_await on an rvalue moves the error; on an lvalue it copies, as the
+// awaited object is left intact.
+//
+// The promise writes the result into a holder returned from
+// get_return_object(). Compilers that convert that holder to the return type
+// before running the body get an expected in a deferred state instead,
+// which the promise fills in directly; on those compilers an exception
+// escaping the coroutine body calls std::terminate.
+//
+
+namespace bst::detail {
+
+template <class T, class E>
+class expected_promise;
+
+template <class T, class E>
+class expected_return {
+public:
+    explicit expected_return(expected_promise<T, E>& p) noexcept : p_(&p) {
+        p_->bind(storage(), &full_);
+    }
+
+    // Once the body has finished, the promise is gone and the result is in
+    // rhs; before, the promise is told to write here instead.
+    expected_return(expected_return&& rhs) noexcept(
+        std::is_nothrow_move_constructible_v<expected<T, E>>)
+        : p_(rhs.p_) {
+        if (rhs.full_) {
+            std::construct_at(storage(), std::move(*rhs.storage()));
+            full_ = true;
+            std::destroy_at(rhs.storage());
+            rhs.full_ = false;
+        } else {
+            p_->bind(storage(), &full_);
+        }
+    }
+
+    ~expected_return() {
+        if (full_)
+            std::destroy_at(storage());
+    }
+
+    operator expected<T, E>() {
+        if (full_)
+            return std::move(*storage());
+        // The body has not run yet: have it write the real return object.
+        return expected<T, E>(detail::deferred_init, *p_);
+    }
+
+private:
+    expected_promise<T, E>* p_;
+    bool full_ = false;
+    alignas(expected<T, E>) unsigned char buf_[sizeof(expected<T, E>)];
+
+    expected<T, E>* storage() noexcept {
+        return reinterpret_cast<expected<T, E>*>(buf_);
+    }
+};
+
+template <class Expected>
+class expected_awaiter {
+public:
+    explicit expected_awaiter(Expected e) noexcept
+        : e_(std::forward<Expected>(e)) {}
+
+    bool await_ready() const noexcept { return e_.has_value(); }
+
+    decltype(auto) await_resume() { return *std::forward<Expected>(e_); }
+
+    template <class Promise>
+    void await_suspend(std::coroutine_handle<Promise> h) {
+        h.promise().emplace(unexpect, std::forward<Expected>(e_).error());
+        h.destroy();
+    }
+
+private:
+    Expected e_;
+};
+
+template <class T, class E>
+class expected_promise_base {
+public:
+    expected_return<T, E> get_return_object() noexcept {
+        return expected_return<T, E>(
+            static_cast<expected_promise<T, E>&>(*this));
+    }
+
+    std::suspend_never initial_suspend() const noexcept { return {}; }
+    std::suspend_never final_suspend() const noexcept { return {}; }
+
+    void unhandled_exception() const {
+#ifdef BST_EXPECTED_NO_EXCEPTIONS
+        std::terminate();
+#else
+        if (!full_)
+            std::terminate();
+        throw;
+#endif
+    }
+
+    template <class U, class G>
+    auto await_transform(expected<U, G>& e) const noexcept {
+        return expected_awaiter<expected<U, G>&>(e);
+    }
+
+    template <class U, class G>
+    auto await_transform(const expected<U, G>& e) const noexcept {
+        return expected_awaiter<const expected<U, G>&>(e);
+    }
+
+    template <class U, class G>
+    auto await_transform(expected<U, G>&& e) const noexcept {
+        return expected_awaiter<expected<U, G>&&>(std::move(e));
+    }
+
+    // Where the result goes, and the flag recording that it is there. full
+    // is null when dest is the caller's return object itself.
+    void bind(expected<T, E>* dest, bool* full) noexcept {
+        dest_ = dest;
+        full_ = full;
+    }
+
+    template <class... Args>
+    void emplace(Args&&... args) {
+        std::construct_at(dest_, std::forward<Args>(args)...);
+        if (full_)
+            *full_ = true;
+    }
+
+private:
+    expected<T, E>* dest_ = nullptr;
+    bool* full_ = nullptr;
+};
+
+template <class T, class E>
+class expected_promise : public expected_promise_base<T, E> {
+public:
+    template <class U = T>
+        requires std::is_constructible_v<expected<T, E>, U>
+    void return_value(U&& v) {
+        this->emplace(std::forward<U>(v));
+    }
+};
+
+template <class E>
+class expected_promise<void, E> : public expected_promise_base<void, E> {
+public:
+    void return_void() { this->emplace(); }
+};
+
+} // namespace bst::detail
+
+template <class T, class E, class... Args>
+struct std::coroutine_traits<bst::expected<T, E>, Args...> {
+    using promise_type = bst::detail::expected_promise<T, E>;
+};
+
+
+
+#endif
@@ -0,0 +1,219 @@
+#ifndef BST_EXPECTED_ERROR_HPP_
+#define BST_EXPECTED_ERROR_HPP_
+
+//
+// A type-erased, allocation-free error type for expected.
+//
+
+/*
+Overview
+========
+
+namespace bst {
+
+class error_domain {
+public:
+    virtual const char* name() const noexcept = 0;
+    virtual std::string message(const error&) const = 0;
+};
+
+const error_domain& generic_domain() noexcept;     // std::errc
+
+class error {
+public:
+    static constexpr std::size_t payload_size = sizeof(void*);
+
+    constexpr error() noexcept;
+    template <class P>
+        error(const error_domain&, const P& payload) noexcept;
+    template <class Enum>
+        error(Enum e) noexcept;    // std::errc, or with error_domain_of(Enum)
+                                   // found by ADL
+
+    constexpr const error_domain* domain() const noexcept;
+    constexpr explicit operator bool() const noexcept;
+    std::intptr_t code() const noexcept;
+    template <class P>
+        P payload() const noexcept;
+    std::string message() const;
+
+    friend bool operator==(const error&, const error&) noexcept;
+    template <class Enum>
+        friend bool operator==(const error&, Enum) noexcept;
+};
+
+} // namespace bst
+
+*/
+
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <system_error>
+#include <type_traits>
+
+
+namespace bst {
+
+class error;
+class error_domain;
+
+const error_domain& generic_domain() noexcept;
+
+//
+// class error_domain
+//
+// Identifies where an error came from and knows how to describe it. Domains
+// are compared by address, so each should be a single object with static
+// storage duration, typically a function-local static returned by reference.
+//
+
+class error_domain {
+public:
+    virtual const char* name() const noexcept = 0;
+    virtual std::string message(const error& e) const = 0;
+
+protected:
+    constexpr error_domain() noexcept = default;
+    error_domain(const error_domain&) = delete;
+    error_domain& operator=(const error_domain&) = delete;
+    ~error_domain() = default;
+};
+
+
+
+namespace detail {
+// std::errc is handled here, as its namespace is closed to additions.
+inline const error_domain& error_domain_of(std::errc) noexcept {
+    return generic_domain();
+}
+
+template <class Enum>
+concept has_error_domain = std::is_enum_v<Enum> && requires(Enum e) {
+    { error_domain_of(e) } -> std::same_as<const error_domain&>;
+};
+
+template <class Enum>
+const error_domain& domain_of(Enum e) noexcept {
+    return error_domain_of(e);
+}
+} // namespace detail
+
+
+
+//
+// class error
+//
+// An error from any domain in two words: a pointer to its domain and an
+// inline payload, by default an integer code. Any trivially copyable type
+// that fits in payload_size bytes can be stored instead, so building,
+// copying and comparing an error never allocates; only message() may.
+// Errors compare their payloads byte for byte, so a payload must also have
+// unique object representations: no padding, whose bytes are indeterminate,
+// and no floating point, where +0.0 and -0.0 differ in their bytes.
+//
+// A default-constructed error has no domain and compares equal only to other
+// default-constructed errors. Enumerations convert implicitly when an
+// error_domain_of(Enum) overload is visible to argument-dependent lookup:
+//
+//     enum class db_errc { timeout = 1, conflict };
+//     const bst::error_domain& error_domain_of(db_errc);
+//
+//     bst::expected<row, bst::error> fetch(key k) {
+//         ...
+//         return bst::unexpected(bst::error(db_errc::timeout));
+//     }
+//
+
+class error {
+public:
+    static constexpr std::size_t payload_size = sizeof(void*);
+
+    template <class P>
+    static constexpr bool is_payload_v =
+        std::is_trivially_copyable_v<P> &&
+        std::has_unique_object_representations_v<P> &&
+        sizeof(P) <= payload_size && alignof(P) <= alignof(void*);
+
+    constexpr error() noexcept = default;
+
+    template <class P>
+        requires is_payload_v<P>
+    error(const error_domain& d, const P& payload) noexcept : domain_(&d) {
+        std::memcpy(payload_, &payload, sizeof(P));
+    }
+
+    template <class Enum>
+        requires detail::has_error_domain<Enum>
+    error(Enum e) noexcept
+        : error(detail::domain_of(e), static_cast<std::intptr_t>(e)) {}
+
+    constexpr const error_domain* domain() const noexcept { return domain_; }
+    constexpr explicit operator bool() const noexcept {
+        return domain_ != nullptr;
+    }
+
+    std::intptr_t code() const noexcept { return payload<std::intptr_t>(); }
+
+    template <class P>
+        requires is_payload_v<P>
+    P payload() const noexcept {
+        P p;
+        std::memcpy(&p, payload_, sizeof(P));
+        return p;
+    }
+
+    std::string message() const {
+        return domain_ ? domain_->message(*this) : std::string("no error");
+    }
+
+    friend bool operator==(const error& x, const error& y) noexcept {
+        return x.domain_ == y.domain_ &&
+               std::memcmp(x.payload_, y.payload_, payload_size) == 0;
+    }
+
+    template <class Enum>
+        requires detail::has_error_domain<Enum>
+    friend bool operator==(const error& x, Enum y) noexcept {
+        return x == error(y);
+    }
+
+private:
+    const error_domain* domain_ = nullptr;
+    alignas(void*) unsigned char payload_[payload_size] = {};
+};
+
+static_assert(sizeof(error) == 2 * sizeof(void*));
+static_assert(std::is_trivially_copyable_v<error>);
+
+
+
+//
+// generic_domain
+//
+// The domain of std::errc, whose messages come from std::generic_category.
+//
+
+namespace detail {
+class generic_error_domain final : public error_domain {
+public:
+    const char* name() const noexcept override { return "generic"; }
+    std::string message(const error& e) const override {
+        return std::generic_category().message(static_cast<int>(e.code()));
+    }
+};
+} // namespace detail
+
+inline const error_domain& generic_domain() noexcept {
+    static constexpr detail::generic_error_domain domain;
+    return domain;
+}
+
+} // namespace bst
+
+
+
+#endif
@@ -1,8 +1,6 @@
 #ifndef BST_EXPECTED_HPP_
 #define BST_EXPECTED_HPP_
 
-// #define BST_EXPECTED_MONADIC_INTERFACE
-
 //
 // An implementation of std::expected from the upcomming C++23
 //
@@ -110,6 +108,29 @@ public:
         constexpr explicit
         expected(unexpect_t, std::initializer_list<U>, Args&&...);
 
+    // Uses-allocator construction of the alternative held.
+    template <class Alloc>
+        constexpr expected(std::allocator_arg_t, const Alloc&);
+    template <class Alloc, class X>
+        constexpr explicit(conditional)
+        expected(std::allocator_arg_t, const Alloc&, X&&);  // any expected
+    template <class Alloc, class U = T>
+        constexpr explicit(conditional)
+        expected(std::allocator_arg_t, const Alloc&, U&&);
+    template <class Alloc, class G>
+        constexpr explicit(conditional)
+        expected(std::allocator_arg_t, const Alloc&, const unexpected<G>&);
+    template <class Alloc, class G>
+        constexpr explicit(conditional)
+        expected(std::allocator_arg_t, const Alloc&, unexpected<G>&&);
+    template <class Alloc, class... Args>
+        constexpr explicit
+        expected(std::allocator_arg_t, const Alloc&, std::in_place_t,
+                 Args&&...);
+    template <class Alloc, class... Args>
+        constexpr explicit
+        expected(std::allocator_arg_t, const Alloc&, unexpect_t, Args&&...);
+
     constexpr ~expected();
 
     constexpr expected& operator=(const expected& rhs);
@@ -154,6 +175,15 @@ public:
     template <class U>
         constexpr T value_or(U&& v) &&;
 
+    template <class F>
+        constexpr auto and_then(F&& f) &;          // also &&, const&, const&&
+    template <class F>
+        constexpr auto or_else(F&& f) &;           // also &&, const&, const&&
+    template <class F>
+        constexpr auto transform(F&& f) &;         // also &&, const&, const&&
+    template <class F>
+        constexpr auto transform_error(F&& f) &;   // also &&, const&, const&&
+
     template <class T2, class E2>
         friend constexpr bool
         operator==(const expected&, const expected<T2, E2>&);
@@ -195,6 +225,25 @@ public:
         constexpr explicit
         expected(unexpect_t, std::initializer_list<U>, Args&&...);
 
+    // Uses-allocator construction of the error, if any.
+    template <class Alloc>
+        constexpr expected(std::allocator_arg_t, const Alloc&) noexcept;
+    template <class Alloc>
+        constexpr explicit
+        expected(std::allocator_arg_t, const Alloc&, std::in_place_t) noexcept;
+    template <class Alloc, class X>
+        constexpr explicit(conditional)
+        expected(std::allocator_arg_t, const Alloc&, X&&);  // any expected
+    template <class Alloc, class G>
+        constexpr explicit(conditional)
+        expected(std::allocator_arg_t, const Alloc&, const unexpected<G>&);
+    template <class Alloc, class G>
+        constexpr explicit(conditional)
+        expected(std::allocator_arg_t, const Alloc&, unexpected<G>&&);
+    template <class Alloc, class... Args>
+        constexpr explicit
+        expected(std::allocator_arg_t, const Alloc&, unexpect_t, Args&&...);
+
     constexpr ~expected();
 
     constexpr expected& operator=(const expected&);
@@ -219,9 +268,95 @@ public:
     constexpr const E&& error() const&&;
     constexpr E&& error() &&;
 
+    template <class F>
+        constexpr auto and_then(F&& f) &;          // also &&, const&, const&&
+    template <class F>
+        constexpr auto or_else(F&& f) &;           // also &&, const&, const&&
+    template <class F>
+        constexpr auto transform(F&& f) &;         // also &&, const&, const&&
+    template <class F>
+        constexpr auto transform_error(F&& f) &;   // also &&, const&, const&&
+
+    template <class T2, class E2>
+        friend constexpr bool
+        operator==(const expected&, const expected<T2, E2>&);
+    template <class E2>
+        friend constexpr bool
+        operator==(const expected&, const unexpected<E2>&);
+
+    friend constexpr void
+        swap(expected&, expected&) noexcept(conditional)
+};
+
+template <class T, class E>
+class expected<T&, E> {
+public:
+    using value_type = T&;
+    using error_type = E;
+    using unexpected_type = unexpected<E>;
+
+    template <class U>
+        using rebind = expected<U, error_type>;
+
+    template <class U>
+        constexpr expected(U&) noexcept;           // rvalues are deleted
+    template <class U, class G>
+        constexpr explicit(conditional) expected(const expected<U&, G>&);
+    template <class U, class G>
+        constexpr explicit(conditional) expected(expected<U&, G>&&);
+    template <class G>
+        constexpr explicit(conditional) expected(const unexpected<G>&);
+    template <class G>
+        constexpr explicit(conditional) expected(unexpected<G>&&);
+    template <class U>
+        constexpr explicit expected(std::in_place_t, U&) noexcept;
+    template <class... Args>
+        constexpr explicit expected(unexpect_t, Args&&...);
+    template <class U, class... Args>
+        constexpr explicit
+        expected(unexpect_t, std::initializer_list<U>, Args&&...);
+
+    template <class U>
+        constexpr expected& operator=(U&) noexcept;  // rebinds
+    template <class G>
+        constexpr expected& operator=(const unexpected<G>&);
+    template <class G>
+        constexpr expected& operator=(unexpected<G>&&);
+
+    template <class U>
+        constexpr T& emplace(U&) noexcept;
+
+    constexpr void swap(expected&) noexcept(conditional);
+
+    constexpr T* operator->() const noexcept;
+    constexpr T& operator*() const noexcept;
+    constexpr explicit operator bool() const noexcept;
+    constexpr bool has_value() const noexcept;
+    constexpr T& value() const&;
+    constexpr T& value() &&;
+
+    constexpr const E& error() const&;
+    constexpr E& error() &;
+    constexpr const E&& error() const&&;
+    constexpr E&& error() &&;
+
+    template <class U>
+        constexpr std::remove_cv_t<T> value_or(U&& v) const;
+
+    template <class F>
+        constexpr auto and_then(F&& f) &;          // also &&, const&, const&&
+    template <class F>
+        constexpr auto or_else(F&& f) &;           // also &&, const&, const&&
+    template <class F>
+        constexpr auto transform(F&& f) &;         // also &&, const&, const&&
+    template <class F>
+        constexpr auto transform_error(F&& f) &;   // also &&, const&, const&&
+
     template <class T2, class E2>
         friend constexpr bool
         operator==(const expected&, const expected<T2, E2>&);
+    template <class T2>
+        friend constexpr bool operator==(const expected&, const T2&);
     template <class E2>
         friend constexpr bool
         operator==(const expected&, const unexpected<E2>&);
@@ -232,15 +367,66 @@ public:
 
 } // namespace bst
 
+template <class T, class E, class Alloc>
+    struct std::uses_allocator<bst::expected<T, E>, Alloc>;
+
 */
 
 
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdlib>
 #include <exception>
+#include <functional>
 #include <initializer_list>
 #include <memory>
+#include <tuple>
 #include <type_traits>
 #include <utility>
 
+#ifdef BST_EXPECTED_INSTRUMENT
+#include <cstdint>
+#include <cstdio>
+#include <string_view>
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#define BST_EXPECTED_NO_UNIQUE_ADDRESS [[msvc::no_unique_address]]
+#else
+#define BST_EXPECTED_NO_UNIQUE_ADDRESS [[no_unique_address]]
+#endif
+
+// Exception support. BST_EXPECTED_NO_EXCEPTIONS is defined automatically when
+// the compiler has exceptions disabled, and may be defined by the user to
+// force the mode. Without exceptions, value() reports an error through the
+// bad_expected_access handler, and an assignment that switches alternatives
+// destroys the old one and constructs the new one in place, with no
+// temporary and no rollback. A forced mode is therefore only sound if the
+// alternatives' constructors do not throw.
+
+#if !defined(BST_EXPECTED_NO_EXCEPTIONS) && !defined(__cpp_exceptions)
+#define BST_EXPECTED_NO_EXCEPTIONS
+#endif
+
+#ifdef BST_EXPECTED_NO_EXCEPTIONS
+#define BST_EXPECTED_TRY if (true)
+#define BST_EXPECTED_CATCH_ALL if (false)
+#define BST_EXPECTED_RETHROW static_cast<void>(0)
+#else
+#define BST_EXPECTED_TRY try
+#define BST_EXPECTED_CATCH_ALL catch (...)
+#define BST_EXPECTED_RETHROW throw
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define BST_EXPECTED_COLD [[gnu::cold, gnu::noinline]]
+#elif defined(_MSC_VER)
+#define BST_EXPECTED_COLD __declspec(noinline)
+#else
+#define BST_EXPECTED_COLD
+#endif
+
 
 namespace bst {
 
@@ -263,14 +449,53 @@ class expected;
 template <class E>
 class expected<void, E>;
 
+template <class T, class E>
+class expected<T&, E>;
+
 
 
 namespace detail {
+#ifdef BST_EXPECTED_NO_EXCEPTIONS
+inline constexpr bool exceptions_enabled = false;
+#else
+inline constexpr bool exceptions_enabled = true;
+#endif
+
 template <typename T, template <class> class TT>
 struct is_specialization_of : std::false_type {};
 
 template <template <class> class TT, class... Args>
 struct is_specialization_of<TT<Args...>, TT> : std::true_type {};
+
+template <class T>
+struct is_expected : std::false_type {};
+
+template <class T, class E>
+struct is_expected<expected<T, E>> : std::true_type {};
+
+// Tags selecting the private constructors that initialize the value or the
+// error directly from the result of a function call.
+
+struct in_place_invoke_t {
+    explicit in_place_invoke_t() = default;
+};
+inline constexpr in_place_invoke_t in_place_invoke{};
+
+struct unexpect_invoke_t {
+    explicit unexpect_invoke_t() = default;
+};
+inline constexpr unexpect_invoke_t unexpect_invoke{};
+
+// Selects the private constructor that leaves both alternatives unconstructed,
+// for a coroutine to fill in once its body has run (see coroutine.hpp).
+
+struct deferred_init_t {
+    explicit deferred_init_t() = default;
+};
+inline constexpr deferred_init_t deferred_init{};
+
+template <class T, class E>
+class expected_return;
 } // namespace detail
 
 
@@ -299,9 +524,9 @@ public:
 
     template <class U, class... Args>
         requires(std::is_constructible_v<E, std::initializer_list<U>&, Args...>)
-    constexpr explicit unexpected(std::in_place_t, std::initializer_list<U>,
+    constexpr explicit unexpected(std::in_place_t, std::initializer_list<U> il,
                                   Args&&... args)
-        : val_(std::forward<Args>(args)...) {}
+        : val_(il, std::forward<Args>(args)...) {}
 
     template <class Err = E>
         requires(!std::is_same_v<std::remove_cvref_t<Err>, unexpected> &&
@@ -386,416 +611,1881 @@ private:
 
 
 //
-// class expected<T, E>
+// bad_expected_access handler
+//
+// Without exceptions, value() on an expected holding an error constructs the
+// bad_expected_access it would have thrown and passes it to the installed
+// handler. The handler must not return; if it does, std::abort is called.
+// The default handler calls std::abort. With exceptions enabled the handler
+// is never called.
 //
 
-template <class T, class E>
-class expected {
-public:
-    static_assert(!std::is_reference_v<T>, "T cannot be a reference type");
-    static_assert(!std::is_function_v<T>, "T cannot be a function type");
-    static_assert(!std::is_same_v<std::in_place_t, std::remove_cv_t<T>>,
-                  "T cannot be std::in_place_t");
-    static_assert(!std::is_same_v<unexpect_t, std::remove_cv_t<T>>,
-                  "T cannot be unexpect_t");
-    static_assert(!detail::is_specialization_of<T, unexpected>::value,
-                  "T must not be a specialization of unexpected");
-    static_assert(std::is_constructible_v<unexpected<E>, E&>,
-                  "Must be able to construct an unexpected<E>");
+using bad_expected_access_handler = void (*)(const bad_expected_access<void>&);
 
-    using value_type = T;
-    using error_type = E;
-    using unexpected_type = unexpected<E>;
+namespace detail {
+[[noreturn]] inline void
+default_bad_expected_access_handler(const bad_expected_access<void>&) noexcept {
+    std::abort();
+}
 
-    template <class U>
-    using rebind = expected<U, error_type>;
+inline std::atomic<bad_expected_access_handler> bad_access_handler{
+    &default_bad_expected_access_handler};
+} // namespace detail
 
-    //
-    // Default constructor
-    //
+inline bad_expected_access_handler
+set_bad_expected_access_handler(bad_expected_access_handler h) noexcept {
+    return detail::bad_access_handler.exchange(
+        h ? h : &detail::default_bad_expected_access_handler);
+}
 
-    constexpr expected()
-        requires std::is_default_constructible_v<T>
-    : val_(), has_val_(true) {}
+inline bad_expected_access_handler get_bad_expected_access_handler() noexcept {
+    return detail::bad_access_handler.load();
+}
 
-    //
-    // Copy constructor
-    //
 
-    constexpr expected(const expected& rhs)
-        requires std::conjunction_v<
-            std::is_copy_constructible<T>,
-            std::is_copy_constructible<E>,
-            std::disjunction<
-                std::negation<std::is_trivially_copy_constructible<T>>,
-                std::negation<std::is_trivially_copy_constructible<E>>>>
-		: invalid_{}, has_val_(rhs.has_value()) {
-        if (rhs.has_value())
-            std::construct_at(std::addressof(val_), *rhs);
-        else
-            std::construct_at(std::addressof(unex_), rhs.error());
-    }
 
-    constexpr expected(const expected& rhs)
-        requires(!std::is_copy_constructible_v<T> ||
-                 !std::is_copy_constructible_v<E>)
-    = delete;
+namespace detail {
+// Kept out of line and marked cold, so that value() inlines to a test and a
+// call rather than the full exception construction.
 
-    constexpr expected(const expected&)
-        requires(std::is_trivially_copy_constructible_v<T> &&
-                 std::is_trivially_copy_constructible_v<E>)
-    = default;
+template <class E>
+[[noreturn]] BST_EXPECTED_COLD void throw_bad_expected_access(E&& e) {
+#ifdef BST_EXPECTED_NO_EXCEPTIONS
+    get_bad_expected_access_handler()(
+        bad_expected_access<std::remove_cvref_t<E>>(std::forward<E>(e)));
+    std::abort();
+#else
+    throw bad_expected_access<std::remove_cvref_t<E>>(std::forward<E>(e));
+#endif
+}
+} // namespace detail
 
-    //
-    // Move constructor
-    //
 
-    constexpr expected(expected&& rhs) noexcept(
-        std::is_nothrow_move_constructible_v<T>&&
-            std::is_nothrow_move_constructible_v<E>)
-        requires std::conjunction_v<
-            std::is_move_constructible<T>,
-            std::is_move_constructible<E>,
-            std::disjunction<
-                std::negation<std::is_trivially_move_constructible<T>>,
-                std::negation<std::is_trivially_move_constructible<E>>>>
-		: invalid_{}, has_val_(rhs.has_val_) {
-        if (rhs.has_value())
-            std::construct_at(std::addressof(val_), std::move(*rhs));
-        else
-            std::construct_at(std::addressof(unex_), std::move(rhs.error()));
-    }
 
-    constexpr expected(expected&&)
-        requires(std::is_trivially_move_constructible_v<T> &&
-                 std::is_trivially_move_constructible_v<E>)
-    = default;
+//
+// Instrumentation
+//
+// Defining BST_EXPECTED_INSTRUMENT for the whole program makes every
+// expected<T, E> count what it does to its alternatives, per specialization:
+//
+//     copy_constructions   copies of an expected, including converting ones
+//     move_constructions   moves of an expected, including converting ones
+//     copy_assignments     copy assignments between expecteds
+//     move_assignments     move assignments between expecteds
+//     reinit_temporaries   temporaries made by an assignment that switches
+//                          between the value and the error to keep the
+//                          strong exception guarantee
+//     value_or_copies      values copied out by value_or() on an lvalue
+//     bad_access_throws    value() called on an expected holding an error
+//     error_constructions  errors constructed inside an expected
+//
+// Trivial copy and move constructions are left to the compiler and are not
+// counted, and an expected<T&, E> counts its copies and errors as the
+// expected<T*, E> that holds it.
+// The counters are read with expected_counters_of<T, E>() and
+// for_each_expected_counters(), and written as a JSON object keyed by type
+// name with write_expected_counters_json(). If the environment variable
+// BST_EXPECTED_COUNTERS names a file when the program exits, the counters are
+// written to it, or to stderr if it is "-".
+//
+// Without the macro none of this exists, and the counting sites compile to
+// nothing. Mixing instrumented and plain translation units in one program
+// violates the one definition rule.
+//
 
-    //
-    // Converting constructor
-    //
+#ifdef BST_EXPECTED_INSTRUMENT
+
+struct expected_counters {
+    std::atomic<std::uint64_t> copy_constructions{0};
+    std::atomic<std::uint64_t> move_constructions{0};
+    std::atomic<std::uint64_t> copy_assignments{0};
+    std::atomic<std::uint64_t> move_assignments{0};
+    std::atomic<std::uint64_t> reinit_temporaries{0};
+    std::atomic<std::uint64_t> value_or_copies{0};
+    std::atomic<std::uint64_t> bad_access_throws{0};
+    std::atomic<std::uint64_t> error_constructions{0};
+};
 
-    template <class U, class G, class UF = const U&, class GF = const G&>
-        requires(std::conjunction_v<
-                 std::is_constructible<T, UF>, std::is_constructible<E, GF>,
-                 std::negation<std::is_constructible<T, expected<U, G>&>>,
-                 std::negation<std::is_constructible<T, expected<U, G>>>,
-                 std::negation<std::is_constructible<T, const expected<U, G>&>>,
-                 std::negation<std::is_constructible<T, const expected<U, G>>>,
-                 std::negation<std::is_convertible<expected<U, G>&, T>>,
-                 std::negation<std::is_convertible<expected<U, G> &&, T>>,
-                 std::negation<std::is_convertible<const expected<U, G>&, T>>,
-                 std::negation<std::is_convertible<const expected<U, G> &&, T>>,
-                 std::negation<
-                     std::is_constructible<unexpected<E>, expected<U, G>&>>,
-                 std::negation<
-                     std::is_constructible<unexpected<E>, expected<U, G>>>,
-                 std::negation<std::is_constructible<unexpected<E>,
-                                                     const expected<U, G>&>>,
-                 std::negation<std::is_constructible<unexpected<E>,
-                                                     const expected<U, G>>>>)
-    constexpr explicit(!std::is_convertible_v<const U&, T> ||
-                       !std::is_convertible_v<const G&, E>)
-        expected(const expected<U, G>& rhs)
-        : invalid_{}, has_val_(rhs.has_value()) {
-        if (has_val_)
-            std::construct_at(std::addressof(val_),
-                              std::forward<const U&>(*rhs));
-        else
-            std::construct_at(std::addressof(unex_),
-                              std::forward<const G&>(rhs.error()));
+namespace detail {
+using counter = std::atomic<std::uint64_t> expected_counters::*;
+
+struct counter_field {
+    const char* name;
+    counter member;
+};
+
+inline constexpr counter_field counter_fields[] = {
+    {"copy_constructions", &expected_counters::copy_constructions},
+    {"move_constructions", &expected_counters::move_constructions},
+    {"copy_assignments", &expected_counters::copy_assignments},
+    {"move_assignments", &expected_counters::move_assignments},
+    {"reinit_temporaries", &expected_counters::reinit_temporaries},
+    {"value_or_copies", &expected_counters::value_or_copies},
+    {"bad_access_throws", &expected_counters::bad_access_throws},
+    {"error_constructions", &expected_counters::error_constructions},
+};
+
+// The name of X as the compiler spells it in a function signature.
+template <class X>
+constexpr std::string_view type_name() noexcept {
+#if defined(__clang__) || defined(__GNUC__)
+    constexpr std::string_view sig = __PRETTY_FUNCTION__;
+    constexpr auto first = sig.find("X = ") + 4;
+    constexpr auto last = sig.find_first_of(";]", first);
+    return sig.substr(first, last - first);
+#elif defined(_MSC_VER)
+    constexpr std::string_view sig = __FUNCSIG__;
+    constexpr auto first = sig.find("type_name<") + 10;
+    constexpr auto last = sig.rfind(">(void)");
+    return sig.substr(first, last - first);
+#else
+    return "unknown";
+#endif
+}
+
+inline void dump_expected_counters_at_exit() noexcept;
+
+// The counters of one specialization, linked into the registry the first
+// time one of them is incremented. Constant initialized and trivially
+// destructible, so they are still readable while the program exits.
+struct counter_entry {
+    constexpr explicit counter_entry(std::string_view name) noexcept
+        : name(name) {}
+
+    std::string_view name;
+    expected_counters counters;
+    std::atomic<bool> enlisted{false};
+    counter_entry* next = nullptr;
+
+    static inline std::atomic<counter_entry*> head{nullptr};
+
+    void enlist() noexcept {
+        if (enlisted.load(std::memory_order_acquire) ||
+            enlisted.exchange(true, std::memory_order_acq_rel))
+            return;
+        next = head.load(std::memory_order_relaxed);
+        while (!head.compare_exchange_weak(next, this,
+                                           std::memory_order_release,
+                                           std::memory_order_relaxed)) {
+        }
+        [[maybe_unused]] static const bool at_exit =
+            std::atexit(&dump_expected_counters_at_exit) == 0;
     }
+};
 
-    template <class U, class G, class UF = U, class GF = G>
-        requires(std::conjunction_v<
-                 std::is_constructible<T, UF>, std::is_constructible<E, GF>,
-                 std::negation<std::is_constructible<T, expected<U, G>&>>,
-                 std::negation<std::is_constructible<T, expected<U, G>>>,
-                 std::negation<std::is_constructible<T, const expected<U, G>&>>,
-                 std::negation<std::is_constructible<T, const expected<U, G>>>,
-                 std::negation<std::is_convertible<expected<U, G>&, T>>,
-                 std::negation<std::is_convertible<expected<U, G> &&, T>>,
-                 std::negation<std::is_convertible<const expected<U, G>&, T>>,
-                 std::negation<std::is_convertible<const expected<U, G> &&, T>>,
-                 std::negation<
-                     std::is_constructible<unexpected<E>, expected<U, G>&>>,
-                 std::negation<
-                     std::is_constructible<unexpected<E>, expected<U, G>>>,
-                 std::negation<std::is_constructible<unexpected<E>,
-                                                     const expected<U, G>&>>,
-                 std::negation<std::is_constructible<unexpected<E>,
-                                                     const expected<U, G>>>>)
-    constexpr explicit(!std::is_convertible_v<U, T> ||
-                       !std::is_convertible_v<G, E>)
-        expected(expected<U, G>&& rhs)
-        : invalid_{}, has_val_(rhs.has_value()) {
-        if (has_val_)
-            std::construct_at(std::addressof(val_), std::forward<U>(*rhs));
-        else
-            std::construct_at(std::addressof(unex_),
-                              std::forward<G>(rhs.error()));
+template <class X>
+inline constinit counter_entry counters_for{type_name<X>()};
+
+template <class X>
+constexpr void count(counter c) noexcept {
+    if (std::is_constant_evaluated())
+        return;
+    auto& entry = counters_for<X>;
+    entry.enlist();
+    (entry.counters.*c).fetch_add(1, std::memory_order_relaxed);
+}
+} // namespace detail
+
+template <class T, class E>
+const expected_counters& expected_counters_of() noexcept {
+    return detail::counters_for<expected<T, E>>.counters;
+}
+
+// Calls f(name, counters) for every specialization that has counted
+// something, most recently seen first.
+template <class F>
+void for_each_expected_counters(F&& f) {
+    for (auto* e = detail::counter_entry::head.load(std::memory_order_acquire);
+         e; e = e->next)
+        f(e->name, static_cast<const expected_counters&>(e->counters));
+}
+
+inline void reset_expected_counters() noexcept {
+    for (auto* e = detail::counter_entry::head.load(std::memory_order_acquire);
+         e; e = e->next)
+        for (const auto& field : detail::counter_fields)
+            (e->counters.*field.member).store(0, std::memory_order_relaxed);
+}
+
+inline void write_expected_counters_json(std::FILE* out) {
+    std::fputs("{", out);
+    const char* sep = "\n";
+    for_each_expected_counters(
+        [&](std::string_view name, const expected_counters& c) {
+            std::fprintf(out, "%s  \"", sep);
+            for (char ch : name) {
+                if (ch == '"' || ch == '\\')
+                    std::fputc('\\', out);
+                std::fputc(ch, out);
+            }
+            std::fputs("\": {", out);
+            const char* field_sep = "";
+            for (const auto& field : detail::counter_fields) {
+                std::fprintf(out, "%s\"%s\": %llu", field_sep, field.name,
+                             static_cast<unsigned long long>(
+                                 (c.*field.member).load(
+                                     std::memory_order_relaxed)));
+                field_sep = ", ";
+            }
+            std::fputs("}", out);
+            sep = ",\n";
+        });
+    std::fputs("\n}\n", out);
+}
+
+inline void detail::dump_expected_counters_at_exit() noexcept {
+    const char* path = std::getenv("BST_EXPECTED_COUNTERS");
+    if (!path || !*path)
+        return;
+    if (std::string_view(path) == "-") {
+        write_expected_counters_json(stderr);
+    } else if (std::FILE* out = std::fopen(path, "w")) {
+        write_expected_counters_json(out);
+        std::fclose(out);
     }
+}
 
-    //
-    // Converting constructor from value
-    //
+// Counts an event of the expected specialization whose member uses it.
+#define BST_EXPECTED_COUNT(event)                                             \
+    ::bst::detail::count<expected>(&::bst::expected_counters::event)
 
-    template <class U = T>
-        requires(!std::is_same_v<std::remove_cvref_t<U>, std::in_place_t> &&
-                 !std::is_same_v<expected<T, E>, std::remove_cvref_t<U>> &&
-                 std::is_constructible_v<T, U>)
-    constexpr explicit(!std::is_convertible_v<U, T>) expected(U&& v)
-        : val_(std::forward<U>(v)), has_val_(true) {}
+#else
 
-    //
-    // Construct from unexpected
-    //
+#define BST_EXPECTED_COUNT(event) static_cast<void>(0)
 
-    template <class G>
-        requires std::is_constructible_v<E, const G&>
-    constexpr explicit(!std::is_convertible_v<const G&, E>)
-        expected(const unexpected<G>& e)
-        : unex_(std::forward<const G&>(e.error())), has_val_(false) {}
+#endif
 
-    template <class G>
-        requires std::is_constructible_v<E, G>
-    constexpr explicit(!std::is_convertible_v<G, E>) expected(unexpected<G>&& e)
-        : unex_(std::forward<G>(e.error())), has_val_(false) {}
 
-    //
-    // In-place construct expected value
-    //
 
-    template <class... Args>
-        requires std::is_constructible_v<T, Args...>
-    constexpr explicit expected(std::in_place_t, Args&&... args)
-        : val_(std::forward<Args>(args)...), has_val_(true) {}
+//
+// struct expected_niche_traits<T>
+//
+// Describes a bit pattern that no valid T ever holds. When T has such a
+// niche and E fits in the bytes of T that the pattern leaves alone,
+// expected<T, E> stores the error beside the pattern and drops its separate
+// discriminant, so that it is no larger than T.
+//
+// A specialization provides
+//
+//   static constexpr std::size_t offset;            // first byte of the pattern
+//   static constexpr std::size_t size;              // bytes in the pattern
+//   static constexpr void set(std::byte* p) noexcept;         // write it
+//   static constexpr bool test(const std::byte* p) noexcept;  // present?
+//
+// where p points to sizeof(T) bytes of storage. test() is called on storage
+// holding either a live T or the written pattern, and must return false for
+// every valid T. The primary template provides no niche: types opt in, so
+// that the layout of expected<T, E> never depends on what else is visible
+// where it is first used.
+//
+// A niche of T is read through the object representation, which constant
+// evaluation does not allow, so expected<T, E> is then usable only at run
+// time. expected<void, E> with a niche of E stays usable in constant
+// expressions when E is trivially copyable and not a pointer.
+//
 
-    template <class U, class... Args>
-        requires(std::is_constructible_v<T, std::initializer_list<U>&,
-                                         Args...>) //
-    constexpr explicit expected(std::in_place_t, std::initializer_list<U> il,
-                                Args&&... args)
-        : val_(il, std::forward<Args>(args)...), has_val_(true) {}
+template <class T>
+struct expected_niche_traits {};
 
-    //
-    // In-place construct unexpected value
-    //
+namespace detail {
+template <std::size_t N>
+struct byte_image {
+    std::byte bytes[N];
+};
 
-    template <class... Args>
-        requires std::is_constructible_v<E, Args...>
-    constexpr explicit expected(unexpect_t, Args&&... args)
-        : unex_(std::forward<Args>(args)...), has_val_(false) {}
+// The object a pointer-like P refers to.
+template <class P>
+struct niche_pointee {};
 
-    template <class U, class... Args>
-        requires(std::is_constructible_v<E, std::initializer_list<U>&, Args...>)
-    constexpr explicit expected(unexpect_t, std::initializer_list<U> il,
-                                Args&&... args)
-        : unex_(il, std::forward<Args>(args)...), has_val_(false) {}
+template <class T>
+struct niche_pointee<T*> {
+    using type = T;
+};
 
-    //
-    // Destructor
-    //
+template <class T>
+struct niche_pointee<std::unique_ptr<T>> {
+    using type = std::remove_extent_t<T>;
+};
 
-    constexpr ~expected() {
-        if (has_val_)
+template <class T>
+struct niche_pointee<std::reference_wrapper<T>> {
+    using type = T;
+};
+
+template <class T>
+consteval bool aligned_pointee() {
+    if constexpr (std::is_object_v<T> && requires { sizeof(T); })
+        return alignof(T) > 1;
+    else
+        return false;
+}
+} // namespace detail
+
+//
+// struct pointer_niche_traits<P>
+//
+// A pointer to an object aligned to at least two bytes never has its low bit
+// set. For a T*, std::unique_ptr<T> or std::reference_wrapper<T>, opted in by
+// deriving:
+//
+//   template <>
+//   struct bst::expected_niche_traits<node*>
+//       : bst::pointer_niche_traits<node*> {};
+//
+// node must be complete there.
+//
+
+template <class P>
+struct pointer_niche_traits {
+    static_assert(detail::aligned_pointee<
+                      typename detail::niche_pointee<P>::type>(),
+                  "pointer_niche_traits needs a pointer to a complete object "
+                  "type aligned to at least two bytes");
+    static_assert(sizeof(P) == sizeof(void*));
+
+    static constexpr std::size_t offset =
+        std::endian::native == std::endian::little ? 0 : sizeof(P) - 1;
+    static constexpr std::size_t size = 1;
+
+    static constexpr void set(std::byte* p) noexcept {
+        p[offset] = std::byte{1};
+    }
+    static constexpr bool test(const std::byte* p) noexcept {
+        return (p[offset] & std::byte{1}) != std::byte{};
+    }
+};
+
+//
+// struct enum_niche_traits<Enum, Niche>
+//
+// For enumerations with an unused value. Users opt in by deriving:
+//
+//   template <>
+//   struct bst::expected_niche_traits<color>
+//       : bst::enum_niche_traits<color, color(0xff)> {};
+//
+
+template <class Enum, Enum Niche>
+    requires std::is_enum_v<Enum>
+struct enum_niche_traits {
+    static constexpr std::size_t offset = 0;
+    static constexpr std::size_t size = sizeof(Enum);
+
+    static constexpr void set(std::byte* p) noexcept {
+        const auto image = std::bit_cast<detail::byte_image<size>>(Niche);
+        for (std::size_t i = 0; i != size; ++i)
+            p[i] = image.bytes[i];
+    }
+    static constexpr bool test(const std::byte* p) noexcept {
+        detail::byte_image<size> image;
+        for (std::size_t i = 0; i != size; ++i)
+            image.bytes[i] = p[i];
+        return std::bit_cast<Enum>(image) == Niche;
+    }
+};
+
+
+
+namespace detail {
+template <class T>
+concept has_niche = requires(std::byte* p, const std::byte* cp) {
+    { expected_niche_traits<T>::offset } -> std::convertible_to<std::size_t>;
+    { expected_niche_traits<T>::size } -> std::convertible_to<std::size_t>;
+    expected_niche_traits<T>::set(p);
+    { expected_niche_traits<T>::test(cp) } -> std::convertible_to<bool>;
+};
+
+// Where the error of an expected<T, E> lives inside the storage of T. Without
+// a usable niche the error sits at offset zero and a bool discriminant
+// follows the storage.
+
+template <class T, class E>
+struct niche_layout {
+    static constexpr bool enabled = false;
+    static constexpr std::size_t error_offset = 0;
+};
+
+template <class T, class E>
+    requires has_niche<T>
+struct niche_layout<T, E> {
+    using traits = expected_niche_traits<T>;
+
+    static constexpr std::size_t npos = std::size_t(-1);
+
+    static constexpr std::size_t find_error_offset() {
+        // An empty E has no bytes to protect, so it may overlap the pattern.
+        if (std::is_empty_v<E> || sizeof(E) <= traits::offset)
+            return 0;
+        std::size_t off = traits::offset + traits::size;
+        off = (off + alignof(E) - 1) / alignof(E) * alignof(E);
+        return off + sizeof(E) <= sizeof(T) ? off : npos;
+    }
+
+    static constexpr bool enabled = find_error_offset() != npos;
+    static constexpr std::size_t error_offset =
+        enabled ? find_error_offset() : 0;
+};
+
+// expected<void, E> has no value to store, so a niche of E alone can carry
+// the discriminant.
+
+template <class E>
+struct void_niche_layout {
+    static constexpr bool enabled = false;
+};
+
+template <class E>
+    requires has_niche<E>
+struct void_niche_layout<E> {
+    using traits = expected_niche_traits<E>;
+
+    static constexpr bool enabled = true;
+
+    // Constant evaluation cannot write the pattern into raw storage or read
+    // it back, but it can hold the pattern as an E whose bytes are the
+    // pattern, and compare the bytes of that E. This needs a trivially
+    // copyable E, and one that bit_cast can produce: not a pointer.
+    static constexpr E pattern() noexcept {
+        byte_image<sizeof(E)> image{};
+        traits::set(image.bytes);
+        return std::bit_cast<E>(image);
+    }
+
+    static constexpr bool is_pattern(const E& e) noexcept {
+        return traits::test(std::bit_cast<byte_image<sizeof(E)>>(e).bytes);
+    }
+};
+
+// The error alternative of the union in expected<T, E>, preceded by Offset
+// bytes that are left for the niche pattern of T.
+
+template <class E, std::size_t Offset>
+struct error_storage {
+    template <class... Args>
+    constexpr explicit error_storage(std::in_place_t, Args&&... args) noexcept(
+        std::is_nothrow_constructible_v<E, Args...>)
+        : value(std::forward<Args>(args)...) {}
+
+    template <class F, class... Args>
+    constexpr explicit error_storage(in_place_invoke_t, F&& f, Args&&... args)
+        : value(std::invoke(std::forward<F>(f), std::forward<Args>(args)...)) {}
+
+    std::byte pad_[Offset];
+    E value;
+};
+
+template <class E>
+struct error_storage<E, 0> {
+    template <class... Args>
+    constexpr explicit error_storage(std::in_place_t, Args&&... args) noexcept(
+        std::is_nothrow_constructible_v<E, Args...>)
+        : value(std::forward<Args>(args)...) {}
+
+    template <class F, class... Args>
+    constexpr explicit error_storage(in_place_invoke_t, F&& f, Args&&... args)
+        : value(std::invoke(std::forward<F>(f), std::forward<Args>(args)...)) {}
+
+    E value;
+};
+
+// Stands in for the bool discriminant when the niche of T carries it.
+
+struct empty_discriminant {};
+} // namespace detail
+
+
+
+//
+// struct expected_basic_guarantee<T, E>
+//
+// Switching an expected between its value and its error keeps the strong
+// exception guarantee by default: unless the new alternative can be built
+// without throwing, it is first built in a temporary, or the old alternative
+// is moved aside so that it can be put back. For types whose moves are
+// expensive or may throw, such as containers with non-propagating
+// allocators, that is one extra move per switch.
+//
+// Specializing this trait as true_type trades the strong guarantee for the
+// basic one. The new alternative is then constructed in place, straight
+// after the old one is destroyed. If that construction throws, the expected
+// is left holding a value-initialized E, and the exception propagates:
+//
+//   template <>
+//   struct bst::expected_basic_guarantee<buffer, parse_error>
+//       : std::true_type {};
+//
+// It also enables assignment when neither T nor E is nothrow move
+// constructible. E must be nothrow default constructible, or there is nothing
+// to leave behind when construction throws; specializing it as true_type for
+// any other E is ill-formed.
+//
+
+template <class T, class E>
+struct expected_basic_guarantee : std::false_type {};
+
+template <class T, class E>
+inline constexpr bool expected_basic_guarantee_v =
+    expected_basic_guarantee<T, E>::value;
+
+namespace detail {
+// expected<T, E> rejects the policy for an E that cannot be default
+// constructed without throwing, so the trait alone decides.
+template <class T, class E>
+struct uses_basic_guarantee
+    : std::bool_constant<expected_basic_guarantee_v<T, E>> {};
+} // namespace detail
+
+
+
+//
+// Constraints
+//
+// What the special members and assignments of expected<T, E> are
+// constrained on. The values are computed once per T, E pair, as members of
+// a class template. Each overload that tests a condition, or its negation,
+// then reads the shared result. Otherwise it would instantiate its own
+// std::conjunction chain. All of them are checked as soon as the class is
+// instantiated, since they decide which special members are eligible.
+//
+
+namespace detail {
+template <class T, class E>
+struct expected_traits {
+    static constexpr bool copy_constructible =
+        std::is_copy_constructible_v<T> && std::is_copy_constructible_v<E>;
+    static constexpr bool trivially_copy_constructible =
+        std::is_trivially_copy_constructible_v<T> &&
+        std::is_trivially_copy_constructible_v<E>;
+
+    static constexpr bool move_constructible =
+        std::is_move_constructible_v<T> && std::is_move_constructible_v<E>;
+    static constexpr bool trivially_move_constructible =
+        std::is_trivially_move_constructible_v<T> &&
+        std::is_trivially_move_constructible_v<E>;
+    static constexpr bool nothrow_move_constructible =
+        std::is_nothrow_move_constructible_v<T> &&
+        std::is_nothrow_move_constructible_v<E>;
+
+    static constexpr bool trivially_destructible =
+        std::is_trivially_destructible_v<T> &&
+        std::is_trivially_destructible_v<E>;
+
+    // Switching between the alternatives can keep its exception guarantee.
+    static constexpr bool reinitializable =
+        std::is_nothrow_move_constructible_v<T> ||
+        std::is_nothrow_move_constructible_v<E> ||
+        uses_basic_guarantee<T, E>::value;
+
+    static constexpr bool copy_assignable =
+        copy_constructible && std::is_copy_assignable_v<T> &&
+        std::is_copy_assignable_v<E> && reinitializable;
+    static constexpr bool move_assignable =
+        move_constructible && std::is_move_assignable_v<T> &&
+        std::is_move_assignable_v<E> && reinitializable;
+    static constexpr bool nothrow_move_assignable =
+        nothrow_move_constructible && std::is_nothrow_move_assignable_v<T> &&
+        std::is_nothrow_move_assignable_v<E>;
+
+    static constexpr bool swappable =
+        move_constructible && std::is_swappable_v<T> &&
+        std::is_swappable_v<E> &&
+        (std::is_nothrow_move_constructible_v<T> ||
+         std::is_nothrow_move_constructible_v<E>);
+    static constexpr bool nothrow_swappable =
+        nothrow_move_constructible && std::is_nothrow_swappable_v<T> &&
+        std::is_nothrow_swappable_v<E>;
+};
+
+// Whether expected<U, G> can be converted to expected<T, E> one alternative
+// at a time; it cannot when T or unexpected<E> would take the whole
+// expected<U, G> instead. Shared by the copying and moving converting
+// constructors; for expected<void, E>, T is void and only E is looked at.
+template <class T, class E, class U, class G>
+struct converts_from_expected {
+    using from = expected<U, G>;
+
+    static constexpr bool unexpected_takes_whole =
+        std::is_constructible_v<unexpected<E>, from&> ||
+        std::is_constructible_v<unexpected<E>, from> ||
+        std::is_constructible_v<unexpected<E>, const from&> ||
+        std::is_constructible_v<unexpected<E>, const from>;
+
+    static constexpr bool value_takes_whole = [] {
+        if constexpr (std::is_void_v<T>)
+            return false;
+        else
+            return std::is_constructible_v<T, from&> ||
+                   std::is_constructible_v<T, from> ||
+                   std::is_constructible_v<T, const from&> ||
+                   std::is_constructible_v<T, const from> ||
+                   std::is_convertible_v<from&, T> ||
+                   std::is_convertible_v<from&&, T> ||
+                   std::is_convertible_v<const from&, T> ||
+                   std::is_convertible_v<const from&&, T>;
+    }();
+
+    static constexpr bool value = !unexpected_takes_whole && !value_takes_whole;
+};
+
+template <class T, class E, class U, class G>
+concept convertible_from_expected =
+    converts_from_expected<T, E, U, G>::value;
+} // namespace detail
+
+
+
+//
+// Uses-allocator construction
+//
+// expected<T, E> uses an allocator when either alternative does (see the
+// std::uses_allocator specialization at the end of this file). It then has
+// std::allocator_arg_t constructors, which build the alternative they end up
+// holding by uses-allocator construction. An alternative that does not use
+// the allocator is built as usual. This lets a std::pmr container hand its
+// memory resource to the expecteds it holds.
+//
+// The expected does not store the allocator; the alternative it holds does.
+// An assignment may replace one alternative with the other. If the replaced
+// one has a get_allocator() the new one can take, the new one is built with
+// it. So when both alternatives use the same kind of allocator, an expected
+// keeps its allocator for life. Swapping moves the alternatives, and each
+// takes its allocator along.
+//
+
+namespace detail {
+template <class U, class Alloc, class... Args>
+struct is_constructible_using_allocator
+    : std::conditional_t<
+          std::uses_allocator_v<U, Alloc>,
+          std::disjunction<
+              std::is_constructible<U, std::allocator_arg_t, const Alloc&,
+                                    Args...>,
+              std::is_constructible<U, Args..., const Alloc&>>,
+          std::is_constructible<U, Args...>> {};
+
+template <class U, class Alloc, class... Args>
+inline constexpr bool is_constructible_using_allocator_v =
+    is_constructible_using_allocator<U, Alloc, Args...>::value;
+
+// From holds an allocator that To can be constructed with.
+template <class From, class To>
+concept passes_allocator =
+    requires(const From& from) {
+        typename To::allocator_type;
+        {
+            from.get_allocator()
+        } -> std::convertible_to<typename To::allocator_type>;
+    } && std::uses_allocator_v<To, typename To::allocator_type>;
+} // namespace detail
+
+
+
+//
+// class expected<T, E>
+//
+
+template <class T, class E>
+class expected {
+    using traits = detail::expected_traits<T, E>;
+
+public:
+    static_assert(!std::is_reference_v<T>, "T cannot be a reference type");
+    static_assert(!std::is_function_v<T>, "T cannot be a function type");
+    static_assert(!std::is_same_v<std::in_place_t, std::remove_cv_t<T>>,
+                  "T cannot be std::in_place_t");
+    static_assert(!std::is_same_v<unexpect_t, std::remove_cv_t<T>>,
+                  "T cannot be unexpect_t");
+    static_assert(!detail::is_specialization_of<T, unexpected>::value,
+                  "T must not be a specialization of unexpected");
+    static_assert(std::is_object_v<E> && !std::is_array_v<E> &&
+                      !detail::is_specialization_of<E, unexpected>::value &&
+                      !std::is_const_v<E> && !std::is_volatile_v<E>,
+                  "E must be a valid template argument for unexpected");
+    static_assert(
+        std::disjunction_v<std::negation<expected_basic_guarantee<T, E>>,
+                           std::is_nothrow_default_constructible<E>>,
+        "expected_basic_guarantee<T, E> needs an E that is nothrow default "
+        "constructible, to hold after a failed switch");
+
+    using value_type = T;
+    using error_type = E;
+    using unexpected_type = unexpected<E>;
+
+    template <class U>
+    using rebind = expected<U, error_type>;
+
+    //
+    // Default constructor
+    //
+
+    constexpr expected()
+        requires std::is_default_constructible_v<T>
+    : val_() {
+        set_has_val(true);
+    }
+
+    //
+    // Copy constructor
+    //
+
+    constexpr expected(const expected& rhs)
+        requires(traits::copy_constructible &&
+                 !traits::trivially_copy_constructible)
+        : invalid_{} {
+        BST_EXPECTED_COUNT(copy_constructions);
+        if (rhs.has_value()) {
+            std::construct_at(std::addressof(val_), *rhs);
+        } else {
+            BST_EXPECTED_COUNT(error_constructions);
+            std::construct_at(std::addressof(unex_), std::in_place,
+                              rhs.error());
+        }
+        set_has_val(rhs.has_value());
+    }
+
+    constexpr expected(const expected& rhs)
+        requires(!traits::copy_constructible)
+    = delete;
+
+    constexpr expected(const expected&)
+        requires traits::trivially_copy_constructible
+    = default;
+
+    //
+    // Move constructor
+    //
+
+    constexpr expected(expected&& rhs) noexcept(
+        traits::nothrow_move_constructible)
+        requires(traits::move_constructible &&
+                 !traits::trivially_move_constructible)
+        : invalid_{} {
+        BST_EXPECTED_COUNT(move_constructions);
+        if (rhs.has_value()) {
+            std::construct_at(std::addressof(val_), std::move(*rhs));
+        } else {
+            BST_EXPECTED_COUNT(error_constructions);
+            std::construct_at(std::addressof(unex_), std::in_place,
+                              std::move(rhs.error()));
+        }
+        set_has_val(rhs.has_value());
+    }
+
+    constexpr expected(expected&&)
+        requires traits::trivially_move_constructible
+    = default;
+
+    //
+    // Converting constructor
+    //
+
+    template <class U, class G, class UF = const U&, class GF = const G&>
+        requires(std::is_constructible_v<T, UF> &&
+                 std::is_constructible_v<E, GF> &&
+                 detail::convertible_from_expected<T, E, U, G>)
+    constexpr explicit(!std::is_convertible_v<const U&, T> ||
+                       !std::is_convertible_v<const G&, E>)
+        expected(const expected<U, G>& rhs)
+        : invalid_{} {
+        BST_EXPECTED_COUNT(copy_constructions);
+        if (rhs.has_value()) {
+            std::construct_at(std::addressof(val_),
+                              std::forward<const U&>(*rhs));
+        } else {
+            BST_EXPECTED_COUNT(error_constructions);
+            std::construct_at(std::addressof(unex_), std::in_place,
+                              std::forward<const G&>(rhs.error()));
+        }
+        set_has_val(rhs.has_value());
+    }
+
+    template <class U, class G, class UF = U, class GF = G>
+        requires(std::is_constructible_v<T, UF> &&
+                 std::is_constructible_v<E, GF> &&
+                 detail::convertible_from_expected<T, E, U, G>)
+    constexpr explicit(!std::is_convertible_v<U, T> ||
+                       !std::is_convertible_v<G, E>)
+        expected(expected<U, G>&& rhs)
+        : invalid_{} {
+        BST_EXPECTED_COUNT(move_constructions);
+        if (rhs.has_value()) {
+            std::construct_at(std::addressof(val_), std::forward<U>(*rhs));
+        } else {
+            BST_EXPECTED_COUNT(error_constructions);
+            std::construct_at(std::addressof(unex_), std::in_place,
+                              std::forward<G>(rhs.error()));
+        }
+        set_has_val(rhs.has_value());
+    }
+
+    //
+    // Converting constructor from value
+    //
+
+    template <class U = T>
+        requires(!std::is_same_v<std::remove_cvref_t<U>, std::in_place_t> &&
+                 !std::is_same_v<expected<T, E>, std::remove_cvref_t<U>> &&
+                 std::is_constructible_v<T, U>)
+    constexpr explicit(!std::is_convertible_v<U, T>) expected(U&& v)
+        : val_(std::forward<U>(v)) {
+        set_has_val(true);
+    }
+
+    //
+    // Construct from unexpected
+    //
+
+    template <class G>
+        requires std::is_constructible_v<E, const G&>
+    constexpr explicit(!std::is_convertible_v<const G&, E>)
+        expected(const unexpected<G>& e)
+        : unex_(std::in_place, std::forward<const G&>(e.error())) {
+        BST_EXPECTED_COUNT(error_constructions);
+        set_has_val(false);
+    }
+
+    template <class G>
+        requires std::is_constructible_v<E, G>
+    constexpr explicit(!std::is_convertible_v<G, E>) expected(unexpected<G>&& e)
+        : unex_(std::in_place, std::forward<G>(e.error())) {
+        BST_EXPECTED_COUNT(error_constructions);
+        set_has_val(false);
+    }
+
+    //
+    // In-place construct expected value
+    //
+
+    template <class... Args>
+        requires std::is_constructible_v<T, Args...>
+    constexpr explicit expected(std::in_place_t, Args&&... args)
+        : val_(std::forward<Args>(args)...) {
+        set_has_val(true);
+    }
+
+    template <class U, class... Args>
+        requires(std::is_constructible_v<T, std::initializer_list<U>&,
+                                         Args...>) //
+    constexpr explicit expected(std::in_place_t, std::initializer_list<U> il,
+                                Args&&... args)
+        : val_(il, std::forward<Args>(args)...) {
+        set_has_val(true);
+    }
+
+    //
+    // In-place construct unexpected value
+    //
+
+    template <class... Args>
+        requires std::is_constructible_v<E, Args...>
+    constexpr explicit expected(unexpect_t, Args&&... args)
+        : unex_(std::in_place, std::forward<Args>(args)...) {
+        BST_EXPECTED_COUNT(error_constructions);
+        set_has_val(false);
+    }
+
+    template <class U, class... Args>
+        requires(std::is_constructible_v<E, std::initializer_list<U>&, Args...>)
+    constexpr explicit expected(unexpect_t, std::initializer_list<U> il,
+                                Args&&... args)
+        : unex_(std::in_place, il, std::forward<Args>(args)...) {
+        BST_EXPECTED_COUNT(error_constructions);
+        set_has_val(false);
+    }
+
+    //
+    // Allocator-extended constructors
+    //
+
+    template <class Alloc>
+        requires detail::is_constructible_using_allocator_v<T, Alloc>
+    constexpr expected(std::allocator_arg_t, const Alloc& a) : invalid_{} {
+        construct_val_using(a);
+    }
+
+    template <class Alloc, class X, class UF = decltype(*std::declval<X>()),
+              class GF = decltype(std::declval<X>().error())>
+        requires(detail::is_expected<std::remove_cvref_t<X>>::value &&
+                 detail::is_constructible_using_allocator_v<T, Alloc, UF> &&
+                 detail::is_constructible_using_allocator_v<E, Alloc, GF>)
+    constexpr explicit(!std::is_convertible_v<UF, T> ||
+                       !std::is_convertible_v<GF, E>)
+        expected(std::allocator_arg_t, const Alloc& a, X&& rhs)
+        : invalid_{} {
+        if constexpr (std::is_lvalue_reference_v<X>)
+            BST_EXPECTED_COUNT(copy_constructions);
+        else
+            BST_EXPECTED_COUNT(move_constructions);
+        if (rhs.has_value())
+            construct_val_using(a, *std::forward<X>(rhs));
+        else
+            construct_unex_using(a, std::forward<X>(rhs).error());
+    }
+
+    template <class Alloc, class U = T>
+        requires(!std::is_same_v<std::remove_cvref_t<U>, std::in_place_t> &&
+                 !std::is_same_v<std::remove_cvref_t<U>, unexpect_t> &&
+                 !detail::is_expected<std::remove_cvref_t<U>>::value &&
+                 !detail::is_specialization_of<std::remove_cvref_t<U>,
+                                               unexpected>::value &&
+                 detail::is_constructible_using_allocator_v<T, Alloc, U>)
+    constexpr explicit(!std::is_convertible_v<U, T>)
+        expected(std::allocator_arg_t, const Alloc& a, U&& v)
+        : invalid_{} {
+        construct_val_using(a, std::forward<U>(v));
+    }
+
+    template <class Alloc, class G>
+        requires detail::is_constructible_using_allocator_v<E, Alloc,
+                                                            const G&>
+    constexpr explicit(!std::is_convertible_v<const G&, E>)
+        expected(std::allocator_arg_t, const Alloc& a, const unexpected<G>& e)
+        : invalid_{} {
+        construct_unex_using(a, e.error());
+    }
+
+    template <class Alloc, class G>
+        requires detail::is_constructible_using_allocator_v<E, Alloc, G>
+    constexpr explicit(!std::is_convertible_v<G, E>)
+        expected(std::allocator_arg_t, const Alloc& a, unexpected<G>&& e)
+        : invalid_{} {
+        construct_unex_using(a, std::move(e).error());
+    }
+
+    template <class Alloc, class... Args>
+        requires detail::is_constructible_using_allocator_v<T, Alloc, Args...>
+    constexpr explicit expected(std::allocator_arg_t, const Alloc& a,
+                                std::in_place_t, Args&&... args)
+        : invalid_{} {
+        construct_val_using(a, std::forward<Args>(args)...);
+    }
+
+    template <class Alloc, class... Args>
+        requires detail::is_constructible_using_allocator_v<E, Alloc, Args...>
+    constexpr explicit expected(std::allocator_arg_t, const Alloc& a,
+                                unexpect_t, Args&&... args)
+        : invalid_{} {
+        construct_unex_using(a, std::forward<Args>(args)...);
+    }
+
+    //
+    // Destructor
+    //
+
+    constexpr ~expected() {
+        if (has_val())
             std::destroy_at(std::addressof(val_));
         else
             std::destroy_at(std::addressof(unex_));
     }
 
     constexpr ~expected()
-        requires(std::conjunction_v<std::is_trivially_destructible<T>,
-                                    std::is_trivially_destructible<E>>)
+        requires traits::trivially_destructible
+    = default;
+
+    // Copy Assignment Operator
+
+    constexpr expected& operator=(const expected& rhs)
+        requires traits::copy_assignable
+    {
+        BST_EXPECTED_COUNT(copy_assignments);
+        if (has_val() && rhs.has_val())
+            val_ = *rhs;
+        else if (has_val())
+            reinit_error(rhs.error());
+        else if (rhs.has_val())
+            reinit_value(*rhs);
+        else
+            unex_.value = rhs.error();
+
+        set_has_val(rhs.has_value());
+        return *this;
+    }
+
+    constexpr expected& operator=(const expected&)
+        requires(!traits::copy_assignable)
+    = delete;
+
+    // Move Assignment Operator
+
+    constexpr expected& operator=(expected&& rhs) noexcept(
+        traits::nothrow_move_assignable)
+        requires traits::move_assignable
+    {
+        BST_EXPECTED_COUNT(move_assignments);
+        if (has_val() && rhs.has_val())
+            val_ = std::move(*rhs);
+        else if (has_val())
+            reinit_error(std::move(rhs.error()));
+        else if (rhs.has_val())
+            reinit_value(std::move(*rhs));
+        else
+            unex_.value = std::move(rhs.error());
+
+        set_has_val(rhs.has_value());
+        return *this;
+    }
+
+    // Value Assignment Operator
+
+    template <class U = T>
+        requires(!std::is_same_v<expected, std::remove_cvref_t<U>> &&
+                 !detail::is_specialization_of<std::remove_cvref_t<U>,
+                                               unexpected>::value &&
+                 std::is_constructible_v<T, U> &&
+                 std::is_assignable_v<T&, U> &&
+                 (std::is_nothrow_constructible_v<T, U> ||
+                  traits::reinitializable))
+    constexpr expected& operator=(U&& v) {
+        if (has_val())
+            val_ = std::forward<U>(v);
+        else {
+            reinit_value(std::forward<U>(v));
+            set_has_val(true);
+        }
+        return *this;
+    }
+
+    // Unexpected Copy Assignment Operator
+
+    template <class G, class GF = const G&>
+        requires(std::is_constructible_v<E, GF> &&
+                 std::is_assignable_v<E&, GF> &&
+                 (std::is_nothrow_constructible_v<E, GF> ||
+                  traits::reinitializable))
+    constexpr expected& operator=(const unexpected<G>& e) {
+        if (has_val()) {
+            reinit_error(std::forward<GF>(e.error()));
+            set_has_val(false);
+        } else {
+            unex_.value = std::forward<GF>(e.error());
+        }
+        return *this;
+    }
+
+    // Unexpected Move Assignment Operator
+
+    template <class G, class GF = G>
+        requires(std::is_constructible_v<E, GF> &&
+                 std::is_assignable_v<E&, GF> &&
+                 (std::is_nothrow_constructible_v<E, GF> ||
+                  traits::reinitializable))
+    constexpr expected& operator=(unexpected<G>&& e) {
+        if (has_val()) {
+            reinit_error(std::forward<GF>(e.error()));
+            set_has_val(false);
+        } else {
+            unex_.value = std::forward<GF>(e.error());
+        }
+        return *this;
+    }
+
+    template <class... Args>
+        requires std::is_nothrow_constructible_v<T, Args...>
+    constexpr T& emplace(Args&&... args) noexcept {
+        if (has_val())
+            std::destroy_at(std::addressof(val_));
+        else
+            std::destroy_at(std::addressof(unex_));
+        std::construct_at(std::addressof(val_), std::forward<Args>(args)...);
+        set_has_val(true);
+        return val_;
+    }
+
+    template <class U, class... Args>
+        requires std::is_nothrow_constructible_v<T,
+                                                 std::initializer_list<U>
+                                                 &,
+                                                 Args...> constexpr T&
+        emplace(std::initializer_list<U> li, Args&&... args) noexcept {
+        if (has_val())
+            std::destroy_at(std::addressof(val_));
+        else
+            std::destroy_at(std::addressof(unex_));
+        std::construct_at(std::addressof(val_), li, std::forward<Args>(args)...);
+        set_has_val(true);
+        return val_;
+    }
+
+    constexpr void swap(expected& rhs) noexcept(traits::nothrow_swappable)
+        requires traits::swappable
+    {
+        if (has_val() && rhs.has_val()) {
+            using std::swap;
+            swap(val_, rhs.val_);
+        } else if (!has_val() && rhs.has_val()) {
+            rhs.swap(*this);
+        } else if (!has_val() && !rhs.has_val()) {
+            using std::swap;
+            swap(unex_.value, rhs.unex_.value);
+        } else {
+            // rhs.value() is false, this->has_value() is true.
+
+            if constexpr (std::is_nothrow_move_constructible_v<E>) {
+                E tmp(std::move(rhs.unex_.value));
+                std::destroy_at(std::addressof(rhs.unex_));
+                BST_EXPECTED_TRY {
+                    std::construct_at(std::addressof(rhs.val_),
+                                      std::move(val_));
+                    std::destroy_at(std::addressof(val_));
+                    std::construct_at(std::addressof(unex_), std::in_place,
+                                      std::move(tmp));
+                } BST_EXPECTED_CATCH_ALL {
+                    std::construct_at(std::addressof(rhs.unex_),
+                                      std::in_place, std::move(tmp));
+                    rhs.set_has_val(false);
+                    if constexpr (!std::is_nothrow_move_constructible_v<T>)
+                        BST_EXPECTED_RETHROW;
+                }
+            } else {
+                T tmp(std::move(val_));
+                std::destroy_at(std::addressof(val_));
+                BST_EXPECTED_TRY {
+                    std::construct_at(std::addressof(unex_), std::in_place,
+                                      std::move(rhs.unex_.value));
+                    std::destroy_at(std::addressof(rhs.unex_));
+                    std::construct_at(std::addressof(rhs.val_), std::move(tmp));
+                } BST_EXPECTED_CATCH_ALL {
+                    std::construct_at(std::addressof(val_), std::move(tmp));
+                    BST_EXPECTED_RETHROW;
+                }
+            }
+            set_has_val(false);
+            rhs.set_has_val(true);
+        }
+    }
+
+    friend constexpr void swap(expected& x,
+                               expected& y) noexcept(noexcept(x.swap(y))) {
+        x.swap(y);
+    }
+
+    // Querying
+
+    constexpr explicit operator bool() const noexcept { return has_val(); }
+    constexpr bool has_value() const noexcept { return has_val(); }
+
+    // Visitors
+
+    constexpr const T* operator->() const noexcept {
+        return std::addressof(val_);
+    }
+    constexpr T* operator->() noexcept { return std::addressof(val_); }
+
+    constexpr const T& operator*() const& noexcept { return val_; }
+    constexpr T& operator*() & noexcept { return val_; }
+    constexpr const T&& operator*() const&& noexcept { return std::move(val_); }
+    constexpr T&& operator*() && noexcept { return std::move(val_); }
+
+    constexpr const T& value() const& {
+        if (!has_val()) [[unlikely]] {
+            BST_EXPECTED_COUNT(bad_access_throws);
+            detail::throw_bad_expected_access(std::as_const(error()));
+        }
+        return val_;
+    }
+    constexpr T& value() & {
+        if (!has_val()) [[unlikely]] {
+            BST_EXPECTED_COUNT(bad_access_throws);
+            detail::throw_bad_expected_access(std::as_const(error()));
+        }
+        return val_;
+    }
+
+    constexpr const T&& value() const&& {
+        if (!has_val()) [[unlikely]] {
+            BST_EXPECTED_COUNT(bad_access_throws);
+            detail::throw_bad_expected_access(std::move(error()));
+        }
+        return std::move(val_);
+    }
+
+    constexpr T&& value() && {
+        if (!has_val()) [[unlikely]] {
+            BST_EXPECTED_COUNT(bad_access_throws);
+            detail::throw_bad_expected_access(std::move(error()));
+        }
+        return std::move(val_);
+    }
+
+    constexpr const E& error() const& { return unex_.value; }
+    constexpr E& error() & { return unex_.value; }
+    constexpr const E&& error() const&& { return std::move(unex_.value); }
+    constexpr E&& error() && { return std::move(unex_.value); }
+
+    template <class U>
+    constexpr T value_or(U&& v) const& {
+        static_assert(std::conjunction_v<std::is_copy_constructible<T>,
+                                         std::is_convertible<U, T>>);
+
+        if (has_val()) {
+            BST_EXPECTED_COUNT(value_or_copies);
+            return **this;
+        }
+        return static_cast<T>(std::forward<U>(v));
+    }
+
+    template <class U>
+    constexpr T value_or(U&& v) && {
+        static_assert(std::conjunction_v<std::is_move_constructible<T>,
+                                         std::is_convertible<U, T>>);
+
+        return has_val() ? std::move(**this)
+                        : static_cast<T>(std::forward<U>(v));
+    }
+
+    // Monadic operations
+
+    template <class F>
+        requires std::is_constructible_v<E, E&>
+    constexpr auto and_then(F&& f) & {
+        return and_then_impl(*this, std::forward<F>(f));
+    }
+    template <class F>
+        requires std::is_constructible_v<E, E&&>
+    constexpr auto and_then(F&& f) && {
+        return and_then_impl(std::move(*this), std::forward<F>(f));
+    }
+    template <class F>
+        requires std::is_constructible_v<E, const E&>
+    constexpr auto and_then(F&& f) const& {
+        return and_then_impl(*this, std::forward<F>(f));
+    }
+    template <class F>
+        requires std::is_constructible_v<E, const E&&>
+    constexpr auto and_then(F&& f) const&& {
+        return and_then_impl(std::move(*this), std::forward<F>(f));
+    }
+
+    template <class F>
+        requires std::is_constructible_v<T, T&>
+    constexpr auto or_else(F&& f) & {
+        return or_else_impl(*this, std::forward<F>(f));
+    }
+    template <class F>
+        requires std::is_constructible_v<T, T&&>
+    constexpr auto or_else(F&& f) && {
+        return or_else_impl(std::move(*this), std::forward<F>(f));
+    }
+    template <class F>
+        requires std::is_constructible_v<T, const T&>
+    constexpr auto or_else(F&& f) const& {
+        return or_else_impl(*this, std::forward<F>(f));
+    }
+    template <class F>
+        requires std::is_constructible_v<T, const T&&>
+    constexpr auto or_else(F&& f) const&& {
+        return or_else_impl(std::move(*this), std::forward<F>(f));
+    }
+
+    template <class F>
+        requires std::is_constructible_v<E, E&>
+    constexpr auto transform(F&& f) & {
+        return transform_impl(*this, std::forward<F>(f));
+    }
+    template <class F>
+        requires std::is_constructible_v<E, E&&>
+    constexpr auto transform(F&& f) && {
+        return transform_impl(std::move(*this), std::forward<F>(f));
+    }
+    template <class F>
+        requires std::is_constructible_v<E, const E&>
+    constexpr auto transform(F&& f) const& {
+        return transform_impl(*this, std::forward<F>(f));
+    }
+    template <class F>
+        requires std::is_constructible_v<E, const E&&>
+    constexpr auto transform(F&& f) const&& {
+        return transform_impl(std::move(*this), std::forward<F>(f));
+    }
+
+    template <class F>
+        requires std::is_constructible_v<T, T&>
+    constexpr auto transform_error(F&& f) & {
+        return transform_error_impl(*this, std::forward<F>(f));
+    }
+    template <class F>
+        requires std::is_constructible_v<T, T&&>
+    constexpr auto transform_error(F&& f) && {
+        return transform_error_impl(std::move(*this), std::forward<F>(f));
+    }
+    template <class F>
+        requires std::is_constructible_v<T, const T&>
+    constexpr auto transform_error(F&& f) const& {
+        return transform_error_impl(*this, std::forward<F>(f));
+    }
+    template <class F>
+        requires std::is_constructible_v<T, const T&&>
+    constexpr auto transform_error(F&& f) const&& {
+        return transform_error_impl(std::move(*this), std::forward<F>(f));
+    }
+
+    // Pre-standard spelling of transform_error.
+
+    template <class F>
+    constexpr auto transform_or(F&& f) & {
+        return transform_error(std::forward<F>(f));
+    }
+    template <class F>
+    constexpr auto transform_or(F&& f) && {
+        return std::move(*this).transform_error(std::forward<F>(f));
+    }
+    template <class F>
+    constexpr auto transform_or(F&& f) const& {
+        return transform_error(std::forward<F>(f));
+    }
+    template <class F>
+    constexpr auto transform_or(F&& f) const&& {
+        return std::move(*this).transform_error(std::forward<F>(f));
+    }
+
+    // Equality Comparrison
+
+    template <class T2, class E2>
+        requires(!std::is_void_v<T2>)
+    friend constexpr bool operator==(const expected& x,
+                                     const expected<T2, E2>& y) {
+        // TODO Mandates
+
+        if (x.has_value() != y.has_value())
+            return false;
+        if (x.has_value())
+            return *x == *y;
+        else
+            return x.error() == y.error();
+    }
+
+    template <class T2>
+    friend constexpr bool operator==(const expected& x, const T2& v) {
+        // TODO Mandates
+
+        return x.has_value() && static_cast<bool>(*x == v);
+    }
+
+    template <class E2>
+    friend constexpr bool operator==(const expected& x,
+                                     const unexpected<E2>& e) {
+        // TODO Mandates
+
+        return !x.has_value() && static_cast<bool>(x.error() == e.error());
+    }
+
+private:
+    using layout = detail::niche_layout<T, E>;
+
+    union {
+        struct {} invalid_;
+        T val_;
+        detail::error_storage<E, layout::error_offset> unex_;
+    };
+    BST_EXPECTED_NO_UNIQUE_ADDRESS
+    std::conditional_t<layout::enabled, detail::empty_discriminant, bool>
+        has_val_;
+
+    //
+    // The discriminant. With a niche layout, the error state is marked by
+    // writing the niche pattern of T after the error has been constructed;
+    // constructing a T overwrites the pattern, so entering the value state
+    // needs no store at all.
+    //
+
+    constexpr bool has_val() const noexcept {
+        if constexpr (layout::enabled)
+            return !layout::traits::test(
+                reinterpret_cast<const std::byte*>(std::addressof(val_)));
+        else
+            return has_val_;
+    }
+
+    constexpr void set_has_val(bool v) noexcept {
+        if constexpr (layout::enabled) {
+            if (!v)
+                layout::traits::set(
+                    reinterpret_cast<std::byte*>(std::addressof(val_)));
+        } else {
+            has_val_ = v;
+        }
+    }
+
+    template <class, class>
+    friend class expected;
+    friend class detail::expected_return<T, E>;
+
+    template <class Promise>
+    expected(detail::deferred_init_t, Promise& p) noexcept : invalid_() {
+        p.bind(this, nullptr);
+    }
+
+    //
+    // Construct from the result of invoking f. The result initializes the
+    // union member directly, so no intermediate T or E is materialized.
+    //
+
+    template <class F, class... Args>
+    constexpr explicit expected(detail::in_place_invoke_t, F&& f,
+                                Args&&... args)
+        : val_(std::invoke(std::forward<F>(f), std::forward<Args>(args)...)) {
+        set_has_val(true);
+    }
+
+    template <class F, class... Args>
+    constexpr explicit expected(detail::unexpect_invoke_t, F&& f,
+                                Args&&... args)
+        : unex_(detail::in_place_invoke, std::forward<F>(f),
+                std::forward<Args>(args)...) {
+        BST_EXPECTED_COUNT(error_constructions);
+        set_has_val(false);
+    }
+
+    //
+    // Monadic operation implementations, shared by all four ref-qualified
+    // overloads. Self is deduced as (const) expected& or (const) expected&&.
+    //
+
+    template <class Self, class F>
+    static constexpr auto and_then_impl(Self&& self, F&& f) {
+        using U = std::remove_cvref_t<
+            std::invoke_result_t<F, decltype(*std::forward<Self>(self))>>;
+        static_assert(detail::is_expected<U>::value,
+                      "F must return a specialization of expected");
+        static_assert(std::is_same_v<typename U::error_type, E>,
+                      "F must return an expected with the same error_type");
+
+        if (self.has_val())
+            return std::invoke(std::forward<F>(f), *std::forward<Self>(self));
+        return U(unexpect, std::forward<Self>(self).error());
+    }
+
+    template <class Self, class F>
+    static constexpr auto or_else_impl(Self&& self, F&& f) {
+        using G = std::remove_cvref_t<std::invoke_result_t<
+            F, decltype(std::forward<Self>(self).error())>>;
+        static_assert(detail::is_expected<G>::value,
+                      "F must return a specialization of expected");
+        static_assert(std::is_same_v<typename G::value_type, T>,
+                      "F must return an expected with the same value_type");
+
+        if (self.has_val())
+            return G(std::in_place, *std::forward<Self>(self));
+        return std::invoke(std::forward<F>(f),
+                           std::forward<Self>(self).error());
+    }
+
+    template <class Self, class F>
+    static constexpr auto transform_impl(Self&& self, F&& f) {
+        using U = std::remove_cv_t<
+            std::invoke_result_t<F, decltype(*std::forward<Self>(self))>>;
+
+        if (!self.has_val())
+            return expected<U, E>(unexpect, std::forward<Self>(self).error());
+        if constexpr (std::is_void_v<U>) {
+            std::invoke(std::forward<F>(f), *std::forward<Self>(self));
+            return expected<U, E>();
+        } else {
+            return expected<U, E>(detail::in_place_invoke, std::forward<F>(f),
+                                  *std::forward<Self>(self));
+        }
+    }
+
+    template <class Self, class F>
+    static constexpr auto transform_error_impl(Self&& self, F&& f) {
+        using G = std::remove_cv_t<std::invoke_result_t<
+            F, decltype(std::forward<Self>(self).error())>>;
+
+        if (self.has_val())
+            return expected<T, G>(std::in_place, *std::forward<Self>(self));
+        return expected<T, G>(detail::unexpect_invoke, std::forward<F>(f),
+                              std::forward<Self>(self).error());
+    }
+
+    template <class T2, class U, class... Args>
+    constexpr void reinit_expected(T2& newval, U& oldval, Args&&... args) {
+        if constexpr (std::is_same_v<U, T>)
+            BST_EXPECTED_COUNT(error_constructions);
+        // Without exceptions nothing can fail half way, so there is never a
+        // state to roll back to and no temporary is needed.
+        if constexpr (!detail::exceptions_enabled ||
+                      std::is_nothrow_constructible_v<T2, Args...>) {
+            std::destroy_at(std::addressof(oldval));
+            std::construct_at(std::addressof(newval),
+                              std::forward<Args>(args)...);
+        } else if constexpr (detail::uses_basic_guarantee<T, E>::value) {
+            std::destroy_at(std::addressof(oldval));
+            BST_EXPECTED_TRY {
+                std::construct_at(std::addressof(newval),
+                                  std::forward<Args>(args)...);
+            } BST_EXPECTED_CATCH_ALL {
+                BST_EXPECTED_COUNT(error_constructions);
+                std::construct_at(std::addressof(unex_), std::in_place);
+                set_has_val(false);
+                BST_EXPECTED_RETHROW;
+            }
+        } else if constexpr (std::is_nothrow_move_constructible_v<T2>) {
+            BST_EXPECTED_COUNT(reinit_temporaries);
+            T2 tmp(std::forward<Args>(args)...);
+            std::destroy_at(std::addressof(oldval));
+            std::construct_at(std::addressof(newval), std::move(tmp));
+        } else {
+            BST_EXPECTED_COUNT(reinit_temporaries);
+            U tmp(std::move(oldval));
+            std::destroy_at(std::addressof(oldval));
+            BST_EXPECTED_TRY {
+                std::construct_at(std::addressof(newval),
+                                  std::forward<Args>(args)...);
+            } BST_EXPECTED_CATCH_ALL {
+                std::construct_at(std::addressof(oldval), std::move(tmp));
+                set_has_val(std::is_same_v<U, T>);
+                BST_EXPECTED_RETHROW;
+            }
+        }
+    }
+
+    //
+    // Switching alternatives. When the alternative being replaced holds an
+    // allocator the new one can take, the new one is built with it, by
+    // uses-allocator construction, instead of with a default allocator.
+    //
+
+    template <class... Args>
+    constexpr void reinit_value(Args&&... args) {
+        if constexpr (detail::passes_allocator<E, T>) {
+            const typename T::allocator_type a(unex_.value.get_allocator());
+            std::apply(
+                [&](auto&&... xs) {
+                    reinit_expected(val_, unex_,
+                                    std::forward<decltype(xs)>(xs)...);
+                },
+                std::uses_allocator_construction_args<T>(
+                    a, std::forward<Args>(args)...));
+        } else {
+            reinit_expected(val_, unex_, std::forward<Args>(args)...);
+        }
+    }
+
+    template <class... Args>
+    constexpr void reinit_error(Args&&... args) {
+        if constexpr (detail::passes_allocator<T, E>) {
+            const typename E::allocator_type a(val_.get_allocator());
+            std::apply(
+                [&](auto&&... xs) {
+                    reinit_expected(unex_, val_, std::in_place,
+                                    std::forward<decltype(xs)>(xs)...);
+                },
+                std::uses_allocator_construction_args<E>(
+                    a, std::forward<Args>(args)...));
+        } else {
+            reinit_expected(unex_, val_, std::in_place,
+                            std::forward<Args>(args)...);
+        }
+    }
+
+    template <class Alloc, class... Args>
+    constexpr void construct_val_using(const Alloc& a, Args&&... args) {
+        std::uninitialized_construct_using_allocator(
+            std::addressof(val_), a, std::forward<Args>(args)...);
+        set_has_val(true);
+    }
+
+    template <class Alloc, class... Args>
+    constexpr void construct_unex_using(const Alloc& a, Args&&... args) {
+        BST_EXPECTED_COUNT(error_constructions);
+        std::construct_at(std::addressof(unex_), detail::in_place_invoke,
+                          [&]() -> E {
+                              return std::make_obj_using_allocator<E>(
+                                  a, std::forward<Args>(args)...);
+                          });
+        set_has_val(false);
+    }
+};
+
+
+
+//
+// class expected<void, E>
+//
+
+template <class E>
+class expected<void, E> {
+public:
+    using value_type = void;
+    using error_type = E;
+    using unexpected_type = unexpected<E>;
+
+    template <class U>
+    using rebind = expected<U, error_type>;
+
+    constexpr expected() noexcept { set_has_val(true); }
+
+    constexpr expected(const expected& rhs)
+        requires(std::is_copy_constructible_v<E> &&
+                 !std::is_trivially_copy_constructible_v<E>)
+    {
+        BST_EXPECTED_COUNT(copy_constructions);
+        if (!rhs.has_val()) {
+            BST_EXPECTED_COUNT(error_constructions);
+            std::construct_at(std::addressof(unex_), rhs.error());
+        }
+        set_has_val(rhs.has_val());
+    }
+
+    constexpr expected(const expected&)
+        requires(!std::is_copy_constructible_v<E>)
+    = delete;
+
+    constexpr expected(const expected&)
+        requires(std::is_trivially_copy_constructible_v<E>)
+    = default;
+
+    constexpr expected(expected&& rhs) noexcept(
+        std::is_nothrow_move_constructible_v<E>)
+        requires(std::is_move_constructible_v<E> &&
+                 !std::is_trivially_move_constructible_v<E>)
+    {
+        BST_EXPECTED_COUNT(move_constructions);
+        if (!rhs.has_val()) {
+            BST_EXPECTED_COUNT(error_constructions);
+            std::construct_at(std::addressof(unex_), std::move(rhs.error()));
+        }
+        set_has_val(rhs.has_val());
+    }
+
+    constexpr expected(expected&& rhs)
+        requires(std::is_trivially_move_constructible_v<E>)
+    = default;
+
+    template <class U, class G, class GF = const G&>
+        requires(std::is_void_v<U> && std::is_constructible_v<E, GF> &&
+                 detail::convertible_from_expected<void, E, U, G>)
+    constexpr explicit(!std::is_convertible_v<GF, E>)
+        expected(const expected<U, G>& rhs) {
+        BST_EXPECTED_COUNT(copy_constructions);
+        if (!rhs.has_value()) {
+            BST_EXPECTED_COUNT(error_constructions);
+            std::construct_at(std::addressof(unex_),
+                              std::forward<GF>(rhs.error()));
+        }
+        set_has_val(rhs.has_value());
+    }
+
+    template <class U, class G, class GF = G>
+        requires(std::is_void_v<U> && std::is_constructible_v<E, GF> &&
+                 detail::convertible_from_expected<void, E, U, G>)
+    constexpr explicit(!std::is_convertible_v<GF, E>)
+        expected(expected<U, G>&& rhs) {
+        BST_EXPECTED_COUNT(move_constructions);
+        if (!rhs.has_value()) {
+            BST_EXPECTED_COUNT(error_constructions);
+            std::construct_at(std::addressof(unex_),
+                              std::forward<GF>(rhs.error()));
+        }
+        set_has_val(rhs.has_value());
+    }
+
+    template <class G, class GF = const G&>
+        requires(std::is_constructible_v<E, GF>)
+    constexpr explicit(!std::is_convertible_v<GF, E>)
+        expected(const unexpected<G>& e) {
+        BST_EXPECTED_COUNT(error_constructions);
+        std::construct_at(std::addressof(unex_), std::forward<GF>(e.error()));
+        set_has_val(false);
+    }
+
+    template <class G, class GF = G>
+        requires(std::is_constructible_v<E, GF>)
+    constexpr explicit(!std::is_convertible_v<GF, E>)
+        expected(unexpected<G>&& e) {
+        BST_EXPECTED_COUNT(error_constructions);
+        std::construct_at(std::addressof(unex_), std::forward<GF>(e.error()));
+        set_has_val(false);
+    }
+
+    constexpr explicit expected(std::in_place_t) noexcept {
+        set_has_val(true);
+    }
+
+    template <class... Args>
+        requires(std::is_constructible_v<E, Args...>)
+    constexpr explicit expected(unexpect_t, Args&&... args)
+        : unex_(std::forward<Args>(args)...) {
+        BST_EXPECTED_COUNT(error_constructions);
+        set_has_val(false);
+    }
+
+    template <class U, class... Args>
+        requires(std::is_constructible_v<E, std::initializer_list<U>&, Args...>)
+    constexpr explicit expected(unexpect_t, std::initializer_list<U> il,
+                                Args&&... args)
+        : unex_(il, std::forward<Args>(args)...) {
+        BST_EXPECTED_COUNT(error_constructions);
+        set_has_val(false);
+    }
+
+    //
+    // Allocator-extended constructors
+    //
+
+    template <class Alloc>
+    constexpr expected(std::allocator_arg_t, const Alloc&) noexcept {
+        set_has_val(true);
+    }
+
+    template <class Alloc>
+    constexpr explicit expected(std::allocator_arg_t, const Alloc&,
+                                std::in_place_t) noexcept {
+        set_has_val(true);
+    }
+
+    template <class Alloc, class X,
+              class GF = decltype(std::declval<X>().error())>
+        requires(detail::is_expected<std::remove_cvref_t<X>>::value &&
+                 std::is_void_v<typename std::remove_cvref_t<X>::value_type> &&
+                 detail::is_constructible_using_allocator_v<E, Alloc, GF>)
+    constexpr explicit(!std::is_convertible_v<GF, E>)
+        expected(std::allocator_arg_t, const Alloc& a, X&& rhs) {
+        if constexpr (std::is_lvalue_reference_v<X>)
+            BST_EXPECTED_COUNT(copy_constructions);
+        else
+            BST_EXPECTED_COUNT(move_constructions);
+        if (rhs.has_value())
+            set_has_val(true);
+        else
+            construct_unex_using(a, std::forward<X>(rhs).error());
+    }
+
+    template <class Alloc, class G>
+        requires detail::is_constructible_using_allocator_v<E, Alloc,
+                                                            const G&>
+    constexpr explicit(!std::is_convertible_v<const G&, E>)
+        expected(std::allocator_arg_t, const Alloc& a, const unexpected<G>& e) {
+        construct_unex_using(a, e.error());
+    }
+
+    template <class Alloc, class G>
+        requires detail::is_constructible_using_allocator_v<E, Alloc, G>
+    constexpr explicit(!std::is_convertible_v<G, E>)
+        expected(std::allocator_arg_t, const Alloc& a, unexpected<G>&& e) {
+        construct_unex_using(a, std::move(e).error());
+    }
+
+    template <class Alloc, class... Args>
+        requires detail::is_constructible_using_allocator_v<E, Alloc, Args...>
+    constexpr explicit expected(std::allocator_arg_t, const Alloc& a,
+                                unexpect_t, Args&&... args) {
+        construct_unex_using(a, std::forward<Args>(args)...);
+    }
+
+    constexpr ~expected() {
+        if (!has_val())
+            std::destroy_at(std::addressof(unex_));
+    }
+
+    constexpr ~expected()
+        requires(std::is_trivially_destructible_v<E>)
     = default;
 
-    // Copy Assignment Operator
-
     constexpr expected& operator=(const expected& rhs) {
-        if (has_val_ && rhs.has_val_)
-            val_ = *rhs;
-        else if (has_val_)
-            reinit_expected(unex_, val_, rhs.error());
-        else if (rhs.has_val_)
-            reinit_expected(val_, unex_, *rhs);
-        else
-            unex_ = rhs.error();
+        BST_EXPECTED_COUNT(copy_assignments);
+        if (has_val() && rhs.has_val()) {
+            // No effect
+        } else if (has_val()) {
+            BST_EXPECTED_COUNT(error_constructions);
+            std::construct_at(std::addressof(unex_), rhs.unex_);
+            set_has_val(false);
+        } else if (rhs.has_val()) {
+            std::destroy_at(std::addressof(unex_));
+            set_has_val(true);
+        } else {
+            unex_ = rhs.unex_;
+        }
 
-        has_val_ = rhs.has_value();
         return *this;
     }
 
     constexpr expected& operator=(const expected&)
-        requires(!std::conjunction_v<
-                    std::is_copy_assignable_v<T>, std::is_copy_constructible<T>,
-                    std::is_copy_assignable<E>, std::is_copy_constructible<E>,
-                    std::disjunction<std::is_nothrow_move_constructible<E>,
-                                     std::is_nothrow_move_constructible<T>>>)
+        requires(!std::conjunction_v<std::is_copy_assignable<E>,
+                                     std::is_copy_constructible<E>>)
     = delete;
 
-    // Move Assignment Operator
-
     constexpr expected& operator=(expected&& rhs) noexcept(
-        std::conjunction_v<std::is_nothrow_move_assignable<E>,
-                           std::is_nothrow_move_constructible<E>,
-                           std::is_nothrow_move_assignable<T>,
-                           std::is_nothrow_move_constructible<T>>)
-        requires(std::conjunction_v<
-                 std::is_move_constructible<T>, std::is_move_assignable<T>,
-                 std::is_move_constructible<E>, std::is_move_constructible<E>,
-                 std::disjunction<std::is_nothrow_move_constructible<T>,
-                                  std::is_nothrow_move_constructible<E>>>)
-    {
-        if (has_val_ && rhs.has_val_)
-            val_ = std::move(*rhs);
-        else if (has_val_)
-            reinit_expected(unex_, val_, std::move(rhs.error()));
-        else if (rhs.has_val_)
-            reinit_expected(val_, unex_, std::move(*rhs));
-        else
-            unex_ = std::move(rhs.error());
-
-        has_val_ = rhs.has_val_;
-        return *this;
-    }
-
-    // Value Assignment Operator
-
-    template <class U = T>
-        requires(std::conjunction_v<
-                 std::negation<std::is_same<expected, std::remove_cvref_t<U>>>,
-                 detail::is_specialization_of<std::remove_cvref_t<U>,
-                                              unexpected>,
-                 std::is_constructible<T, U>, std::is_assignable<T&, U>,
-                 std::disjunction<std::is_nothrow_constructible<T, U>,
-                                  std::is_nothrow_move_constructible<T>,
-                                  std::is_nothrow_move_constructible<E>>>)
-    constexpr expected& operator=(U&& v) {
-        if (has_val_)
-            val_ = std::forward<U>(v);
-        else {
-            reinit_expected(val_, unex_, std::forward<U>(v));
-            has_val_ = true;
+        std::conjunction_v<std::is_nothrow_move_constructible<E>,
+                           std::is_nothrow_move_assignable<E>>) {
+        BST_EXPECTED_COUNT(move_assignments);
+        if (has_val() && rhs.has_val()) {
+            // No effect
+        } else if (has_val()) {
+            BST_EXPECTED_COUNT(error_constructions);
+            std::construct_at(std::addressof(unex_), std::move(rhs.unex_));
+            set_has_val(false);
+        } else if (rhs.has_val()) {
+            std::destroy_at(std::addressof(unex_));
+            set_has_val(true);
+        } else {
+            unex_ = std::move(rhs.unex_);
         }
+
         return *this;
     }
 
-    // Unexpected Copy Assignment Operator
+    constexpr expected& operator=(expected&&)
+        requires(!std::conjunction_v<std::is_move_assignable<E>,
+                                     std::is_move_constructible<E>>)
+    = delete;
 
     template <class G, class GF = const G&>
-        requires(std::conjunction_v<
-                 std::is_constructible<E, GF>, std::is_assignable<E&, GF>,
-                 std::disjunction<std::is_nothrow_constructible<E, GF>,
-                                  std::is_nothrow_move_constructible<T>,
-                                  std::is_nothrow_move_constructible<E>>>)
+        requires(std::conjunction_v<std::is_constructible<E, GF>,
+                                    std::is_assignable<E&, GF>>)
     constexpr expected& operator=(const unexpected<G>& e) {
-        if (has_val_) {
-            reinit_expected(unex_, val_, std::forward<GF>(e.error()));
-            has_val_ = false;
+        if (has_val()) {
+            BST_EXPECTED_COUNT(error_constructions);
+            std::construct_at(std::addressof(unex_),
+                              std::forward<GF>(e.error()));
+            set_has_val(false);
         } else {
             unex_ = std::forward<GF>(e.error());
         }
         return *this;
     }
 
-    // Unexpected Move Assignment Operator
-
     template <class G, class GF = G>
-        requires(std::conjunction_v<
-                 std::is_constructible<E, GF>, std::is_assignable<E&, GF>,
-                 std::disjunction<std::is_nothrow_constructible<E, GF>,
-                                  std::is_nothrow_move_constructible<T>,
-                                  std::is_nothrow_move_constructible<E>>>)
+        requires(std::conjunction_v<std::is_constructible<E, GF>,
+                                    std::is_assignable<E&, GF>>)
     constexpr expected& operator=(unexpected<G>&& e) {
-        if (has_val_) {
-            reinit_expected(unex_, val_, std::forward<GF>(e.error()));
-            has_val_ = false;
+        if (has_val()) {
+            BST_EXPECTED_COUNT(error_constructions);
+            std::construct_at(std::addressof(unex_),
+                              std::forward<GF>(e.error()));
+            set_has_val(false);
         } else {
             unex_ = std::forward<GF>(e.error());
         }
         return *this;
     }
 
-    template <class... Args>
-        requires std::is_nothrow_constructible_v<T, Args...>
-    constexpr T& emplace(Args&&... args) noexcept {
-        if (has_val_)
-            std::destroy_at(std::addressof(val_));
-        else {
-            std::destroy_at(std::addressof(val_));
-            has_val_ = true;
-        }
-        return *std::construct_at(std::addressof(val_),
-                                  std::forward<Args>(args)...);
-    }
-
-    template <class U, class... Args>
-        requires std::is_nothrow_constructible_v<T,
-                                                 std::initializer_list<U>
-                                                 &,
-                                                 Args...> constexpr T&
-        emplace(std::initializer_list<U> li, Args&&... args) noexcept {
-        if (has_val_)
-            std::destroy_at(std::addressof(val_));
-        else {
-            std::destroy_at(std::addressof(val_));
-            has_val_ = true;
+    constexpr void emplace() noexcept {
+        if (!has_val()) {
+            std::destroy_at(std::addressof(unex_));
+            set_has_val(true);
         }
-        return *std::construct_at(std::addressof(val_), li,
-                                  std::forward<Args>(args)...);
     }
 
     constexpr void swap(expected& rhs) noexcept(
-        std::conjunction_v<std::is_nothrow_move_constructible<T>,
-                           std::is_nothrow_swappable<T>,
-                           std::is_nothrow_move_constructible<E>,
+        std::conjunction_v<std::is_nothrow_move_constructible<E>,
                            std::is_nothrow_swappable<E>>)
-        requires std::conjunction_v<
-            std::is_swappable<T>,
-            std::is_swappable<E>, std::is_move_constructible<T>,
-            std::is_move_constructible<E>,
-            std::disjunction<std::is_nothrow_move_constructible<T>,
-                             std::is_nothrow_move_constructible<E>>> {
-        if (has_val_ && rhs.has_val_) {
-            using std::swap;
-            swap(val_, rhs.val_);
-        } else if (!has_val_ && rhs.has_val_) {
+        requires(std::conjunction_v<std::is_swappable<E>,
+                                    std::is_move_constructible<E>>)
+    {
+        if (has_val() && rhs.has_val()) {
+            // No effect.
+        } else if (has_val() && !rhs.has_val()) {
+            std::construct_at(std::addressof(unex_), std::move(rhs.unex_));
+            std::destroy_at(std::addressof(rhs.unex_));
+            set_has_val(false);
+            rhs.set_has_val(true);
+        } else if (!has_val() && rhs.has_val()) {
             rhs.swap(*this);
-        } else if (!has_val_ && !rhs.has_val_) {
+        } else {
             using std::swap;
             swap(unex_, rhs.unex_);
-        } else {
-            // rhs.value() is false, this->has_value() is true.
-
-            if constexpr (std::is_nothrow_move_constructible_v<E>) {
-                E tmp(std::move(rhs.unex_));
-                std::destroy_at(std::addressof(rhs.unex_));
-                try {
-                    std::construct_at(std::addressof(rhs.val_),
-                                      std::move(val_));
-                    std::destroy_at(std::addressof(val_));
-                    std::construct_at(std::addressof(unex_), std::move(tmp));
-                } catch (...) {
-                    std::construct_at(std::addressof(rhs.unex_),
-                                      std::move(tmp));
-                    if constexpr (!std::is_nothrow_move_constructible_v<T>)
-                        throw;
-                }
-            } else {
-                T tmp(std::move(val_));
-                std::destroy_at(std::addressof(val_));
-                try {
-                    std::construct_at(std::addressof(unex_),
-                                      std::move(rhs.unex_));
-                    std::destroy_at(std::addressof(rhs.unex_));
-                    std::construct_at(std::addressof(rhs.val_), std::move(tmp));
-                } catch (...) {
-                    std::construct_at(std::addressof(val_), std::move(tmp));
-                    throw;
-                }
-            }
-            has_val_ = false;
-            rhs.has_val_ = true;
         }
     }
 
@@ -804,44 +2494,20 @@ public:
         x.swap(y);
     }
 
-    // Querying
-
-    constexpr explicit operator bool() const noexcept { return has_val_; }
-    constexpr bool has_value() const noexcept { return has_val_; }
-
-    // Visitors
-
-    constexpr const T* operator->() const noexcept {
-        return std::addressof(val_);
-    }
-    constexpr T* operator->() noexcept { return std::addressof(val_); }
-
-    constexpr const T& operator*() const& noexcept { return val_; }
-    constexpr T& operator*() & noexcept { return val_; }
-    constexpr const T&& operator*() const&& noexcept { return std::move(val_); }
-    constexpr T&& operator*() && noexcept { return std::move(val_); }
-
-    constexpr const T& value() const& {
-        if (has_val_)
-            return val_;
-        throw bad_expected_access(error());
-    }
-    constexpr T& value() & {
-        if (has_val_)
-            return val_;
-        throw bad_expected_access(error());
-    }
-
-    constexpr const T&& value() const&& {
-        if (has_val_)
-            return std::move(val_);
-        throw bad_expected_access(error());
+    constexpr explicit operator bool() const noexcept { return has_val(); }
+    constexpr bool has_value() const noexcept { return has_val(); }
+    constexpr void operator*() const noexcept { return; }
+    constexpr void value() const& {
+        if (!has_val()) [[unlikely]] {
+            BST_EXPECTED_COUNT(bad_access_throws);
+            detail::throw_bad_expected_access(error());
+        }
     }
-
-    constexpr T&& value() && {
-        if (has_val_)
-            return std::move(val_);
-        throw bad_expected_access(error());
+    constexpr void value() const&& {
+        if (!has_val()) [[unlikely]] {
+            BST_EXPECTED_COUNT(bad_access_throws);
+            detail::throw_bad_expected_access(std::move(error()));
+        }
     }
 
     constexpr const E& error() const& { return unex_; }
@@ -849,393 +2515,616 @@ public:
     constexpr const E&& error() const&& { return std::move(unex_); }
     constexpr E&& error() && { return std::move(unex_); }
 
-    template <class U>
-    constexpr T value_or(U&& v) const& {
-        static_assert(std::conjunction_v<std::is_copy_constructible<T>,
-                                         std::is_convertible<U, T>>);
+    // Monadic operations
 
-        return has_val_ ? **this : static_cast<T>(std::forward<U>(v));
+    template <class F>
+        requires std::is_constructible_v<E, E&>
+    constexpr auto and_then(F&& f) & {
+        return and_then_impl(*this, std::forward<F>(f));
     }
-
-    template <class U>
-    constexpr T value_or(U&& v) && {
-        static_assert(std::conjunction_v<std::is_move_constructible<T>,
-                                         std::is_convertible<U, T>>);
-
-        return has_val_ ? std::move(**this)
-                        : static_cast<T>(std::forward<U>(v));
+    template <class F>
+        requires std::is_constructible_v<E, E&&>
+    constexpr auto and_then(F&& f) && {
+        return and_then_impl(std::move(*this), std::forward<F>(f));
+    }
+    template <class F>
+        requires std::is_constructible_v<E, const E&>
+    constexpr auto and_then(F&& f) const& {
+        return and_then_impl(*this, std::forward<F>(f));
+    }
+    template <class F>
+        requires std::is_constructible_v<E, const E&&>
+    constexpr auto and_then(F&& f) const&& {
+        return and_then_impl(std::move(*this), std::forward<F>(f));
     }
 
-#ifdef BST_EXPECTED_MONADIC_INTERFACE
     template <class F>
-    constexpr auto and_then(F&& f) &;
+    constexpr auto or_else(F&& f) & {
+        return or_else_impl(*this, std::forward<F>(f));
+    }
     template <class F>
-    constexpr auto and_then(F&& f) &&;
+    constexpr auto or_else(F&& f) && {
+        return or_else_impl(std::move(*this), std::forward<F>(f));
+    }
     template <class F>
-    constexpr auto and_then(F&& f) const&;
+    constexpr auto or_else(F&& f) const& {
+        return or_else_impl(*this, std::forward<F>(f));
+    }
     template <class F>
-    constexpr auto and_then(F&& f) const&&;
+    constexpr auto or_else(F&& f) const&& {
+        return or_else_impl(std::move(*this), std::forward<F>(f));
+    }
 
     template <class F>
-    constexpr auto or_else(F&& f) &;
+        requires std::is_constructible_v<E, E&>
+    constexpr auto transform(F&& f) & {
+        return transform_impl(*this, std::forward<F>(f));
+    }
     template <class F>
-    constexpr auto or_else(F&& f) &&;
+        requires std::is_constructible_v<E, E&&>
+    constexpr auto transform(F&& f) && {
+        return transform_impl(std::move(*this), std::forward<F>(f));
+    }
     template <class F>
-    constexpr auto or_else(F&& f) const&;
+        requires std::is_constructible_v<E, const E&>
+    constexpr auto transform(F&& f) const& {
+        return transform_impl(*this, std::forward<F>(f));
+    }
     template <class F>
-    constexpr auto or_else(F&& f) const&&;
+        requires std::is_constructible_v<E, const E&&>
+    constexpr auto transform(F&& f) const&& {
+        return transform_impl(std::move(*this), std::forward<F>(f));
+    }
 
     template <class F>
-    constexpr auto transform(F&& f) &;
+    constexpr auto transform_error(F&& f) & {
+        return transform_error_impl(*this, std::forward<F>(f));
+    }
     template <class F>
-    constexpr auto transform(F&& f) &&;
+    constexpr auto transform_error(F&& f) && {
+        return transform_error_impl(std::move(*this), std::forward<F>(f));
+    }
     template <class F>
-    constexpr auto transform(F&& f) const&;
+    constexpr auto transform_error(F&& f) const& {
+        return transform_error_impl(*this, std::forward<F>(f));
+    }
     template <class F>
-    constexpr auto transform(F&& f) const&&;
+    constexpr auto transform_error(F&& f) const&& {
+        return transform_error_impl(std::move(*this), std::forward<F>(f));
+    }
+
+    // Pre-standard spelling of transform_error.
 
     template <class F>
-    constexpr auto transform_or(F&& f) &;
+    constexpr auto transform_or(F&& f) & {
+        return transform_error(std::forward<F>(f));
+    }
     template <class F>
-    constexpr auto transform_or(F&& f) &&;
+    constexpr auto transform_or(F&& f) && {
+        return std::move(*this).transform_error(std::forward<F>(f));
+    }
     template <class F>
-    constexpr auto transform_or(F&& f) const&;
+    constexpr auto transform_or(F&& f) const& {
+        return transform_error(std::forward<F>(f));
+    }
     template <class F>
-    constexpr auto transform_or(F&& f) const&&;
-#endif
-
-    // Equality Comparrison
+    constexpr auto transform_or(F&& f) const&& {
+        return std::move(*this).transform_error(std::forward<F>(f));
+    }
 
     template <class T2, class E2>
-        requires(!std::is_void_v<T2>)
+        requires std::is_void_v<T2>
     friend constexpr bool operator==(const expected& x,
                                      const expected<T2, E2>& y) {
-        // TODO Mandates
+        // TODO mandates
 
-        if (x.has_val_ != y.has_val_)
+        if (x.has_val() != y.has_value())
             return false;
-        if (x.has_val_)
-            return x.val_ == y.val_;
-        else
-            return x.unex_ == y.unex_;
-    }
-
-    template <class T2>
-    friend constexpr bool operator==(const expected& x, const T2& v) {
-        // TODO Mandates
-
-        return x.has_val_ && static_cast<bool>(x.val_ == v);
+        return x.has_val() || static_cast<bool>(x.error() == y.error());
     }
 
     template <class E2>
     friend constexpr bool operator==(const expected& x,
                                      const unexpected<E2>& e) {
-        // TODO Mandates
+        // TODO mandates
+
+        return !x.has_val() && static_cast<bool>(x.error() == e.error());
+    }
+
+private:
+    using layout = detail::void_niche_layout<E>;
+
+    union {
+        E unex_;
+    };
+    BST_EXPECTED_NO_UNIQUE_ADDRESS
+    std::conditional_t<layout::enabled, detail::empty_discriminant, bool>
+        has_val_;
+
+    //
+    // The discriminant. With a niche layout, the value state is marked by
+    // writing the niche pattern of E over the unused error storage; the
+    // pattern is never a valid E, so constructing the error replaces it.
+    // Constant evaluation holds the pattern as an E instead.
+    //
+
+    constexpr bool has_val() const noexcept {
+        if constexpr (layout::enabled) {
+            if constexpr (std::is_trivially_copyable_v<E>)
+                if (std::is_constant_evaluated())
+                    return layout::is_pattern(unex_);
+            return layout::traits::test(
+                reinterpret_cast<const std::byte*>(std::addressof(unex_)));
+        } else {
+            return has_val_;
+        }
+    }
+
+    constexpr void set_has_val(bool v) noexcept {
+        if constexpr (layout::enabled) {
+            if constexpr (std::is_trivially_copyable_v<E>) {
+                if (std::is_constant_evaluated()) {
+                    if (v)
+                        std::construct_at(std::addressof(unex_),
+                                          layout::pattern());
+                    return;
+                }
+            }
+            if (v)
+                layout::traits::set(
+                    reinterpret_cast<std::byte*>(std::addressof(unex_)));
+        } else {
+            has_val_ = v;
+        }
+    }
+
+    template <class, class>
+    friend class expected;
+    friend class detail::expected_return<void, E>;
+
+    template <class Promise>
+    expected(detail::deferred_init_t, Promise& p) noexcept {
+        p.bind(this, nullptr);
+    }
+
+    template <class F, class... Args>
+    constexpr explicit expected(detail::unexpect_invoke_t, F&& f,
+                                Args&&... args)
+        : unex_(std::invoke(std::forward<F>(f), std::forward<Args>(args)...)) {
+        BST_EXPECTED_COUNT(error_constructions);
+        set_has_val(false);
+    }
+
+    template <class Alloc, class... Args>
+    constexpr void construct_unex_using(const Alloc& a, Args&&... args) {
+        BST_EXPECTED_COUNT(error_constructions);
+        std::uninitialized_construct_using_allocator(
+            std::addressof(unex_), a, std::forward<Args>(args)...);
+        set_has_val(false);
+    }
 
-        return !x.has_val_ && static_cast<bool>(x.unex_ == e.error());
+    template <class Self, class F>
+    static constexpr auto and_then_impl(Self&& self, F&& f) {
+        using U = std::remove_cvref_t<std::invoke_result_t<F>>;
+        static_assert(detail::is_expected<U>::value,
+                      "F must return a specialization of expected");
+        static_assert(std::is_same_v<typename U::error_type, E>,
+                      "F must return an expected with the same error_type");
+
+        if (self.has_val())
+            return std::invoke(std::forward<F>(f));
+        return U(unexpect, std::forward<Self>(self).error());
     }
 
-private:
-    union {
-	struct {} invalid_;
-        T val_;
-        E unex_;
-    };
-    bool has_val_;
+    template <class Self, class F>
+    static constexpr auto or_else_impl(Self&& self, F&& f) {
+        using G = std::remove_cvref_t<std::invoke_result_t<
+            F, decltype(std::forward<Self>(self).error())>>;
+        static_assert(detail::is_expected<G>::value,
+                      "F must return a specialization of expected");
+        static_assert(std::is_void_v<typename G::value_type>,
+                      "F must return an expected with the same value_type");
+
+        if (self.has_val())
+            return G();
+        return std::invoke(std::forward<F>(f),
+                           std::forward<Self>(self).error());
+    }
 
-    template <class T2, class U, class... Args>
-    constexpr void reinit_expected(T2& newval, U& oldval, Args&&... args) {
-        if constexpr (std::is_nothrow_constructible_v<T2, Args...>) {
-            std::destroy_at(std::addressof(oldval));
-            std::construct_at(std::addressof(newval),
-                              std::forward<Args>(args)...);
-        } else if constexpr (std::is_nothrow_move_constructible_v<T2>) {
-            T2 tmp(std::forward<Args>(args)...);
-            std::destroy_at(std::addressof(oldval));
-            std::construct_at(std::addressof(newval), std::move(tmp));
+    template <class Self, class F>
+    static constexpr auto transform_impl(Self&& self, F&& f) {
+        using U = std::remove_cv_t<std::invoke_result_t<F>>;
+
+        if (!self.has_val())
+            return expected<U, E>(unexpect, std::forward<Self>(self).error());
+        if constexpr (std::is_void_v<U>) {
+            std::invoke(std::forward<F>(f));
+            return expected<U, E>();
         } else {
-            U tmp(std::move(oldval));
-            std::destroy_at(std::addressof(oldval));
-            try {
-                std::construct_at(std::addressof(newval),
-                                  std::forward<Args>(args)...);
-            } catch (...) {
-                std::construct_at(std::addressof(oldval), std::move(tmp));
-                throw;
-            }
+            return expected<U, E>(detail::in_place_invoke, std::forward<F>(f));
         }
     }
+
+    template <class Self, class F>
+    static constexpr auto transform_error_impl(Self&& self, F&& f) {
+        using G = std::remove_cv_t<std::invoke_result_t<
+            F, decltype(std::forward<Self>(self).error())>>;
+
+        if (self.has_val())
+            return expected<void, G>();
+        return expected<void, G>(detail::unexpect_invoke, std::forward<F>(f),
+                              std::forward<Self>(self).error());
+    }
 };
 
 
 
 //
-// class expected<void, E>
+// class expected<T&, E>
+//
+// An expected that refers to its value instead of holding it, for results
+// that point into storage owned elsewhere, such as a lookup into a cache.
+// The value is kept as a T* in an expected<T*, E>, so returning one costs a
+// pointer rather than a copy of T, and a niche of T* opted into with
+// pointer_niche_traits holds the discriminant whenever E fits beside it.
+//
+// Like std::reference_wrapper, assignment rebinds rather than assigning
+// through, and the constness of the expected does not reach the value.
+// Binding to an rvalue is ill-formed, as the reference would dangle.
 //
 
 template <class T, class E>
-    requires std::is_void_v<T>
-class expected<T, E> {
+class expected<T&, E> {
+    template <class U>
+    static constexpr bool binds_to = std::is_convertible_v<U*, T*>;
+
 public:
-    using value_type = T;
+    using value_type = T&;
     using error_type = E;
     using unexpected_type = unexpected<E>;
 
     template <class U>
     using rebind = expected<U, error_type>;
 
-    constexpr expected() noexcept : has_val_(true) {}
-
-    constexpr expected(const expected& rhs) : has_val_(rhs.has_val_) {
-        if (!has_val_)
-            std::construct_at(std::addressof(unex_), rhs.error());
-    }
-
-    constexpr expected(const expected&)
-        requires(!std::is_copy_constructible_v<E>)
-    = delete;
-
-    constexpr expected(const expected&)
-        requires(std::is_trivially_copy_constructible_v<E>)
-    = default;
+    //
+    // Constructors
+    //
 
-    constexpr expected(expected&& rhs) noexcept(
-        std::is_nothrow_move_constructible_v<E>)
-        requires(std::is_move_constructible_v<E>)
-    : has_val_(rhs.has_val_) {
-        if (!has_val_)
-            std::construct_at(std::addressof(unex_), std::move(rhs.error()));
-    }
+    template <class U>
+        requires(std::is_lvalue_reference_v<U> &&
+                 binds_to<std::remove_reference_t<U>>)
+    constexpr expected(U&& u) noexcept : impl_(std::addressof(u)) {}
 
-    constexpr expected(expected&& rhs)
-        requires(std::is_trivially_move_constructible_v<E>)
-    = default;
+    template <class U>
+        requires(!std::is_lvalue_reference_v<U> &&
+                 binds_to<std::remove_reference_t<U>>)
+    expected(U&&) = delete;
 
-    template <class U, class G, class GF = const G&>
-        requires(std::conjunction_v<
-                 std::is_void<U>, std::is_constructible<E, GF>,
-                 std::negation<
-                     std::is_constructible<unexpected<E>, expected<U, G>&>>,
-                 std::negation<
-                     std::is_constructible<unexpected<E>, expected<U, G>>>,
-                 std::negation<std::is_constructible<unexpected<E>,
-                                                     const expected<U, G>&>>,
-                 std::negation<std::is_constructible<unexpected<E>,
-                                                     const expected<U, G>>>>)
-    constexpr explicit(!std::is_convertible_v<GF, E>)
-        expected(const expected<U, G>& rhs)
-        : has_val_(rhs.has_val_) {
-        if (!has_val_)
-            std::construct_at(std::addressof(unex_),
-                              std::forward<GF>(rhs.error()));
-    }
+    template <class U, class G>
+        requires(binds_to<U> && std::is_constructible_v<E, const G&>)
+    constexpr explicit(!std::is_convertible_v<const G&, E>)
+        expected(const expected<U&, G>& rhs)
+        : impl_(rhs.impl_) {}
 
-    template <class U, class G, class GF = G>
-        requires(std::conjunction_v<
-                 std::is_void<U>, std::is_constructible<E, GF>,
-                 std::negation<
-                     std::is_constructible<unexpected<E>, expected<U, G>&>>,
-                 std::negation<
-                     std::is_constructible<unexpected<E>, expected<U, G>>>,
-                 std::negation<std::is_constructible<unexpected<E>,
-                                                     const expected<U, G>&>>,
-                 std::negation<std::is_constructible<unexpected<E>,
-                                                     const expected<U, G>>>>)
-    constexpr explicit(!std::is_convertible_v<GF, E>)
-        expected(expected<U, G>&& rhs)
-        : has_val_(rhs.has_val_) {
-        if (!has_val_)
-            std::construct_at(std::addressof(unex_),
-                              std::forward<GF>(rhs.error()));
-    }
+    template <class U, class G>
+        requires(binds_to<U> && std::is_constructible_v<E, G>)
+    constexpr explicit(!std::is_convertible_v<G, E>)
+        expected(expected<U&, G>&& rhs)
+        : impl_(std::move(rhs.impl_)) {}
 
-    template <class G, class GF = const G&>
-        requires(std::is_constructible_v<E, GF>)
-    constexpr explicit(std::is_convertible_v<GF, E>)
+    template <class G>
+        requires std::is_constructible_v<E, const G&>
+    constexpr explicit(!std::is_convertible_v<const G&, E>)
         expected(const unexpected<G>& e)
-        : has_val_(false) {
-        std::construct_at(std::addressof(unex_), std::forward<GF>(e.error()));
-    }
+        : impl_(e) {}
 
-    template <class G, class GF = G>
-        requires(std::is_constructible_v<E, GF>)
-    constexpr explicit(std::is_convertible_v<GF, E>) expected(unexpected<G>&& e)
-        : has_val_(false) {
-        std::construct_at(std::addressof(unex_), std::forward<GF>(e.error()));
-    }
+    template <class G>
+        requires std::is_constructible_v<E, G>
+    constexpr explicit(!std::is_convertible_v<G, E>)
+        expected(unexpected<G>&& e)
+        : impl_(std::move(e)) {}
 
-    constexpr explicit expected(std::in_place_t) noexcept : has_val_(true) {}
+    template <class U>
+        requires binds_to<U>
+    constexpr explicit expected(std::in_place_t, U& u) noexcept
+        : impl_(std::addressof(u)) {}
 
     template <class... Args>
-        requires(std::is_constructible_v<E, Args...>)
+        requires std::is_constructible_v<E, Args...>
     constexpr explicit expected(unexpect_t, Args&&... args)
-        : has_val_(false), unex_(std::forward<Args>(args)...) {}
+        : impl_(unexpect, std::forward<Args>(args)...) {}
 
     template <class U, class... Args>
-        requires(std::is_constructible_v<E, std::initializer_list<U>&, Args...>)
+        requires std::is_constructible_v<E, std::initializer_list<U>&, Args...>
     constexpr explicit expected(unexpect_t, std::initializer_list<U> il,
                                 Args&&... args)
-        : has_val_(false), unex_(il, std::forward<Args>(args)...) {}
+        : impl_(unexpect, il, std::forward<Args>(args)...) {}
 
-    constexpr ~expected() {
-        if (!has_val_)
-            std::destroy_at(std::addressof(unex_));
+    //
+    // Assignment
+    //
+
+    template <class U>
+        requires(std::is_lvalue_reference_v<U> &&
+                 binds_to<std::remove_reference_t<U>>)
+    constexpr expected& operator=(U&& u) noexcept {
+        impl_ = std::addressof(u);
+        return *this;
     }
 
-    constexpr ~expected()
-        requires(std::is_trivially_destructible_v<E>)
-    = default;
+    template <class U>
+        requires(!std::is_lvalue_reference_v<U> &&
+                 binds_to<std::remove_reference_t<U>>)
+    expected& operator=(U&&) = delete;
 
-    constexpr expected& operator=(const expected& rhs) {
-        if (has_val_ && rhs.has_val_) {
-            // No effect
-        } else if (has_val_) {
-            std::construct_at(std::addressof(unex_), rhs.unex_);
-            has_val_ = false;
-        } else if (rhs.has_val_) {
-            std::destroy_at(std::addressof(unex_));
-            has_val_ = false;
-        } else {
-            unex_ = rhs.unex_;
-        }
+    template <class G>
+    constexpr expected& operator=(const unexpected<G>& e) {
+        impl_ = e;
+        return *this;
+    }
 
+    template <class G>
+    constexpr expected& operator=(unexpected<G>&& e) {
+        impl_ = std::move(e);
         return *this;
     }
 
-    constexpr expected& operator=(const expected&)
-        requires(!std::conjunction_v<std::is_copy_assignable<E>,
-                                     std::is_copy_constructible<E>>)
-    = delete;
+    template <class U>
+        requires binds_to<U>
+    constexpr T& emplace(U& u) noexcept {
+        impl_ = std::addressof(u);
+        return u;
+    }
 
-    constexpr expected& operator=(expected&& rhs) noexcept(
-        std::conjunction_v<std::is_nothrow_move_constructible<E>,
-                           std::is_nothrow_move_assignable<E>>) {
-        if (has_val_ && rhs.has_val_) {
-            // No effect
-        } else if (has_val_) {
-            std::construct_at(std::addressof(unex_), std::move(rhs.unex_));
-            has_val_ = false;
-        } else if (rhs.has_val_) {
-            std::destroy_at(std::addressof(unex_));
-            has_val_ = false;
-        } else {
-            unex_ = std::move(rhs.unex_);
-        }
+    //
+    // Swap
+    //
 
-        return *this;
+    constexpr void swap(expected& rhs) noexcept(noexcept(impl_.swap(rhs.impl_))) {
+        impl_.swap(rhs.impl_);
     }
 
-    constexpr expected& operator=(expected&&)
-        requires(!std::conjunction_v<std::is_move_assignable<E>,
-                                     std::is_move_constructible<E>>)
-    = delete;
+    friend constexpr void swap(expected& x,
+                               expected& y) noexcept(noexcept(x.swap(y))) {
+        x.swap(y);
+    }
 
-    template <class G, class GF = const G&>
-        requires(std::conjunction_v<std::is_constructible<E, GF>,
-                                    std::is_assignable<E&, GF>>)
-    constexpr expected& operator=(const unexpected<G>& e) {
-        if (has_val_) {
-            std::construct_at(std::addressof(unex_),
-                              std::forward<GF>(e.error()));
-            has_val_ = false;
-        } else {
-            unex_ = std::forward<GF>(e.error());
-        }
-        return *this;
+    //
+    // Observers
+    //
+
+    constexpr T* operator->() const noexcept { return *impl_; }
+    constexpr T& operator*() const noexcept { return **impl_; }
+
+    constexpr explicit operator bool() const noexcept {
+        return impl_.has_value();
     }
+    constexpr bool has_value() const noexcept { return impl_.has_value(); }
 
-    template <class G, class GF = G>
-        requires(std::conjunction_v<std::is_constructible<E, GF>,
-                                    std::is_assignable<E&, GF>>)
-    constexpr expected& operator=(unexpected<G>&& e) {
-        if (has_val_) {
-            std::construct_at(std::addressof(unex_),
-                              std::forward<GF>(e.error()));
-            has_val_ = false;
-        } else {
-            unex_ = std::forward<GF>(e.error());
+    constexpr T& value() const& {
+        if (!has_value()) [[unlikely]] {
+            BST_EXPECTED_COUNT(bad_access_throws);
+            detail::throw_bad_expected_access(error());
         }
-        return *this;
+        return **impl_;
     }
-
-    constexpr void emplace() noexcept {
-        if (!has_val_) {
-            std::destroy_at(std::addressof(unex_));
-            has_val_ = true;
+    constexpr T& value() && {
+        if (!has_value()) [[unlikely]] {
+            BST_EXPECTED_COUNT(bad_access_throws);
+            detail::throw_bad_expected_access(std::move(error()));
         }
+        return **impl_;
     }
 
-    constexpr void swap(expected& rhs) noexcept(
-        std::conjunction_v<std::is_nothrow_move_constructible<E>,
-                           std::is_nothrow_swappable<E>>)
-        requires(std::conjunction_v<std::is_swappable<E>,
-                                    std::is_move_constructible<E>>)
-    {
-        if (has_val_ && rhs.has_val_) {
-            // No effect.
-        } else if (has_val_ && !rhs.has_val_) {
-            std::construct_at(std::addressof(unex_), std::move(rhs.unex_));
-            std::destroy_at(std::addressof(rhs.unex_));
-            has_val_ = false;
-            rhs.has_val_ = true;
-        } else if (!has_val_ && rhs.has_val_) {
-            rhs.swap(*this);
-        } else {
-            using std::swap;
-            swap(unex_, rhs.unex_);
+    constexpr const E& error() const& noexcept { return impl_.error(); }
+    constexpr E& error() & noexcept { return impl_.error(); }
+    constexpr const E&& error() const&& noexcept {
+        return std::move(impl_).error();
+    }
+    constexpr E&& error() && noexcept { return std::move(impl_).error(); }
+
+    template <class U>
+    constexpr std::remove_cv_t<T> value_or(U&& v) const {
+        if (has_value()) {
+            BST_EXPECTED_COUNT(value_or_copies);
+            return **impl_;
         }
+        return static_cast<std::remove_cv_t<T>>(std::forward<U>(v));
     }
 
-    friend constexpr void swap(expected& x,
-                               expected& y) noexcept(noexcept(x.swap(y))) {
-        x.swap(y);
+    // Monadic operations. The value is passed to f as a T&; transform keeps
+    // a reference when f returns an lvalue reference, so projections into
+    // the referred object do not copy either.
+
+    template <class F>
+    constexpr auto and_then(F&& f) & {
+        return and_then_impl(*this, std::forward<F>(f));
+    }
+    template <class F>
+    constexpr auto and_then(F&& f) && {
+        return and_then_impl(std::move(*this), std::forward<F>(f));
+    }
+    template <class F>
+    constexpr auto and_then(F&& f) const& {
+        return and_then_impl(*this, std::forward<F>(f));
+    }
+    template <class F>
+    constexpr auto and_then(F&& f) const&& {
+        return and_then_impl(std::move(*this), std::forward<F>(f));
     }
 
-    constexpr explicit operator bool() const noexcept { return has_val_; }
-    constexpr bool has_value() const noexcept { return has_val_; }
-    constexpr void operator*() const noexcept { return; }
-    constexpr void value() const& {
-        if (!has_val_)
-            throw bad_expected_access(error());
+    template <class F>
+    constexpr auto or_else(F&& f) & {
+        return or_else_impl(*this, std::forward<F>(f));
     }
-    constexpr void value() const&& {
-        if (!has_val_)
-            throw bad_expected_access(error());
+    template <class F>
+    constexpr auto or_else(F&& f) && {
+        return or_else_impl(std::move(*this), std::forward<F>(f));
+    }
+    template <class F>
+    constexpr auto or_else(F&& f) const& {
+        return or_else_impl(*this, std::forward<F>(f));
+    }
+    template <class F>
+    constexpr auto or_else(F&& f) const&& {
+        return or_else_impl(std::move(*this), std::forward<F>(f));
     }
 
-    constexpr const E& error() const& { return unex_; }
-    constexpr E& error() & { return unex_; }
-    constexpr const E&& error() const&& { return std::move(unex_); }
-    constexpr E&& error() && { return std::move(unex_); }
+    template <class F>
+    constexpr auto transform(F&& f) & {
+        return transform_impl(*this, std::forward<F>(f));
+    }
+    template <class F>
+    constexpr auto transform(F&& f) && {
+        return transform_impl(std::move(*this), std::forward<F>(f));
+    }
+    template <class F>
+    constexpr auto transform(F&& f) const& {
+        return transform_impl(*this, std::forward<F>(f));
+    }
+    template <class F>
+    constexpr auto transform(F&& f) const&& {
+        return transform_impl(std::move(*this), std::forward<F>(f));
+    }
+
+    template <class F>
+    constexpr auto transform_error(F&& f) & {
+        return transform_error_impl(*this, std::forward<F>(f));
+    }
+    template <class F>
+    constexpr auto transform_error(F&& f) && {
+        return transform_error_impl(std::move(*this), std::forward<F>(f));
+    }
+    template <class F>
+    constexpr auto transform_error(F&& f) const& {
+        return transform_error_impl(*this, std::forward<F>(f));
+    }
+    template <class F>
+    constexpr auto transform_error(F&& f) const&& {
+        return transform_error_impl(std::move(*this), std::forward<F>(f));
+    }
+
+    // Equality Comparrison
 
     template <class T2, class E2>
-        requires std::is_void_v<T2>
+        requires(!std::is_void_v<T2>)
     friend constexpr bool operator==(const expected& x,
                                      const expected<T2, E2>& y) {
-        // TODO mandates
-
-        if (x.has_val_ != y.has_val_)
+        if (x.has_value() != y.has_value())
             return false;
-        return x.has_val_ || static_cast<bool>(x.error() == y.error());
+        if (x.has_value())
+            return *x == *y;
+        else
+            return x.error() == y.error();
+    }
+
+    template <class T2>
+    friend constexpr bool operator==(const expected& x, const T2& v) {
+        return x.has_value() && static_cast<bool>(*x == v);
     }
 
     template <class E2>
     friend constexpr bool operator==(const expected& x,
                                      const unexpected<E2>& e) {
-        // TODO mandates
-
-        return !x.has_val_ && static_cast<bool>(x.error() == e.error());
+        return !x.has_value() && static_cast<bool>(x.error() == e.error());
     }
 
 private:
-    union {
-        E unex_;
-    };
-    bool has_val_;
+    expected<T*, E> impl_;
+
+    template <class, class>
+    friend class expected;
+    friend class detail::expected_return<T&, E>;
+
+    // The placeholder value is overwritten by the promise without being
+    // destroyed, which is fine for a pointer.
+    template <class Promise>
+    expected(detail::deferred_init_t, Promise& p) noexcept : impl_(nullptr) {
+        p.bind(this, nullptr);
+    }
+
+    template <class F, class... Args>
+    constexpr explicit expected(detail::unexpect_invoke_t, F&& f,
+                                Args&&... args)
+        : impl_(detail::unexpect_invoke, std::forward<F>(f),
+                std::forward<Args>(args)...) {}
+
+    template <class Self, class F>
+    static constexpr auto and_then_impl(Self&& self, F&& f) {
+        using U = std::remove_cvref_t<std::invoke_result_t<F, T&>>;
+        static_assert(detail::is_expected<U>::value,
+                      "F must return a specialization of expected");
+        static_assert(std::is_same_v<typename U::error_type, E>,
+                      "F must return an expected with the same error_type");
+
+        if (self.has_value())
+            return std::invoke(std::forward<F>(f), *self);
+        return U(unexpect, std::forward<Self>(self).error());
+    }
+
+    template <class Self, class F>
+    static constexpr auto or_else_impl(Self&& self, F&& f) {
+        using G = std::remove_cvref_t<std::invoke_result_t<
+            F, decltype(std::forward<Self>(self).error())>>;
+        static_assert(detail::is_expected<G>::value,
+                      "F must return a specialization of expected");
+        static_assert(std::is_same_v<typename G::value_type, T&>,
+                      "F must return an expected with the same value_type");
+
+        if (self.has_value())
+            return G(*self);
+        return std::invoke(std::forward<F>(f),
+                           std::forward<Self>(self).error());
+    }
+
+    template <class Self, class F>
+    static constexpr auto transform_impl(Self&& self, F&& f) {
+        using R = std::invoke_result_t<F, T&>;
+        using U = std::conditional_t<std::is_lvalue_reference_v<R>, R,
+                                     std::remove_cv_t<R>>;
+
+        if (!self.has_value())
+            return expected<U, E>(unexpect, std::forward<Self>(self).error());
+        if constexpr (std::is_void_v<U>) {
+            std::invoke(std::forward<F>(f), *self);
+            return expected<U, E>();
+        } else if constexpr (std::is_lvalue_reference_v<U>) {
+            return expected<U, E>(std::invoke(std::forward<F>(f), *self));
+        } else {
+            return expected<U, E>(detail::in_place_invoke, std::forward<F>(f),
+                                  *self);
+        }
+    }
+
+    template <class Self, class F>
+    static constexpr auto transform_error_impl(Self&& self, F&& f) {
+        using G = std::remove_cv_t<std::invoke_result_t<
+            F, decltype(std::forward<Self>(self).error())>>;
+
+        if (self.has_value())
+            return expected<T&, G>(*self);
+        return expected<T&, G>(detail::unexpect_invoke, std::forward<F>(f),
+                               std::forward<Self>(self).error());
+    }
 };
 
 } // namespace bst
 
 
 
+//
+// std::uses_allocator
+//
+// An expected of a value, or of void, uses an allocator that either of its
+// alternatives uses. An expected of a reference does not.
+//
+
+template <class T, class E, class Alloc>
+    requires(!std::is_reference_v<T>)
+struct std::uses_allocator<bst::expected<T, E>, Alloc>
+    : std::bool_constant<std::uses_allocator_v<T, Alloc> ||
+                         std::uses_allocator_v<E, Alloc>> {};
+
+
+
 #endif
@@ -0,0 +1,742 @@
+#ifndef BST_EXPECTED_EXPECTED_ARRAY_HPP_
+#define BST_EXPECTED_EXPECTED_ARRAY_HPP_
+
+//
+// A structure-of-arrays container of expected values.
+//
+
+/*
+Overview
+========
+
+namespace bst {
+
+template <class T, class E>
+class expected_array {
+public:
+    using value_type = expected<T, E>;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = unspecified;          // proxy for expected<T&, E&>
+    using const_reference = unspecified;    // proxy for expected<const T&, const E&>
+    using iterator = unspecified;
+    using const_iterator = unspecified;
+
+    expected_array() noexcept;
+    template <class InputIt>
+        expected_array(InputIt first, InputIt last);
+    expected_array(const expected_array&);
+    expected_array(expected_array&&) noexcept;
+    expected_array& operator=(expected_array);
+    ~expected_array();
+
+    reference operator[](size_type) noexcept;
+    const_reference operator[](size_type) const noexcept;
+    bool has_value(size_type) const noexcept;
+
+    iterator begin() noexcept;
+    iterator end() noexcept;
+    const_iterator begin() const noexcept;
+    const_iterator end() const noexcept;
+
+    bool empty() const noexcept;
+    size_type size() const noexcept;
+    size_type capacity() const noexcept;
+    void reserve(size_type);
+
+    void push_back(const expected<T, E>&);
+    void push_back(expected<T, E>&&);
+    template <class... Args>
+        void emplace_value(Args&&...);
+    template <class... Args>
+        void emplace_error(Args&&...);
+    template <class... Args>
+        void set_value(size_type, Args&&...);
+    template <class... Args>
+        void set_error(size_type, Args&&...);
+    void pop_back() noexcept;
+    void clear() noexcept;
+
+    size_type count_values() const noexcept;
+    size_type count_errors() const noexcept;
+    size_type first_error() const noexcept;
+    size_type partition() noexcept;
+    std::vector<T> values_or(const T&) const;
+
+    void swap(expected_array&) noexcept;
+    friend void swap(expected_array&, expected_array&) noexcept;
+};
+
+} // namespace bst
+
+*/
+
+
+#include <expected/expected.hpp>
+#include <expected/relocate.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+namespace bst {
+
+//
+// Bitmap kernels
+//
+// The validity bitmap is an array of 64-bit words, bit i of word i / 64
+// being set when slot i holds a value. Bits past the last slot are kept
+// clear, so whole words can be counted without masking.
+//
+
+namespace detail {
+inline constexpr std::size_t bitmap_word_bits = 64;
+
+inline std::size_t bitmap_words(std::size_t bits) noexcept {
+    return (bits + bitmap_word_bits - 1) / bitmap_word_bits;
+}
+
+inline std::size_t bitmap_count(const std::uint64_t* words,
+                                std::size_t bits) noexcept {
+    std::size_t n = 0;
+    for (std::size_t k = 0, last = bitmap_words(bits); k != last; ++k)
+        n += static_cast<std::size_t>(std::popcount(words[k]));
+    return n;
+}
+
+// The index of the first bit in [first, last) equal to Bit, or last.
+template <bool Bit>
+std::size_t bitmap_find(const std::uint64_t* words, std::size_t first,
+                        std::size_t last) noexcept {
+    while (first < last) {
+        const std::size_t k = first / bitmap_word_bits;
+        std::uint64_t w = Bit ? words[k] : ~words[k];
+        w &= ~std::uint64_t(0) << (first % bitmap_word_bits);
+        if (w != 0)
+            return std::min(k * bitmap_word_bits +
+                                static_cast<std::size_t>(std::countr_zero(w)),
+                            last);
+        first = (k + 1) * bitmap_word_bits;
+    }
+    return last;
+}
+} // namespace detail
+
+
+
+//
+// class expected_array<T, E>
+//
+// Holds a sequence of expected<T, E> as three parallel arrays: the values,
+// the errors, and a bitmap of which slots hold values. Queries over the
+// states, such as count_values() and first_error(), then run a word at a time
+// over the bitmap instead of testing a flag interleaved with every payload.
+//
+// Element access yields proxies that behave like an expected of references
+// into the arrays. A slot only holds an object of the alternative it
+// currently has; the exception is a trivial T, which is value-initialized in
+// error slots too so that values_or() can select without branching.
+//
+// Growing the array relocates the live objects, so both alternatives must be
+// nothrow move constructible.
+//
+
+template <class T, class E>
+    requires(std::is_nothrow_move_constructible_v<T> &&
+             std::is_nothrow_move_constructible_v<E>)
+class expected_array {
+    template <bool Const>
+    class basic_reference;
+    template <bool Const>
+    class basic_iterator;
+
+public:
+    using value_type = expected<T, E>;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = basic_reference<false>;
+    using const_reference = basic_reference<true>;
+    using iterator = basic_iterator<false>;
+    using const_iterator = basic_iterator<true>;
+
+    expected_array() noexcept = default;
+
+    template <class InputIt>
+    expected_array(InputIt first, InputIt last) : expected_array() {
+        if constexpr (std::forward_iterator<InputIt>)
+            reserve(static_cast<size_type>(std::distance(first, last)));
+        for (; first != last; ++first)
+            push_back(*first);
+    }
+
+    // Delegating to the default constructor means a throwing copy is cleaned
+    // up by the destructor.
+    expected_array(const expected_array& rhs) : expected_array() {
+        reserve(rhs.size_);
+        for (size_type i = 0; i != rhs.size_; ++i) {
+            if (rhs.has_value(i))
+                emplace_value(rhs.values_[i]);
+            else
+                emplace_error(rhs.errors_[i]);
+        }
+    }
+
+    expected_array(expected_array&& rhs) noexcept
+        : values_(std::exchange(rhs.values_, nullptr)),
+          errors_(std::exchange(rhs.errors_, nullptr)),
+          bits_(std::exchange(rhs.bits_, nullptr)),
+          size_(std::exchange(rhs.size_, 0)),
+          capacity_(std::exchange(rhs.capacity_, 0)) {}
+
+    expected_array& operator=(expected_array rhs) noexcept {
+        swap(rhs);
+        return *this;
+    }
+
+    ~expected_array() {
+        clear();
+        deallocate(values_, errors_, bits_, capacity_);
+    }
+
+    // Element access
+
+    reference operator[](size_type i) noexcept { return reference(this, i); }
+    const_reference operator[](size_type i) const noexcept {
+        return const_reference(this, i);
+    }
+
+    bool has_value(size_type i) const noexcept {
+        return (bits_[i / detail::bitmap_word_bits] >>
+                (i % detail::bitmap_word_bits)) &
+               1;
+    }
+
+    // Iterators
+
+    iterator begin() noexcept { return iterator(this, 0); }
+    iterator end() noexcept { return iterator(this, size_); }
+    const_iterator begin() const noexcept { return const_iterator(this, 0); }
+    const_iterator end() const noexcept {
+        return const_iterator(this, size_);
+    }
+
+    // Capacity
+
+    bool empty() const noexcept { return size_ == 0; }
+    size_type size() const noexcept { return size_; }
+    size_type capacity() const noexcept { return capacity_; }
+
+    void reserve(size_type n) {
+        if (n <= capacity_)
+            return;
+        n = detail::bitmap_words(n) * detail::bitmap_word_bits;
+        T* values = nullptr;
+        E* errors = nullptr;
+        std::uint64_t* bits = nullptr;
+        allocate(n, values, errors, bits);
+        replace_buffers(values, errors, bits, n);
+    }
+
+    // Modifiers
+
+    void push_back(const expected<T, E>& e) {
+        if (e.has_value())
+            emplace_value(*e);
+        else
+            emplace_error(e.error());
+    }
+
+    void push_back(expected<T, E>&& e) {
+        if (e.has_value())
+            emplace_value(std::move(*e));
+        else
+            emplace_error(std::move(e).error());
+    }
+
+    template <class... Args>
+    void emplace_value(Args&&... args) {
+        emplace_slot<true>(std::forward<Args>(args)...);
+    }
+
+    template <class... Args>
+    void emplace_error(Args&&... args) {
+        emplace_slot<false>(std::forward<Args>(args)...);
+    }
+
+    // Replace slot i, whatever it holds, with a value or an error. The new
+    // object is built before the old one is destroyed, so a throwing
+    // constructor leaves the slot as it was.
+
+    template <class... Args>
+    void set_value(size_type i, Args&&... args) {
+        if (has_value(i)) {
+            values_[i] = T(std::forward<Args>(args)...);
+            return;
+        }
+        T tmp(std::forward<Args>(args)...);
+        std::destroy_at(errors_ + i);
+        if constexpr (dense_values)
+            values_[i] = std::move(tmp);
+        else
+            std::construct_at(values_ + i, std::move(tmp));
+        set_bit(i);
+    }
+
+    template <class... Args>
+    void set_error(size_type i, Args&&... args) {
+        if (!has_value(i)) {
+            errors_[i] = E(std::forward<Args>(args)...);
+            return;
+        }
+        E tmp(std::forward<Args>(args)...);
+        if constexpr (!dense_values)
+            std::destroy_at(values_ + i);
+        std::construct_at(errors_ + i, std::move(tmp));
+        clear_bit(i);
+    }
+
+    void pop_back() noexcept {
+        --size_;
+        destroy_slot(size_);
+        clear_bit(size_);
+    }
+
+    void clear() noexcept {
+        for (size_type i = 0; i != size_; ++i)
+            destroy_slot(i);
+        if (bits_)
+            std::fill_n(bits_, detail::bitmap_words(size_), std::uint64_t(0));
+        size_ = 0;
+    }
+
+    void swap(expected_array& rhs) noexcept {
+        std::swap(values_, rhs.values_);
+        std::swap(errors_, rhs.errors_);
+        std::swap(bits_, rhs.bits_);
+        std::swap(size_, rhs.size_);
+        std::swap(capacity_, rhs.capacity_);
+    }
+
+    friend void swap(expected_array& x, expected_array& y) noexcept {
+        x.swap(y);
+    }
+
+    // Bulk queries
+
+    size_type count_values() const noexcept {
+        return detail::bitmap_count(bits_, size_);
+    }
+
+    size_type count_errors() const noexcept { return size_ - count_values(); }
+
+    // The index of the first error, or size() if every slot holds a value.
+    size_type first_error() const noexcept {
+        return detail::bitmap_find<false>(bits_, 0, size_);
+    }
+
+    // Reorder the slots so that all the values come before all the errors,
+    // and return the number of values. Like std::partition, the relative
+    // order within each group is not kept.
+    size_type partition() noexcept {
+        const size_type n = count_values();
+        size_type i = 0, j = n;
+        while ((i = detail::bitmap_find<false>(bits_, i, n)) != n) {
+            j = detail::bitmap_find<true>(bits_, j, size_);
+            exchange_slots(i++, j++);
+        }
+        return n;
+    }
+
+    // Every value, with d in place of each error. Words that are all values
+    // or all errors are copied or filled in bulk; for a trivial T the others
+    // select per slot without branching.
+    std::vector<T> values_or(const T& d) const {
+        std::vector<T> out;
+        if constexpr (dense_values) {
+            out.resize(size_);
+            T* dst = out.data();
+            for (size_type base = 0; base < size_;
+                 base += detail::bitmap_word_bits) {
+                const std::uint64_t w = bits_[base / detail::bitmap_word_bits];
+                const size_type n =
+                    std::min(size_ - base, detail::bitmap_word_bits);
+                const std::uint64_t full =
+                    n == detail::bitmap_word_bits
+                        ? ~std::uint64_t(0)
+                        : (std::uint64_t(1) << n) - 1;
+                if (w == full) {
+                    std::copy_n(values_ + base, n, dst + base);
+                } else if (w == 0) {
+                    std::fill_n(dst + base, n, d);
+                } else {
+                    for (size_type k = 0; k != n; ++k)
+                        dst[base + k] = ((w >> k) & 1) ? values_[base + k] : d;
+                }
+            }
+        } else {
+            out.reserve(size_);
+            for (size_type i = 0; i != size_; ++i)
+                out.push_back(has_value(i) ? values_[i] : d);
+        }
+        return out;
+    }
+
+private:
+    using value_alloc = std::allocator<T>;
+    using error_alloc = std::allocator<E>;
+    using bits_alloc = std::allocator<std::uint64_t>;
+
+    // A trivial T is kept alive in every slot, so whole ranges of values can
+    // be read regardless of the bitmap.
+    static constexpr bool dense_values =
+        std::is_trivially_copyable_v<T> &&
+        std::is_trivially_default_constructible_v<T>;
+
+    T* values_ = nullptr;
+    E* errors_ = nullptr;
+    std::uint64_t* bits_ = nullptr;
+    size_type size_ = 0;
+    size_type capacity_ = 0;
+
+    void set_bit(size_type i) noexcept {
+        bits_[i / detail::bitmap_word_bits] |= std::uint64_t(1)
+                                               << (i % detail::bitmap_word_bits);
+    }
+
+    void clear_bit(size_type i) noexcept {
+        bits_[i / detail::bitmap_word_bits] &=
+            ~(std::uint64_t(1) << (i % detail::bitmap_word_bits));
+    }
+
+    static void allocate(size_type n, T*& values, E*& errors,
+                         std::uint64_t*& bits) {
+        values = value_alloc().allocate(n);
+        BST_EXPECTED_TRY {
+            errors = error_alloc().allocate(n);
+            BST_EXPECTED_TRY {
+                bits = bits_alloc().allocate(detail::bitmap_words(n));
+            } BST_EXPECTED_CATCH_ALL {
+                error_alloc().deallocate(errors, n);
+                BST_EXPECTED_RETHROW;
+            }
+        } BST_EXPECTED_CATCH_ALL {
+            value_alloc().deallocate(values, n);
+            BST_EXPECTED_RETHROW;
+        }
+        std::fill_n(bits, detail::bitmap_words(n), std::uint64_t(0));
+    }
+
+    static void deallocate(T* values, E* errors, std::uint64_t* bits,
+                           size_type n) noexcept {
+        if (!values)
+            return;
+        value_alloc().deallocate(values, n);
+        error_alloc().deallocate(errors, n);
+        bits_alloc().deallocate(bits, detail::bitmap_words(n));
+    }
+
+    // Move the live objects into the new buffers and release the old ones.
+    void replace_buffers(T* values, E* errors, std::uint64_t* bits,
+                         size_type n) noexcept {
+        if constexpr (dense_values || is_trivially_relocatable_v<T>) {
+            if (size_ != 0)
+                std::memcpy(static_cast<void*>(values),
+                            static_cast<const void*>(values_),
+                            size_ * sizeof(T));
+        } else {
+            for (size_type i = 0;
+                 (i = detail::bitmap_find<true>(bits_, i, size_)) != size_;
+                 ++i)
+                relocate_at(values_ + i, values + i);
+        }
+        if constexpr (is_trivially_relocatable_v<E>) {
+            if (size_ != 0)
+                std::memcpy(static_cast<void*>(errors),
+                            static_cast<const void*>(errors_),
+                            size_ * sizeof(E));
+        } else {
+            for (size_type i = 0;
+                 (i = detail::bitmap_find<false>(bits_, i, size_)) != size_;
+                 ++i)
+                relocate_at(errors_ + i, errors + i);
+        }
+        if (size_ != 0)
+            std::copy_n(bits_, detail::bitmap_words(size_), bits);
+
+        deallocate(values_, errors_, bits_, capacity_);
+        values_ = values;
+        errors_ = errors;
+        bits_ = bits;
+        capacity_ = n;
+    }
+
+    template <class U>
+    static void relocate_at(U* from, U* to) noexcept {
+        std::construct_at(to, std::move(*from));
+        std::destroy_at(from);
+    }
+
+    // Construct the new object in the destination before relocating the old
+    // ones, in case args refer into this array.
+    template <bool Value, class... Args>
+    void emplace_slot(Args&&... args) {
+        if (size_ < capacity_) {
+            construct_slot<Value>(values_, errors_, size_,
+                                  std::forward<Args>(args)...);
+        } else {
+            const size_type n =
+                capacity_ ? 2 * capacity_ : detail::bitmap_word_bits;
+            T* values = nullptr;
+            E* errors = nullptr;
+            std::uint64_t* bits = nullptr;
+            allocate(n, values, errors, bits);
+            BST_EXPECTED_TRY {
+                construct_slot<Value>(values, errors, size_,
+                                      std::forward<Args>(args)...);
+            } BST_EXPECTED_CATCH_ALL {
+                deallocate(values, errors, bits, n);
+                BST_EXPECTED_RETHROW;
+            }
+            replace_buffers(values, errors, bits, n);
+        }
+        if constexpr (Value)
+            set_bit(size_);
+        ++size_;
+    }
+
+    template <bool Value, class... Args>
+    static void construct_slot(T* values, E* errors, size_type i,
+                               Args&&... args) {
+        if constexpr (Value) {
+            std::construct_at(values + i, std::forward<Args>(args)...);
+        } else {
+            std::construct_at(errors + i, std::forward<Args>(args)...);
+            if constexpr (dense_values)
+                std::construct_at(values + i);
+        }
+    }
+
+    void destroy_slot(size_type i) noexcept {
+        if (has_value(i)) {
+            if constexpr (!dense_values)
+                std::destroy_at(values_ + i);
+        } else {
+            std::destroy_at(errors_ + i);
+        }
+    }
+
+    // Slot i holds an error and slot j a value; swap them.
+    void exchange_slots(size_type i, size_type j) noexcept {
+        if constexpr (dense_values)
+            std::swap(values_[i], values_[j]);
+        else
+            relocate_at(values_ + j, values_ + i);
+        relocate_at(errors_ + i, errors_ + j);
+        set_bit(i);
+        clear_bit(j);
+    }
+};
+
+
+
+//
+// expected_array<T, E>::basic_reference
+//
+// What operator[] and the iterators return: a slot of the array, seen as an
+// expected<T&, E&>. Assigning to a reference replaces the slot's contents
+// rather than rebinding the proxy.
+//
+
+template <class T, class E>
+    requires(std::is_nothrow_move_constructible_v<T> &&
+             std::is_nothrow_move_constructible_v<E>)
+template <bool Const>
+class expected_array<T, E>::basic_reference {
+    using array_type =
+        std::conditional_t<Const, const expected_array, expected_array>;
+    using value_ref = std::conditional_t<Const, const T&, T&>;
+    using error_ref = std::conditional_t<Const, const E&, E&>;
+
+public:
+    using value_type = T;
+    using error_type = E;
+
+    basic_reference(const basic_reference&) = default;
+
+    const basic_reference& operator=(const basic_reference& rhs) const
+        requires(!Const)
+    {
+        return *this = expected<T, E>(rhs);
+    }
+
+    const basic_reference& operator=(const expected<T, E>& e) const
+        requires(!Const)
+    {
+        if (e.has_value())
+            a_->set_value(i_, *e);
+        else
+            a_->set_error(i_, e.error());
+        return *this;
+    }
+
+    bool has_value() const noexcept { return a_->has_value(i_); }
+    explicit operator bool() const noexcept { return has_value(); }
+
+    value_ref operator*() const noexcept { return a_->values_[i_]; }
+    auto operator->() const noexcept { return std::addressof(**this); }
+
+    value_ref value() const {
+        if (!has_value()) [[unlikely]]
+            detail::throw_bad_expected_access(std::as_const(error()));
+        return **this;
+    }
+
+    error_ref error() const noexcept { return a_->errors_[i_]; }
+
+    template <class U>
+    T value_or(U&& v) const {
+        return has_value() ? **this : static_cast<T>(std::forward<U>(v));
+    }
+
+    operator expected<T, E>() const {
+        if (has_value())
+            return expected<T, E>(**this);
+        return expected<T, E>(unexpect, error());
+    }
+
+    operator basic_reference<true>() const noexcept
+        requires(!Const)
+    {
+        return basic_reference<true>(a_, i_);
+    }
+
+    friend bool operator==(const basic_reference& x,
+                           const expected<T, E>& y) {
+        if (x.has_value() != y.has_value())
+            return false;
+        return x.has_value() ? *x == *y : x.error() == y.error();
+    }
+
+private:
+    friend class expected_array;
+
+    basic_reference(array_type* a, size_type i) noexcept : a_(a), i_(i) {}
+
+    array_type* a_;
+    size_type i_;
+};
+
+
+
+//
+// expected_array<T, E>::basic_iterator
+//
+// A random-access iterator over the slots, dereferencing to a proxy.
+//
+
+template <class T, class E>
+    requires(std::is_nothrow_move_constructible_v<T> &&
+             std::is_nothrow_move_constructible_v<E>)
+template <bool Const>
+class expected_array<T, E>::basic_iterator {
+    using array_type =
+        std::conditional_t<Const, const expected_array, expected_array>;
+
+public:
+    using iterator_concept = std::random_access_iterator_tag;
+    using iterator_category = std::input_iterator_tag;
+    using value_type = expected<T, E>;
+    using difference_type = std::ptrdiff_t;
+    using reference = basic_reference<Const>;
+
+    basic_iterator() noexcept = default;
+
+    operator basic_iterator<true>() const noexcept
+        requires(!Const)
+    {
+        return basic_iterator<true>(a_, i_);
+    }
+
+    reference operator*() const noexcept { return reference(a_, i_); }
+    reference operator[](difference_type n) const noexcept {
+        return reference(a_, i_ + n);
+    }
+
+    basic_iterator& operator++() noexcept {
+        ++i_;
+        return *this;
+    }
+    basic_iterator operator++(int) noexcept {
+        auto tmp = *this;
+        ++i_;
+        return tmp;
+    }
+    basic_iterator& operator--() noexcept {
+        --i_;
+        return *this;
+    }
+    basic_iterator operator--(int) noexcept {
+        auto tmp = *this;
+        --i_;
+        return tmp;
+    }
+
+    basic_iterator& operator+=(difference_type n) noexcept {
+        i_ += n;
+        return *this;
+    }
+    basic_iterator& operator-=(difference_type n) noexcept {
+        i_ -= n;
+        return *this;
+    }
+
+    friend basic_iterator operator+(basic_iterator it,
+                                    difference_type n) noexcept {
+        return it += n;
+    }
+    friend basic_iterator operator+(difference_type n,
+                                    basic_iterator it) noexcept {
+        return it += n;
+    }
+    friend basic_iterator operator-(basic_iterator it,
+                                    difference_type n) noexcept {
+        return it -= n;
+    }
+    friend difference_type operator-(const basic_iterator& x,
+                                     const basic_iterator& y) noexcept {
+        return static_cast<difference_type>(x.i_) -
+               static_cast<difference_type>(y.i_);
+    }
+
+    friend bool operator==(const basic_iterator& x,
+                           const basic_iterator& y) noexcept {
+        return x.i_ == y.i_;
+    }
+    friend auto operator<=>(const basic_iterator& x,
+                            const basic_iterator& y) noexcept {
+        return x.i_ <=> y.i_;
+    }
+
+private:
+    friend class expected_array;
+
+    basic_iterator(array_type* a, size_type i) noexcept : a_(a), i_(i) {}
+
+    array_type* a_ = nullptr;
+    size_type i_ = 0;
+};
+
+} // namespace bst
+
+
+
+#endif
@@ -0,0 +1,542 @@
+#ifndef BST_EXPECTED_EXPECTED_LOG_HPP_
+#define BST_EXPECTED_EXPECTED_LOG_HPP_
+
+//
+// An append-only file of expected values, mapped into memory.
+//
+
+/*
+Overview
+========
+
+namespace bst {
+
+enum class log_mode { read, write };
+
+template <class T, class E>
+class expected_log {
+public:
+    using value_type = expected<T, E>;
+    using size_type = std::uint64_t;
+
+    static constexpr size_type default_block_capacity = 65536;
+
+    static expected<expected_log, std::error_code>
+        create(const std::filesystem::path&,
+               size_type block_capacity = default_block_capacity);
+    static expected<expected_log, std::error_code>
+        open(const std::filesystem::path&, log_mode = log_mode::read);
+
+    expected_log(expected_log&&) noexcept;
+    expected_log& operator=(expected_log&&) noexcept;
+    ~expected_log();
+
+    // Writing
+    expected<void, std::error_code> push_back(const expected<T, E>&);
+    expected<void, std::error_code> flush();
+    void truncate(size_type n) noexcept;
+
+    // Reading
+    size_type size() const noexcept;
+    size_type flushed_size() const noexcept;
+    size_type block_capacity() const noexcept;
+    bool has_value(size_type i) const noexcept;
+    expected<T, E> operator[](size_type i) const noexcept;
+    size_type count_errors() const noexcept;
+    template <class F>
+        void for_each_error(F&& f) const;     // f(size_type i, const E&)
+};
+
+} // namespace bst
+
+where T and E are trivially copyable. POSIX only.
+
+*/
+
+
+#include <expected/expected.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <new>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+namespace bst {
+
+//
+// File layout
+//
+// A log starts with a page holding its header:
+//
+//     offset 0    uint64    0x31474f4c58545342, "BSTXLOG1" on a
+//                           little-endian machine
+//     offset 8    uint32    1, the version of the layout
+//     offset 12   uint32    sizeof(T)
+//     offset 16   uint32    sizeof(E)
+//     offset 20   uint32    zero
+//     offset 24   uint64    N, the number of entries in a block
+//     offset 32   uint64    count, the number of entries appended
+//     offset 40   uint64    flushed, the count at the last flush()
+//
+// The entries follow in blocks of N. Block b holds entries b * N up to
+// (b + 1) * N in four regions, each starting on a 4096-byte boundary:
+//
+//     bitmap      N / 64 uint64, bit i of word i / 64 set when entry
+//                 b * N + i holds a value
+//     values      T[N], the value of entry b * N + i in slot i
+//     index       uint32[N], the slot of each error in the block, in order
+//     errors      E[N], the errors in the block, in order
+//
+// Payloads and integers are in the representation of the machine. The file
+// is extended a few blocks at a time and regions that were never written
+// are left as holes, so space for errors costs nothing on disk until errors
+// are logged.
+//
+
+namespace detail {
+inline constexpr std::uint64_t log_magic = 0x31474f4c58545342;
+inline constexpr std::uint32_t log_version = 1;
+inline constexpr std::size_t log_page = 4096;
+
+struct log_header {
+    std::uint64_t magic;
+    std::uint32_t version;
+    std::uint32_t value_size;
+    std::uint32_t error_size;
+    std::uint32_t reserved;
+    std::uint64_t block_capacity;
+    std::uint64_t count;
+    std::uint64_t flushed;
+};
+
+constexpr std::size_t log_align(std::size_t n) noexcept {
+    return (n + log_page - 1) / log_page * log_page;
+}
+
+// Offsets of the regions within a block, and its size.
+struct log_block_layout {
+    std::size_t values;
+    std::size_t index;
+    std::size_t errors;
+    std::size_t size;
+
+    constexpr log_block_layout(std::uint64_t n, std::size_t value_size,
+                               std::size_t error_size) noexcept
+        : values(log_align(n / 8)),
+          index(values + log_align(n * value_size)),
+          errors(index + log_align(n * sizeof(std::uint32_t))),
+          size(errors + log_align(n * error_size)) {}
+};
+
+inline std::error_code last_error() noexcept {
+    return std::error_code(errno, std::system_category());
+}
+
+// The number of set bits among the first n of a bitmap.
+inline std::uint64_t log_bitmap_count(const std::uint64_t* words,
+                                      std::uint64_t n) noexcept {
+    std::uint64_t set = 0;
+    for (std::uint64_t k = 0; k != n / 64; ++k)
+        set += static_cast<std::uint64_t>(std::popcount(words[k]));
+    if (n % 64 != 0)
+        set += static_cast<std::uint64_t>(std::popcount(
+            words[n / 64] & ((std::uint64_t(1) << (n % 64)) - 1)));
+    return set;
+}
+} // namespace detail
+
+enum class log_mode { read, write };
+
+
+
+//
+// class expected_log<T, E>
+//
+// A log of expected<T, E> in a file, written and read through a shared
+// mapping of it, for results that are to outlive the process that computes
+// them and be scanned for failures later. The layout keeps the errors apart
+// from the values, so that for_each_error() reads the bitmaps, the indexes
+// and the errors, but none of the pages of values.
+//
+// There is a single writer, a log opened with log_mode::write. Appending an
+// entry writes its payload and its bit, and then publishes the new count with
+// a release store. The count is the commit point: if the process dies, the
+// log reopens with the entries up to the last count, and anything written
+// past it is overwritten by the next appends. Readers in other processes see
+// entries as they are committed, up to the blocks they have mapped.
+//
+// The count survives a crash of the process, as the pages stay in the page
+// cache, but not necessarily a crash of the machine. flush() writes the
+// entries to disk before it records their number as flushed_size(); after a
+// power failure, the entries up to flushed_size() are intact, and
+// truncate(flushed_size()) discards the others.
+//
+// Failures of the system calls are returned as std::error_code; a file that
+// is not a log of expected<T, E> gives std::errc::invalid_argument.
+//
+
+template <class T, class E>
+    requires(std::is_trivially_copyable_v<T> &&
+             std::is_trivially_copyable_v<E> &&
+             alignof(T) <= detail::log_page && alignof(E) <= detail::log_page)
+class expected_log {
+public:
+    using value_type = expected<T, E>;
+    using size_type = std::uint64_t;
+
+    static constexpr size_type default_block_capacity = 65536;
+
+    // Creates the file, replacing any that exists. The block capacity must
+    // be a positive multiple of 64 no larger than 2^31.
+    static expected<expected_log, std::error_code>
+    create(const std::filesystem::path& path,
+           size_type block_capacity = default_block_capacity) {
+        if (block_capacity == 0 || block_capacity % 64 != 0 ||
+            block_capacity > (size_type(1) << 31))
+            return unexpected(
+                std::make_error_code(std::errc::invalid_argument));
+
+        expected_log log(log_mode::write, block_capacity);
+        log.fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC,
+                         0644);
+        if (log.fd_ < 0)
+            return unexpected(detail::last_error());
+        if (auto r = log.map(1); !r)
+            return unexpected(r.error());
+
+        detail::log_header& h = log.header();
+        h.magic = detail::log_magic;
+        h.version = detail::log_version;
+        h.value_size = sizeof(T);
+        h.error_size = sizeof(E);
+        h.block_capacity = block_capacity;
+        return log;
+    }
+
+    // Opens an existing log, to read it or to go on appending to it after
+    // its last committed entry.
+    static expected<expected_log, std::error_code>
+    open(const std::filesystem::path& path, log_mode mode = log_mode::read) {
+        const bool write = mode == log_mode::write;
+        const int fd = ::open(path.c_str(),
+                              (write ? O_RDWR : O_RDONLY) | O_CLOEXEC);
+        if (fd < 0)
+            return unexpected(detail::last_error());
+
+        detail::log_header h{};
+        if (::pread(fd, &h, sizeof h, 0) != static_cast<ssize_t>(sizeof h) ||
+            h.magic != detail::log_magic || h.version != detail::log_version ||
+            h.value_size != sizeof(T) || h.error_size != sizeof(E) ||
+            h.block_capacity == 0 || h.block_capacity % 64 != 0 ||
+            h.block_capacity > (size_type(1) << 31)) {
+            ::close(fd);
+            return unexpected(
+                std::make_error_code(std::errc::invalid_argument));
+        }
+
+        expected_log log(mode, h.block_capacity);
+        log.fd_ = fd;
+        struct stat st;
+        if (::fstat(fd, &st) != 0)
+            return unexpected(detail::last_error());
+        const auto file_size = static_cast<std::size_t>(st.st_size);
+        if (file_size < detail::log_page)
+            return unexpected(
+                std::make_error_code(std::errc::invalid_argument));
+        const std::size_t blocks =
+            (file_size - detail::log_page) / log.layout_.size;
+        if (h.count > blocks * h.block_capacity)
+            return unexpected(
+                std::make_error_code(std::errc::invalid_argument));
+        if (auto r = log.map(blocks); !r)
+            return unexpected(r.error());
+
+        log.count_ = h.count;
+        if (write)
+            log.resume();
+        return log;
+    }
+
+    expected_log(expected_log&& rhs) noexcept
+        : mode_(rhs.mode_),
+          capacity_(rhs.capacity_),
+          layout_(rhs.layout_),
+          fd_(std::exchange(rhs.fd_, -1)),
+          map_(std::exchange(rhs.map_, nullptr)),
+          mapped_size_(std::exchange(rhs.mapped_size_, 0)),
+          blocks_(std::exchange(rhs.blocks_, 0)),
+          count_(std::exchange(rhs.count_, 0)),
+          block_errors_(std::exchange(rhs.block_errors_, 0)) {}
+
+    expected_log& operator=(expected_log&& rhs) noexcept {
+        if (this != &rhs) {
+            release();
+            mode_ = rhs.mode_;
+            capacity_ = rhs.capacity_;
+            layout_ = rhs.layout_;
+            fd_ = std::exchange(rhs.fd_, -1);
+            map_ = std::exchange(rhs.map_, nullptr);
+            mapped_size_ = std::exchange(rhs.mapped_size_, 0);
+            blocks_ = std::exchange(rhs.blocks_, 0);
+            count_ = std::exchange(rhs.count_, 0);
+            block_errors_ = std::exchange(rhs.block_errors_, 0);
+        }
+        return *this;
+    }
+
+    ~expected_log() { release(); }
+
+    //
+    // Writing
+    //
+
+    expected<void, std::error_code> push_back(const expected<T, E>& x) {
+        if (mode_ != log_mode::write)
+            return unexpected(
+                std::make_error_code(std::errc::operation_not_permitted));
+        const size_type b = count_ / capacity_;
+        const size_type slot = count_ % capacity_;
+        if (slot == 0) {
+            if (b == blocks_)
+                if (auto r = map(blocks_ * 2); !r)
+                    return r;
+            block_errors_ = 0;
+        }
+
+        std::byte* block = block_data(b);
+        std::uint64_t& word = bitmap(block)[slot / 64];
+        const std::uint64_t bit = std::uint64_t(1) << (slot % 64);
+        if (x.has_value()) {
+            std::memcpy(block + layout_.values + slot * sizeof(T),
+                        std::addressof(*x), sizeof(T));
+            word |= bit;
+        } else {
+            std::memcpy(block + layout_.errors + block_errors_ * sizeof(E),
+                        std::addressof(x.error()), sizeof(E));
+            index(block)[block_errors_] = static_cast<std::uint32_t>(slot);
+            ++block_errors_;
+            word &= ~bit;
+        }
+        publish(++count_);
+        return {};
+    }
+
+    // Writes the committed entries to disk, and then their number.
+    expected<void, std::error_code> flush() {
+        if (mode_ != log_mode::write)
+            return unexpected(
+                std::make_error_code(std::errc::operation_not_permitted));
+        const size_type n = count_;
+        if (::msync(map_, mapped_size_, MS_SYNC) != 0)
+            return unexpected(detail::last_error());
+        std::atomic_ref<std::uint64_t>(header().flushed)
+            .store(n, std::memory_order_release);
+        if (::msync(map_, detail::log_page, MS_SYNC) != 0)
+            return unexpected(detail::last_error());
+        return {};
+    }
+
+    // Discards the entries from n on.
+    void truncate(size_type n) noexcept {
+        if (mode_ != log_mode::write || n >= count_)
+            return;
+        count_ = n;
+        publish(n);
+        if (header().flushed > n)
+            std::atomic_ref<std::uint64_t>(header().flushed)
+                .store(n, std::memory_order_release);
+        resume();
+    }
+
+    //
+    // Reading
+    //
+
+    // The committed entries this log can see: all of them for the writer,
+    // those in the blocks mapped when it was opened for a reader.
+    size_type size() const noexcept {
+        if (mode_ == log_mode::write)
+            return count_;
+        const size_type n =
+            std::atomic_ref<std::uint64_t>(header().count)
+                .load(std::memory_order_acquire);
+        return std::min(n, blocks_ * capacity_);
+    }
+
+    size_type flushed_size() const noexcept {
+        return std::atomic_ref<std::uint64_t>(header().flushed)
+            .load(std::memory_order_acquire);
+    }
+
+    size_type block_capacity() const noexcept { return capacity_; }
+
+    bool has_value(size_type i) const noexcept {
+        const size_type slot = i % capacity_;
+        return (bitmap(block_data(i / capacity_))[slot / 64] >> (slot % 64)) &
+               1;
+    }
+
+    // A copy of entry i, which must be below size(). An error is found by
+    // counting the errors before it in its block's bitmap.
+    expected<T, E> operator[](size_type i) const noexcept {
+        const std::byte* block = block_data(i / capacity_);
+        const size_type slot = i % capacity_;
+        if (has_value(i))
+            return expected<T, E>(std::in_place,
+                                  load<T>(block + layout_.values +
+                                          slot * sizeof(T)));
+        const size_type k =
+            slot - detail::log_bitmap_count(bitmap(block), slot);
+        return expected<T, E>(unexpect,
+                              load<E>(block + layout_.errors + k * sizeof(E)));
+    }
+
+    size_type count_errors() const noexcept {
+        size_type n = 0;
+        for_each_block([&](const std::byte*, size_type errors) {
+            n += errors;
+        });
+        return n;
+    }
+
+    // Calls f(i, e) for each entry i holding an error e, in order.
+    template <class F>
+        requires std::is_invocable_v<F&, size_type, const E&>
+    void for_each_error(F&& f) const {
+        size_type base = 0;
+        for_each_block([&](const std::byte* block, size_type errors) {
+            const std::uint32_t* slots = index(block);
+            const std::byte* e = block + layout_.errors;
+            for (size_type k = 0; k != errors; ++k, e += sizeof(E))
+                std::invoke(f, base + slots[k], load<E>(e));
+            base += capacity_;
+        });
+    }
+
+private:
+    log_mode mode_;
+    size_type capacity_;
+    detail::log_block_layout layout_;
+    int fd_ = -1;
+    std::byte* map_ = nullptr;
+    std::size_t mapped_size_ = 0;
+    size_type blocks_ = 0;          // mapped
+    size_type count_ = 0;           // committed, for the writer
+    size_type block_errors_ = 0;    // errors in the writer's current block
+
+    expected_log(log_mode mode, size_type capacity) noexcept
+        : mode_(mode),
+          capacity_(capacity),
+          layout_(capacity, sizeof(T), sizeof(E)) {}
+
+    template <class X>
+    static X load(const std::byte* p) noexcept {
+        X x;
+        std::memcpy(std::addressof(x), p, sizeof(X));
+        return x;
+    }
+
+    detail::log_header& header() const noexcept {
+        return *std::launder(reinterpret_cast<detail::log_header*>(map_));
+    }
+
+    std::byte* block_data(size_type b) const noexcept {
+        return map_ + detail::log_page + b * layout_.size;
+    }
+
+    static std::uint64_t* bitmap(std::byte* block) noexcept {
+        return std::launder(reinterpret_cast<std::uint64_t*>(block));
+    }
+    static const std::uint64_t* bitmap(const std::byte* block) noexcept {
+        return std::launder(reinterpret_cast<const std::uint64_t*>(block));
+    }
+
+    std::uint32_t* index(std::byte* block) const noexcept {
+        return std::launder(
+            reinterpret_cast<std::uint32_t*>(block + layout_.index));
+    }
+    const std::uint32_t* index(const std::byte* block) const noexcept {
+        return std::launder(
+            reinterpret_cast<const std::uint32_t*>(block + layout_.index));
+    }
+
+    void publish(size_type n) noexcept {
+        std::atomic_ref<std::uint64_t>(header().count)
+            .store(n, std::memory_order_release);
+    }
+
+    // Picks up appending after the last committed entry.
+    void resume() noexcept {
+        const size_type slot = count_ % capacity_;
+        if (slot == 0) {
+            block_errors_ = 0;
+            return;
+        }
+        const std::byte* block = block_data(count_ / capacity_);
+        block_errors_ = slot - detail::log_bitmap_count(bitmap(block), slot);
+    }
+
+    // Calls f(block, errors) for each block with committed entries.
+    template <class F>
+    void for_each_block(F&& f) const {
+        const size_type n = size();
+        for (size_type b = 0; b * capacity_ < n; ++b) {
+            const std::byte* block = block_data(b);
+            const size_type entries = std::min(capacity_, n - b * capacity_);
+            f(block, entries - detail::log_bitmap_count(bitmap(block),
+                                                        entries));
+        }
+    }
+
+    // Maps the header and the given number of blocks, which the writer
+    // first extends the file to hold; it always has a block to append to.
+    expected<void, std::error_code> map(size_type blocks) {
+        const bool write = mode_ == log_mode::write;
+        if (write)
+            blocks = std::max<size_type>(blocks, 1);
+        const std::size_t size = detail::log_page + blocks * layout_.size;
+        if (write && ::ftruncate(fd_, static_cast<off_t>(size)) != 0)
+            return unexpected(detail::last_error());
+        void* p = ::mmap(nullptr, size,
+                         write ? PROT_READ | PROT_WRITE : PROT_READ,
+                         MAP_SHARED, fd_, 0);
+        if (p == MAP_FAILED)
+            return unexpected(detail::last_error());
+        if (map_)
+            ::munmap(map_, mapped_size_);
+        map_ = static_cast<std::byte*>(p);
+        mapped_size_ = size;
+        blocks_ = blocks;
+        return {};
+    }
+
+    void release() noexcept {
+        if (map_)
+            ::munmap(map_, mapped_size_);
+        if (fd_ >= 0)
+            ::close(fd_);
+        map_ = nullptr;
+        fd_ = -1;
+    }
+};
+
+} // namespace bst
+
+
+
+#endif
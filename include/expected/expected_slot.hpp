@@ -0,0 +1,211 @@
+#ifndef BST_EXPECTED_EXPECTED_SLOT_HPP_
+#define BST_EXPECTED_EXPECTED_SLOT_HPP_
+
+//
+// A place to hand one expected from a producer thread to a consumer.
+//
+
+/*
+Overview
+========
+
+namespace bst {
+
+enum class slot_state : unsigned char { empty, value, error };
+
+template <class T, class E>
+class expected_slot {
+public:
+    using result_type = expected<T, E>;
+
+    expected_slot() noexcept;
+    expected_slot(const expected_slot&) = delete;
+    expected_slot& operator=(const expected_slot&) = delete;
+    ~expected_slot();
+
+    // Producer
+    template <class... Args>
+        bool set_value(Args&&...);
+    template <class... Args>
+        bool set_error(Args&&...);
+    bool publish(const expected<T, E>&);
+    bool publish(expected<T, E>&&);
+
+    // Consumer
+    slot_state state() const noexcept;
+    bool ready() const noexcept;
+    expected<T, E>* try_get() noexcept;
+    const expected<T, E>* try_get() const noexcept;
+    expected<T, E>& wait() noexcept;
+    const expected<T, E>& wait() const noexcept;
+    expected<T, E> take();
+    void reset() noexcept;
+};
+
+} // namespace bst
+
+*/
+
+
+#include <expected/expected.hpp>
+
+#include <atomic>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+
+namespace bst {
+
+enum class slot_state : unsigned char { empty, value, error };
+
+//
+// class expected_slot<T, E>
+//
+// Holds at most one expected<T, E>, in place, behind a single atomic state
+// word, for the common case of std::promise<expected<T, E>> where the shared
+// state is not needed: the slot lives wherever the two threads can both see
+// it, and publishing neither allocates nor locks.
+//
+// Publishing claims the empty slot with one compare-and-swap, constructs the
+// result and then releases it with a store, so concurrent producers are safe
+// and all but the first get false. Polling with state(), ready() or try_get()
+// is a single load. wait() blocks on the state word with std::atomic::wait.
+// take() and reset() return the slot to empty for the next result; they, and
+// references returned by try_get() and wait(), must not overlap with another
+// consumer's reset.
+//
+
+template <class T, class E>
+class expected_slot {
+public:
+    using result_type = expected<T, E>;
+
+    expected_slot() noexcept {}
+    expected_slot(const expected_slot&) = delete;
+    expected_slot& operator=(const expected_slot&) = delete;
+
+    ~expected_slot() {
+        if (is_ready(state_.load(std::memory_order_acquire)))
+            std::destroy_at(std::addressof(result_));
+    }
+
+    //
+    // Producer
+    //
+
+    template <class... Args>
+        requires std::is_constructible_v<result_type, std::in_place_t,
+                                         Args...>
+    bool set_value(Args&&... args) {
+        return emplace(std::in_place, std::forward<Args>(args)...);
+    }
+
+    template <class... Args>
+        requires std::is_constructible_v<result_type, unexpect_t, Args...>
+    bool set_error(Args&&... args) {
+        return emplace(unexpect, std::forward<Args>(args)...);
+    }
+
+    bool publish(const result_type& r) { return emplace(r); }
+    bool publish(result_type&& r) { return emplace(std::move(r)); }
+
+    //
+    // Consumer
+    //
+
+    slot_state state() const noexcept {
+        return public_state(state_.load(std::memory_order_acquire));
+    }
+
+    bool ready() const noexcept {
+        return is_ready(state_.load(std::memory_order_acquire));
+    }
+
+    result_type* try_get() noexcept {
+        return ready() ? std::addressof(result_) : nullptr;
+    }
+
+    const result_type* try_get() const noexcept {
+        return ready() ? std::addressof(result_) : nullptr;
+    }
+
+    result_type& wait() noexcept {
+        wait_ready();
+        return result_;
+    }
+
+    const result_type& wait() const noexcept {
+        wait_ready();
+        return result_;
+    }
+
+    // Waits for the result, moves it out and empties the slot.
+    result_type take() {
+        wait_ready();
+        result_type r(std::move(result_));
+        reset();
+        return r;
+    }
+
+    // Destroys the result, if any, and empties the slot.
+    void reset() noexcept {
+        if (is_ready(state_.load(std::memory_order_acquire)))
+            std::destroy_at(std::addressof(result_));
+        state_.store(empty, std::memory_order_release);
+    }
+
+private:
+    // writing marks a slot claimed by a producer whose result is not yet
+    // constructed; consumers see it as empty.
+    enum raw_state : unsigned char { empty, writing, has_value, has_error };
+
+    std::atomic<raw_state> state_{empty};
+    union {
+        result_type result_;
+    };
+
+    static constexpr bool is_ready(raw_state s) noexcept {
+        return s == has_value || s == has_error;
+    }
+
+    static constexpr slot_state public_state(raw_state s) noexcept {
+        return s == has_value   ? slot_state::value
+               : s == has_error ? slot_state::error
+                                : slot_state::empty;
+    }
+
+    template <class... Args>
+    bool emplace(Args&&... args) {
+        raw_state from = empty;
+        if (!state_.compare_exchange_strong(from, writing,
+                                            std::memory_order_acquire,
+                                            std::memory_order_relaxed))
+            return false;
+        BST_EXPECTED_TRY {
+            std::construct_at(std::addressof(result_),
+                              std::forward<Args>(args)...);
+        } BST_EXPECTED_CATCH_ALL {
+            state_.store(empty, std::memory_order_release);
+            BST_EXPECTED_RETHROW;
+        }
+        state_.store(result_.has_value() ? has_value : has_error,
+                     std::memory_order_release);
+        state_.notify_all();
+        return true;
+    }
+
+    void wait_ready() const noexcept {
+        auto s = state_.load(std::memory_order_acquire);
+        while (!is_ready(s)) {
+            state_.wait(s, std::memory_order_acquire);
+            s = state_.load(std::memory_order_acquire);
+        }
+    }
+};
+
+} // namespace bst
+
+
+
+#endif
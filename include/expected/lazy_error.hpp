@@ -0,0 +1,243 @@
+#ifndef BST_EXPECTED_LAZY_ERROR_HPP_
+#define BST_EXPECTED_LAZY_ERROR_HPP_
+
+//
+// Errors that are only built when somebody looks at them.
+//
+
+/*
+Overview
+========
+
+namespace bst {
+
+template <class E, std::size_t BufferSize = 4 * sizeof(void*)>
+class lazy_error {
+public:
+    using error_type = E;
+
+    lazy_error(const E&);
+    lazy_error(E&&);
+    template <class F>
+        explicit lazy_error(F&& f);     // deferred: E is f()
+    lazy_error(const lazy_error&);
+    lazy_error(lazy_error&&) noexcept;
+    lazy_error& operator=(const lazy_error&);
+    lazy_error& operator=(lazy_error&&) noexcept;
+    ~lazy_error();
+
+    bool is_materialized() const noexcept;
+
+    const E& get() const;
+    E& get();
+    const E& operator*() const;
+    E& operator*();
+    const E* operator->() const;
+    E* operator->();
+    operator const E&() const;
+
+    friend bool operator==(const lazy_error&, const lazy_error&);
+    template <class E2>
+        friend bool operator==(const lazy_error&, const E2&);
+};
+
+template <class F>
+    unexpected<lazy_error<std::invoke_result_t<std::decay_t<F>&>>>
+    unexpected_lazy(F&& f);
+
+} // namespace bst
+
+*/
+
+
+#include <expected/expected.hpp>
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+
+namespace bst {
+
+//
+// class lazy_error<E, BufferSize>
+//
+// An error that holds either an E or a callable that produces one. The
+// callable lives in a small inline buffer, so deferring costs no allocation,
+// and runs the first time the error is read through get(), operator* or the
+// conversion to const E&. Code that only tests has_value() on an
+// expected<T, lazy_error<E>> therefore never pays for building E.
+//
+// Reading a pending error from const member functions materializes it in
+// place, so concurrent first reads of the same object are a data race. The
+// callable must be copy constructible, nothrow move constructible and fit in
+// BufferSize bytes.
+//
+
+template <class E, std::size_t BufferSize = 4 * sizeof(void*)>
+    requires std::is_nothrow_move_constructible_v<E>
+class lazy_error {
+    template <class F>
+    static constexpr bool fits_buffer =
+        sizeof(F) <= BufferSize &&
+        alignof(F) <= alignof(std::max_align_t) &&
+        std::is_nothrow_move_constructible_v<F> &&
+        std::is_copy_constructible_v<F>;
+
+public:
+    using error_type = E;
+
+    lazy_error(const E& e) : value_(e) {}
+    lazy_error(E&& e) noexcept : value_(std::move(e)) {}
+
+    template <class F>
+        requires(!std::is_same_v<std::remove_cvref_t<F>, lazy_error> &&
+                 !std::is_convertible_v<F, E> &&
+                 std::is_invocable_r_v<E, std::decay_t<F>&>)
+    explicit lazy_error(F&& f) {
+        using fn_type = std::decay_t<F>;
+        static_assert(fits_buffer<fn_type>,
+                      "the callable does not fit the lazy_error buffer");
+        ::new (static_cast<void*>(buf_)) fn_type(std::forward<F>(f));
+        ops_ = &ops_for<fn_type>;
+    }
+
+    lazy_error(const lazy_error& rhs) {
+        if (rhs.ops_) {
+            rhs.ops_->copy(rhs.buf_, buf_);
+            ops_ = rhs.ops_;
+        } else {
+            std::construct_at(std::addressof(value_), rhs.value_);
+        }
+    }
+
+    lazy_error(lazy_error&& rhs) noexcept { take(std::move(rhs)); }
+
+    lazy_error& operator=(const lazy_error& rhs) {
+        if (this != &rhs) {
+            lazy_error tmp(rhs);
+            reset();
+            take(std::move(tmp));
+        }
+        return *this;
+    }
+
+    lazy_error& operator=(lazy_error&& rhs) noexcept {
+        if (this != &rhs) {
+            reset();
+            take(std::move(rhs));
+        }
+        return *this;
+    }
+
+    ~lazy_error() { reset(); }
+
+    bool is_materialized() const noexcept { return ops_ == nullptr; }
+
+    const E& get() const {
+        if (ops_) [[unlikely]]
+            materialize();
+        return value_;
+    }
+
+    E& get() {
+        if (ops_) [[unlikely]]
+            materialize();
+        return value_;
+    }
+
+    const E& operator*() const { return get(); }
+    E& operator*() { return get(); }
+    const E* operator->() const { return std::addressof(get()); }
+    E* operator->() { return std::addressof(get()); }
+    operator const E&() const { return get(); }
+
+    friend bool operator==(const lazy_error& x, const lazy_error& y) {
+        return x.get() == y.get();
+    }
+
+    template <class E2>
+        requires(!std::is_same_v<E2, lazy_error>)
+    friend bool operator==(const lazy_error& x, const E2& y) {
+        return x.get() == y;
+    }
+
+private:
+    struct ops {
+        E (*invoke)(void*);
+        void (*copy)(const void*, void*);
+        void (*move)(void*, void*) noexcept;
+        void (*destroy)(void*) noexcept;
+    };
+
+    template <class F>
+    static constexpr ops ops_for = {
+        [](void* f) -> E { return std::invoke(*static_cast<F*>(f)); },
+        [](const void* from, void* to) {
+            ::new (to) F(*static_cast<const F*>(from));
+        },
+        [](void* from, void* to) noexcept {
+            ::new (to) F(std::move(*static_cast<F*>(from)));
+        },
+        [](void* f) noexcept { static_cast<F*>(f)->~F(); },
+    };
+
+    // A null ops_ means value_ is live; otherwise buf_ holds the callable.
+    mutable const ops* ops_ = nullptr;
+    union {
+        mutable E value_;
+        alignas(std::max_align_t) mutable std::byte buf_[BufferSize];
+    };
+
+    // Run the callable and replace it with its result. If the callable
+    // throws, the error stays pending.
+    BST_EXPECTED_COLD void materialize() const {
+        E e = ops_->invoke(buf_);
+        ops_->destroy(buf_);
+        std::construct_at(std::addressof(value_), std::move(e));
+        ops_ = nullptr;
+    }
+
+    // Move rhs's contents into this empty object. A pending rhs keeps its
+    // moved-from callable.
+    void take(lazy_error&& rhs) noexcept {
+        if (rhs.ops_) {
+            rhs.ops_->move(rhs.buf_, buf_);
+            ops_ = rhs.ops_;
+        } else {
+            std::construct_at(std::addressof(value_), std::move(rhs.value_));
+        }
+    }
+
+    void reset() noexcept {
+        if (ops_)
+            ops_->destroy(buf_);
+        else
+            std::destroy_at(std::addressof(value_));
+    }
+};
+
+
+
+//
+// unexpected_lazy
+//
+// Wraps a callable returning the error in an unexpected, for returning a
+// deferred error from a function whose result is expected<T, lazy_error<E>>.
+//
+
+template <class F>
+unexpected<lazy_error<std::invoke_result_t<std::decay_t<F>&>>>
+unexpected_lazy(F&& f) {
+    return unexpected<lazy_error<std::invoke_result_t<std::decay_t<F>&>>>(
+        std::in_place, std::forward<F>(f));
+}
+
+} // namespace bst
+
+
+
+#endif
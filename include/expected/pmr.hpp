@@ -0,0 +1,65 @@
+#ifndef BST_EXPECTED_PMR_HPP_
+#define BST_EXPECTED_PMR_HPP_
+
+//
+// expected for alternatives that allocate from a memory resource.
+//
+
+/*
+Overview
+========
+
+namespace bst {
+namespace pmr {
+
+template <class T, class E>
+    using expected = bst::expected<T, E>;
+
+} // namespace pmr
+} // namespace bst
+
+where T or E uses std::pmr::polymorphic_allocator.
+
+*/
+
+
+#include <expected/expected.hpp>
+
+#include <memory>
+#include <memory_resource>
+
+
+namespace bst {
+
+namespace pmr {
+
+//
+// pmr::expected<T, E>
+//
+// An expected needs no allocator parameter of its own. Its alternatives
+// carry their allocators, and expected<T, E> passes one on through its
+// std::allocator_arg_t constructors. The alias only checks that at least one
+// alternative takes a memory resource, so an expected meant to live in an
+// arena does not quietly use the default heap.
+//
+// When both alternatives are pmr-aware, several operations allocate only
+// from the resources the alternatives already hold:
+//   - construction inside a std::pmr container;
+//   - assignment;
+//   - swap.
+// A copy made without an allocator uses the default resource, as copies of
+// the std::pmr containers do.
+//
+
+template <class T, class E>
+    requires std::uses_allocator_v<bst::expected<T, E>,
+                                   std::pmr::polymorphic_allocator<>>
+using expected = bst::expected<T, E>;
+
+} // namespace pmr
+
+} // namespace bst
+
+
+
+#endif
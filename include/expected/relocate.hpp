@@ -0,0 +1,319 @@
+#ifndef BST_EXPECTED_RELOCATE_HPP_
+#define BST_EXPECTED_RELOCATE_HPP_
+
+//
+// Trivial relocation for expected, and a vector that takes advantage of it.
+//
+
+/*
+Overview
+========
+
+namespace bst {
+
+template <class T>
+struct is_trivially_relocatable;
+template <class T>
+inline constexpr bool is_trivially_relocatable_v;
+
+template <class T>
+    T* uninitialized_relocate(T* first, T* last, T* d_first);
+template <class T>
+    T* relocate_n(T* first, std::size_t n, T* d_first);
+
+template <class T>
+class relocating_vector {
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    relocating_vector() noexcept;
+    relocating_vector(const relocating_vector&);
+    relocating_vector(relocating_vector&&) noexcept;
+    relocating_vector& operator=(relocating_vector);
+    ~relocating_vector();
+
+    T& operator[](size_type) noexcept;
+    const T& operator[](size_type) const noexcept;
+    T* data() noexcept;
+    const T* data() const noexcept;
+
+    iterator begin() noexcept;
+    iterator end() noexcept;
+    const_iterator begin() const noexcept;
+    const_iterator end() const noexcept;
+
+    bool empty() const noexcept;
+    size_type size() const noexcept;
+    size_type capacity() const noexcept;
+    void reserve(size_type);
+
+    template <class... Args>
+        T& emplace_back(Args&&...);
+    void push_back(const T&);
+    void push_back(T&&);
+    void pop_back() noexcept;
+    void clear() noexcept;
+
+    void swap(relocating_vector&) noexcept;
+    friend void swap(relocating_vector&, relocating_vector&) noexcept;
+};
+
+} // namespace bst
+
+*/
+
+
+#include <expected/expected.hpp>
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+
+namespace bst {
+
+//
+// struct is_trivially_relocatable<T>
+//
+// A type is trivially relocatable when move-constructing an object into new
+// storage and destroying the original is equivalent to copying its bytes.
+// That holds for every trivially copyable type, for std::unique_ptr and
+// std::shared_ptr, and for expected and unexpected whenever it holds for
+// their alternatives. Other types opt in by specializing this trait.
+//
+
+template <class T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+template <class T>
+inline constexpr bool is_trivially_relocatable_v =
+    is_trivially_relocatable<T>::value;
+
+template <class T, class E>
+struct is_trivially_relocatable<expected<T, E>>
+    : std::conjunction<is_trivially_relocatable<T>,
+                       is_trivially_relocatable<E>> {};
+
+template <class E>
+struct is_trivially_relocatable<expected<void, E>>
+    : is_trivially_relocatable<E> {};
+
+template <class T, class E>
+struct is_trivially_relocatable<expected<T&, E>>
+    : is_trivially_relocatable<E> {};
+
+template <class E>
+struct is_trivially_relocatable<unexpected<E>> : is_trivially_relocatable<E> {
+};
+
+template <class T>
+struct is_trivially_relocatable<std::unique_ptr<T>> : std::true_type {};
+
+template <class T>
+struct is_trivially_relocatable<std::shared_ptr<T>> : std::true_type {};
+
+
+
+//
+// uninitialized_relocate / relocate_n
+//
+// Move the objects in [first, last) into the uninitialized storage starting
+// at d_first and end their lifetime in the source, returning the end of the
+// destination range. Trivially relocatable types are moved with a single
+// memmove, so only then may the ranges overlap. If a move constructor throws,
+// the destination holds no objects and the source is left intact, although
+// its elements may have been moved from.
+//
+
+template <class T>
+T* uninitialized_relocate(T* first, T* last, T* d_first) noexcept(
+    is_trivially_relocatable_v<T> || std::is_nothrow_move_constructible_v<T>) {
+    if constexpr (is_trivially_relocatable_v<T>) {
+        const std::size_t n = static_cast<std::size_t>(last - first);
+        if (n != 0)
+            std::memmove(static_cast<void*>(d_first),
+                         static_cast<const void*>(first), n * sizeof(T));
+        return d_first + n;
+    } else if constexpr (std::is_nothrow_move_constructible_v<T>) {
+        for (; first != last; ++first, ++d_first) {
+            std::construct_at(d_first, std::move(*first));
+            std::destroy_at(first);
+        }
+        return d_first;
+    } else {
+        T* d_last = std::uninitialized_move(first, last, d_first);
+        std::destroy(first, last);
+        return d_last;
+    }
+}
+
+template <class T>
+T* relocate_n(T* first, std::size_t n, T* d_first) noexcept(
+    noexcept(uninitialized_relocate(first, first + n, d_first))) {
+    return uninitialized_relocate(first, first + n, d_first);
+}
+
+
+
+//
+// class relocating_vector<T>
+//
+// A minimal growable array whose reallocation goes through
+// uninitialized_relocate, so growing a vector of trivially relocatable
+// expecteds is a single memmove rather than a move and a destroy per element.
+//
+
+template <class T>
+class relocating_vector {
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using reference = T&;
+    using const_reference = const T&;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    relocating_vector() noexcept = default;
+
+    relocating_vector(const relocating_vector& rhs) {
+        reserve(rhs.size_);
+        BST_EXPECTED_TRY {
+            std::uninitialized_copy(rhs.begin(), rhs.end(), data_);
+        } BST_EXPECTED_CATCH_ALL {
+            alloc_type().deallocate(data_, capacity_);
+            BST_EXPECTED_RETHROW;
+        }
+        size_ = rhs.size_;
+    }
+
+    relocating_vector(relocating_vector&& rhs) noexcept
+        : data_(std::exchange(rhs.data_, nullptr)),
+          size_(std::exchange(rhs.size_, 0)),
+          capacity_(std::exchange(rhs.capacity_, 0)) {}
+
+    relocating_vector& operator=(relocating_vector rhs) noexcept {
+        swap(rhs);
+        return *this;
+    }
+
+    ~relocating_vector() {
+        clear();
+        if (data_)
+            alloc_type().deallocate(data_, capacity_);
+    }
+
+    // Element access
+
+    T& operator[](size_type i) noexcept { return data_[i]; }
+    const T& operator[](size_type i) const noexcept { return data_[i]; }
+
+    T& front() noexcept { return data_[0]; }
+    const T& front() const noexcept { return data_[0]; }
+    T& back() noexcept { return data_[size_ - 1]; }
+    const T& back() const noexcept { return data_[size_ - 1]; }
+
+    T* data() noexcept { return data_; }
+    const T* data() const noexcept { return data_; }
+
+    // Iterators
+
+    iterator begin() noexcept { return data_; }
+    iterator end() noexcept { return data_ + size_; }
+    const_iterator begin() const noexcept { return data_; }
+    const_iterator end() const noexcept { return data_ + size_; }
+
+    // Capacity
+
+    bool empty() const noexcept { return size_ == 0; }
+    size_type size() const noexcept { return size_; }
+    size_type capacity() const noexcept { return capacity_; }
+
+    void reserve(size_type n) {
+        if (n <= capacity_)
+            return;
+        T* p = alloc_type().allocate(n);
+        BST_EXPECTED_TRY {
+            uninitialized_relocate(begin(), end(), p);
+        } BST_EXPECTED_CATCH_ALL {
+            alloc_type().deallocate(p, n);
+            BST_EXPECTED_RETHROW;
+        }
+        replace_buffer(p, n);
+    }
+
+    // Modifiers
+
+    template <class... Args>
+    T& emplace_back(Args&&... args) {
+        if (size_ < capacity_) {
+            std::construct_at(data_ + size_, std::forward<Args>(args)...);
+            return data_[size_++];
+        }
+
+        // Construct the new element before relocating the old ones, in case
+        // args refer into this vector.
+        const size_type n = capacity_ ? 2 * capacity_ : 4;
+        T* p = alloc_type().allocate(n);
+        BST_EXPECTED_TRY {
+            std::construct_at(p + size_, std::forward<Args>(args)...);
+        } BST_EXPECTED_CATCH_ALL {
+            alloc_type().deallocate(p, n);
+            BST_EXPECTED_RETHROW;
+        }
+        BST_EXPECTED_TRY {
+            uninitialized_relocate(begin(), end(), p);
+        } BST_EXPECTED_CATCH_ALL {
+            std::destroy_at(p + size_);
+            alloc_type().deallocate(p, n);
+            BST_EXPECTED_RETHROW;
+        }
+        replace_buffer(p, n);
+        return data_[size_++];
+    }
+
+    void push_back(const T& v) { emplace_back(v); }
+    void push_back(T&& v) { emplace_back(std::move(v)); }
+
+    void pop_back() noexcept { std::destroy_at(data_ + --size_); }
+
+    void clear() noexcept {
+        std::destroy(begin(), end());
+        size_ = 0;
+    }
+
+    void swap(relocating_vector& rhs) noexcept {
+        std::swap(data_, rhs.data_);
+        std::swap(size_, rhs.size_);
+        std::swap(capacity_, rhs.capacity_);
+    }
+
+    friend void swap(relocating_vector& x, relocating_vector& y) noexcept {
+        x.swap(y);
+    }
+
+private:
+    using alloc_type = std::allocator<T>;
+
+    T* data_ = nullptr;
+    size_type size_ = 0;
+    size_type capacity_ = 0;
+
+    // Release the old buffer once its elements have been relocated to p.
+    void replace_buffer(T* p, size_type n) noexcept {
+        if (data_)
+            alloc_type().deallocate(data_, capacity_);
+        data_ = p;
+        capacity_ = n;
+    }
+};
+
+} // namespace bst
+
+
+
+#endif
@@ -0,0 +1,740 @@
+#ifndef BST_EXPECTED_SERIALIZE_HPP_
+#define BST_EXPECTED_SERIALIZE_HPP_
+
+//
+// Binary encodings of expected values, for passing them between processes.
+//
+
+/*
+Overview
+========
+
+namespace bst {
+
+enum class encoding_errc {
+    buffer_too_small = 1, too_large, truncated, bad_header, bad_payload,
+    misaligned
+};
+
+template <class X>
+struct serializer;      // specialized to encode a type that is not
+                        // trivially copyable, or one that is differently
+
+// Records
+
+template <class T, class E>
+    std::size_t encoded_size(const expected<T, E>&);
+template <class T, class E>
+    expected<std::size_t, encoding_errc>
+    encode(const expected<T, E>&, std::span<std::byte> out);
+template <class T, class E>
+    expected<expected<T, E>, encoding_errc>
+    decode(std::span<const std::byte> in);
+expected<std::size_t, encoding_errc>
+    record_size(std::span<const std::byte> in);
+
+template <class T, class E>
+class expected_view {
+public:
+    using value_type = T;
+    using error_type = E;
+
+    bool has_value() const noexcept;
+    explicit operator bool() const noexcept;
+    const T& operator*() const noexcept;
+    const T* operator->() const noexcept;
+    const E& error() const noexcept;
+    std::size_t size() const noexcept;      // of the record, in bytes
+    expected<T, E> get() const;
+};
+
+template <class T, class E>
+    expected<expected_view<T, E>, encoding_errc>
+    view_record(std::span<const std::byte> in);
+
+// Columns
+
+template <std::ranges::contiguous_range R>
+    std::size_t encoded_columns_size(const R& r);
+template <std::ranges::contiguous_range R>
+    expected<std::size_t, encoding_errc>
+    encode_columns(const R& r, std::span<std::byte> out);
+
+template <class T, class E>
+class columns_view {
+public:
+    std::size_t size() const noexcept;
+    std::size_t value_count() const noexcept;
+    std::size_t error_count() const noexcept;
+    bool has_value(std::size_t) const noexcept;
+    std::span<const T> values() const noexcept;
+    std::span<const E> errors() const noexcept;
+    template <std::ranges::contiguous_range O>
+        void decode(O&& out) const;
+};
+
+template <class T, class E>
+    expected<columns_view<T, E>, encoding_errc>
+    view_columns(std::span<const std::byte> in);
+
+} // namespace bst
+
+where the elements of r are expected<T, E>, and out holds expected<T, E>.
+
+*/
+
+
+#include <expected/expected.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <ranges>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+
+namespace bst {
+
+//
+// Errors
+//
+// What encoding or decoding can fail with. The decoders check an input
+// fully before looking at its payloads, so a buffer that is short or
+// corrupted gives an error, not a read out of bounds.
+//
+
+enum class encoding_errc {
+    buffer_too_small = 1,   // the output cannot hold the encoding
+    too_large,              // a payload is 4 GiB or more
+    truncated,              // the input ends inside the encoding
+    bad_header,             // the input is not an encoding of this type
+    bad_payload,            // a serializer rejected a payload
+    misaligned,             // a view's payloads would not be aligned
+};
+
+
+
+//
+// struct serializer<X>
+//
+// How a payload is written. A trivially copyable type is copied byte for
+// byte, in the representation of the machine, padding included, unless
+// serializer is specialized for it. A specialization provides
+//
+//     static std::size_t size(const X& x);
+//     static void write(const X& x, std::span<std::byte> out);
+//     static expected<X, encoding_errc> read(std::span<const std::byte> in);
+//
+// where write fills exactly size(x) bytes and read is given exactly the
+// bytes that write produced. Only the default encoding can be read in place
+// by expected_view and columns_view.
+//
+
+template <class X>
+struct serializer;
+
+namespace detail {
+template <class X>
+concept custom_serializable =
+    requires(const X& x, std::span<std::byte> out,
+             std::span<const std::byte> in) {
+        { serializer<X>::size(x) } -> std::convertible_to<std::size_t>;
+        serializer<X>::write(x, out);
+        { serializer<X>::read(in) } -> std::same_as<expected<X, encoding_errc>>;
+    };
+
+// Encoded as the bytes of the object, and so readable in place.
+template <class X>
+concept plain_payload =
+    std::is_trivially_copyable_v<X> && !custom_serializable<X>;
+
+template <class X>
+concept payload = std::is_void_v<X> || plain_payload<X> ||
+                  custom_serializable<X>;
+
+template <class X>
+std::size_t payload_size(const X& x) {
+    if constexpr (custom_serializable<X>)
+        return serializer<X>::size(x);
+    else
+        return sizeof(X);
+}
+
+template <class X>
+void write_payload(const X& x, std::byte* out, std::size_t n) {
+    if constexpr (custom_serializable<X>)
+        serializer<X>::write(x, std::span<std::byte>(out, n));
+    else
+        std::memcpy(out, std::addressof(x), sizeof(X));
+}
+
+template <class X>
+expected<X, encoding_errc> read_payload(std::span<const std::byte> in) {
+    if constexpr (custom_serializable<X>) {
+        return serializer<X>::read(in);
+    } else {
+        if (in.size() != sizeof(X))
+            return unexpected(encoding_errc::bad_header);
+        alignas(X) std::byte buffer[sizeof(X)];
+        std::memcpy(buffer, in.data(), sizeof(X));
+        return *std::launder(reinterpret_cast<const X*>(buffer));
+    }
+}
+
+// The n objects whose bytes start at p, which were written by another
+// program, or by this one through a different type.
+template <class X>
+const X* objects_at(const std::byte* p, std::size_t n) noexcept {
+#ifdef __cpp_lib_start_lifetime_as
+    return std::start_lifetime_as_array<X>(p, n);
+#else
+    static_cast<void>(n);
+    return std::launder(reinterpret_cast<const X*>(p));
+#endif
+}
+
+inline bool is_aligned(const void* p, std::size_t alignment) noexcept {
+    return reinterpret_cast<std::uintptr_t>(p) % alignment == 0;
+}
+
+constexpr std::size_t align_up(std::size_t n, std::size_t alignment) noexcept {
+    return (n + alignment - 1) / alignment * alignment;
+}
+
+template <class X>
+void store(std::byte* out, X x) noexcept {
+    std::memcpy(out, &x, sizeof(X));
+}
+
+template <class X>
+X load(const std::byte* in) noexcept {
+    X x;
+    std::memcpy(&x, in, sizeof(X));
+    return x;
+}
+} // namespace detail
+
+
+
+//
+// Records
+//
+// One expected is encoded as a record:
+//
+//     offset 0    1 byte     1 for a value, 0 for an error
+//     offset 1    3 bytes    zero
+//     offset 4    uint32     n, the size of the payload in bytes
+//     offset 8    n bytes    the payload: the value or the error
+//                            zero bytes up to a multiple of 8
+//
+// The integers are in the byte order of the machine, as the payloads are,
+// so both ends must agree on the representation of T and E; they do between
+// processes of one program on one machine. An expected<void, E> holding a
+// value has no payload. Records are multiples of 8 bytes long, so records
+// written one after the other into a buffer aligned to 8 bytes all start on
+// such a boundary, and payloads aligned to no more than that can be read in
+// place.
+//
+
+namespace detail {
+inline constexpr std::size_t record_header_size = 8;
+inline constexpr std::size_t record_alignment = 8;
+
+template <class T, class E>
+concept record_payloads = payload<T> && payload<E> && !std::is_void_v<E>;
+
+struct record_header {
+    bool has_value;
+    std::size_t payload_size;
+};
+
+inline expected<record_header, encoding_errc>
+read_record_header(std::span<const std::byte> in) noexcept {
+    if (in.size() < record_header_size)
+        return unexpected(encoding_errc::truncated);
+    const auto tag = std::to_integer<unsigned>(in[0]);
+    if (tag > 1 || in[1] != std::byte{0} || in[2] != std::byte{0} ||
+        in[3] != std::byte{0})
+        return unexpected(encoding_errc::bad_header);
+    const std::size_t n = load<std::uint32_t>(in.data() + 4);
+    if (in.size() - record_header_size < align_up(n, record_alignment))
+        return unexpected(encoding_errc::truncated);
+    return record_header{tag == 1, n};
+}
+
+// The payload size of a record holding an X encoded byte for byte.
+template <class X>
+constexpr std::size_t fixed_payload_size() noexcept {
+    if constexpr (std::is_void_v<X>)
+        return 0;
+    else
+        return sizeof(X);
+}
+} // namespace detail
+
+template <class T, class E>
+    requires detail::record_payloads<T, E>
+std::size_t encoded_size(const expected<T, E>& x) {
+    std::size_t n = 0;
+    if (!x.has_value())
+        n = detail::payload_size(x.error());
+    else if constexpr (!std::is_void_v<T>)
+        n = detail::payload_size(*x);
+    return detail::record_header_size +
+           detail::align_up(n, detail::record_alignment);
+}
+
+// Writes x to the start of out, and returns the number of bytes written.
+template <class T, class E>
+    requires detail::record_payloads<T, E>
+expected<std::size_t, encoding_errc> encode(const expected<T, E>& x,
+                                            std::span<std::byte> out) {
+    std::size_t n = 0;
+    if (!x.has_value())
+        n = detail::payload_size(x.error());
+    else if constexpr (!std::is_void_v<T>)
+        n = detail::payload_size(*x);
+    if (n > std::numeric_limits<std::uint32_t>::max())
+        return unexpected(encoding_errc::too_large);
+    const std::size_t size = detail::record_header_size +
+                             detail::align_up(n, detail::record_alignment);
+    if (out.size() < size)
+        return unexpected(encoding_errc::buffer_too_small);
+
+    std::byte* p = out.data();
+    p[0] = x.has_value() ? std::byte{1} : std::byte{0};
+    p[1] = p[2] = p[3] = std::byte{0};
+    detail::store(p + 4, static_cast<std::uint32_t>(n));
+    p += detail::record_header_size;
+    if (!x.has_value())
+        detail::write_payload(x.error(), p, n);
+    else if constexpr (!std::is_void_v<T>)
+        detail::write_payload(*x, p, n);
+    std::fill(p + n, out.data() + size, std::byte{0});
+    return size;
+}
+
+// The size of the record at the start of in, for stepping to the next.
+inline expected<std::size_t, encoding_errc>
+record_size(std::span<const std::byte> in) noexcept {
+    return detail::read_record_header(in).transform(
+        [](const detail::record_header& h) {
+            return detail::record_header_size +
+                   detail::align_up(h.payload_size, detail::record_alignment);
+        });
+}
+
+// Copies the record at the start of in out of the buffer.
+template <class T, class E>
+    requires detail::record_payloads<T, E>
+expected<expected<T, E>, encoding_errc>
+decode(std::span<const std::byte> in) {
+    using R = expected<expected<T, E>, encoding_errc>;
+    const auto h = detail::read_record_header(in);
+    if (!h)
+        return unexpected(h.error());
+    const auto payload =
+        in.subspan(detail::record_header_size, h->payload_size);
+
+    if (!h->has_value) {
+        auto e = detail::read_payload<E>(payload);
+        if (!e)
+            return unexpected(e.error());
+        return R(std::in_place, unexpect, std::move(*e));
+    }
+    if constexpr (std::is_void_v<T>) {
+        if (!payload.empty())
+            return unexpected(encoding_errc::bad_header);
+        return R(std::in_place);
+    } else {
+        auto v = detail::read_payload<T>(payload);
+        if (!v)
+            return unexpected(v.error());
+        return R(std::in_place, std::in_place, std::move(*v));
+    }
+}
+
+
+
+//
+// class expected_view<T, E>
+//
+// A record read in place: the value or error it refers to is the payload in
+// the buffer, which must outlive the view. Obtained from view_record, which
+// checks the record and the alignment of its payload, so that reading it is
+// as cheap as reading an expected in memory.
+//
+
+template <class T, class E>
+    requires((std::is_void_v<T> || detail::plain_payload<T>) &&
+             detail::plain_payload<E>)
+class expected_view {
+public:
+    using value_type = T;
+    using error_type = E;
+
+    bool has_value() const noexcept { return record_[0] == std::byte{1}; }
+    explicit operator bool() const noexcept { return has_value(); }
+
+    template <class U = T>
+        requires(!std::is_void_v<U>)
+    const U& operator*() const noexcept {
+        return *detail::objects_at<U>(payload(), 1);
+    }
+
+    template <class U = T>
+        requires(!std::is_void_v<U>)
+    const U* operator->() const noexcept {
+        return detail::objects_at<U>(payload(), 1);
+    }
+
+    const E& error() const noexcept {
+        return *detail::objects_at<E>(payload(), 1);
+    }
+
+    std::size_t size() const noexcept {
+        return detail::record_header_size +
+               detail::align_up(detail::load<std::uint32_t>(record_ + 4),
+                                detail::record_alignment);
+    }
+
+    // A copy of the expected the record holds.
+    expected<T, E> get() const {
+        if (!has_value())
+            return expected<T, E>(unexpect, error());
+        if constexpr (std::is_void_v<T>)
+            return expected<T, E>();
+        else
+            return expected<T, E>(std::in_place, **this);
+    }
+
+private:
+    template <class U, class G>
+        requires detail::record_payloads<U, G>
+    friend expected<expected_view<U, G>, encoding_errc>
+    view_record(std::span<const std::byte> in);
+
+    explicit expected_view(const std::byte* record) noexcept
+        : record_(record) {}
+
+    const std::byte* payload() const noexcept {
+        return record_ + detail::record_header_size;
+    }
+
+    const std::byte* record_;
+};
+
+template <class T, class E>
+    requires detail::record_payloads<T, E>
+expected<expected_view<T, E>, encoding_errc>
+view_record(std::span<const std::byte> in) {
+    const auto h = detail::read_record_header(in);
+    if (!h)
+        return unexpected(h.error());
+    const std::byte* payload = in.data() + detail::record_header_size;
+    if (h->has_value) {
+        if (h->payload_size != detail::fixed_payload_size<T>())
+            return unexpected(encoding_errc::bad_header);
+        if constexpr (!std::is_void_v<T>)
+            if (!detail::is_aligned(payload, alignof(T)))
+                return unexpected(encoding_errc::misaligned);
+    } else {
+        if (h->payload_size != sizeof(E))
+            return unexpected(encoding_errc::bad_header);
+        if (!detail::is_aligned(payload, alignof(E)))
+            return unexpected(encoding_errc::misaligned);
+    }
+    return expected_view<T, E>(in.data());
+}
+
+
+
+//
+// Columns
+//
+// A sequence of expected<T, E> of trivially copyable T and E is encoded as
+// columns, so that a reader can take all the values, or all the errors, as
+// one array without decoding anything:
+//
+//     offset 0    uint32     0x43545342, "BSTC" on a little-endian machine
+//     offset 4    uint32     1, the version of the layout
+//     offset 8    uint32     sizeof(T)
+//     offset 12   uint32     sizeof(E)
+//     offset 16   uint64     count, the number of expecteds
+//     offset 24   uint64     values, the number of them holding a value
+//     offset 32   uint64[]   a bitmap of (count + 63) / 64 words, bit i of
+//                            word i / 64 being set when expected i holds a
+//                            value; bits past count are zero
+//     then        T[values]        the values, in order
+//     then        E[count-values]  the errors, in order
+//
+// Each of the two arrays starts at an offset that is a multiple of
+// max(8, alignof(T), alignof(E)), the columns' alignment, and the gaps and
+// the end, up to the next such multiple, are zero. As for records, the
+// integers and payloads are in the representation of the machine.
+//
+
+namespace detail {
+inline constexpr std::uint32_t columns_magic = 0x43545342;
+inline constexpr std::uint32_t columns_version = 1;
+inline constexpr std::size_t columns_header_size = 32;
+inline constexpr std::size_t column_word_bits = 64;
+
+template <class T, class E>
+inline constexpr std::size_t column_alignment =
+    std::max({std::size_t(8), alignof(T), alignof(E)});
+
+template <class T, class E>
+concept column_payloads = plain_payload<T> && plain_payload<E>;
+
+template <class R>
+using column_element_t = std::remove_cv_t<std::ranges::range_value_t<R>>;
+
+template <class R>
+concept column_input =
+    std::ranges::contiguous_range<R> && std::ranges::sized_range<R> &&
+    is_expected<column_element_t<R>>::value &&
+    column_payloads<typename column_element_t<R>::value_type,
+                    typename column_element_t<R>::error_type>;
+
+struct column_layout {
+    std::size_t values;     // offset of the values
+    std::size_t errors;     // offset of the errors
+    std::size_t size;       // of the whole encoding
+};
+
+template <class T, class E>
+constexpr column_layout layout_columns(std::size_t count,
+                                       std::size_t values) noexcept {
+    constexpr std::size_t a = column_alignment<T, E>;
+    const std::size_t words = (count + column_word_bits - 1) / column_word_bits;
+    column_layout l{};
+    l.values = align_up(columns_header_size + 8 * words, a);
+    l.errors = align_up(l.values + sizeof(T) * values, a);
+    l.size = align_up(l.errors + sizeof(E) * (count - values), a);
+    return l;
+}
+
+template <class R>
+std::size_t count_values(const R& r) noexcept {
+    std::size_t n = 0;
+    for (const auto& x : r)
+        n += x.has_value();
+    return n;
+}
+} // namespace detail
+
+template <std::ranges::contiguous_range R>
+    requires detail::column_input<R>
+std::size_t encoded_columns_size(const R& r) {
+    using X = detail::column_element_t<R>;
+    return detail::layout_columns<typename X::value_type,
+                                  typename X::error_type>(
+               std::ranges::size(r), detail::count_values(r))
+        .size;
+}
+
+// Writes the elements of r to the start of out, and returns the number of
+// bytes written. The bitmap is built a word at a time and each payload is
+// copied straight to the end of its column.
+template <std::ranges::contiguous_range R>
+    requires detail::column_input<R>
+expected<std::size_t, encoding_errc> encode_columns(const R& r,
+                                                    std::span<std::byte> out) {
+    using X = detail::column_element_t<R>;
+    using T = typename X::value_type;
+    using E = typename X::error_type;
+
+    const std::size_t count = std::ranges::size(r);
+    const std::size_t values = detail::count_values(r);
+    const auto l = detail::layout_columns<T, E>(count, values);
+    if (out.size() < l.size)
+        return unexpected(encoding_errc::buffer_too_small);
+
+    // Everything but the payloads is written, the padding included, so that
+    // the encoding does not depend on what was in out before.
+    std::byte* p = out.data();
+    const std::size_t words =
+        (count + detail::column_word_bits - 1) / detail::column_word_bits;
+    std::fill(p + detail::columns_header_size + 8 * words, p + l.values,
+              std::byte{0});
+    std::fill(p + l.values + sizeof(T) * values, p + l.errors, std::byte{0});
+    std::fill(p + l.errors + sizeof(E) * (count - values), p + l.size,
+              std::byte{0});
+    detail::store(p, detail::columns_magic);
+    detail::store(p + 4, detail::columns_version);
+    detail::store(p + 8, static_cast<std::uint32_t>(sizeof(T)));
+    detail::store(p + 12, static_cast<std::uint32_t>(sizeof(E)));
+    detail::store(p + 16, static_cast<std::uint64_t>(count));
+    detail::store(p + 24, static_cast<std::uint64_t>(values));
+
+    const X* in = std::ranges::data(r);
+    std::byte* bitmap = p + detail::columns_header_size;
+    std::byte* value_out = p + l.values;
+    std::byte* error_out = p + l.errors;
+    for (std::size_t base = 0; base < count;
+         base += detail::column_word_bits) {
+        const std::size_t n =
+            std::min(count - base, detail::column_word_bits);
+        std::uint64_t word = 0;
+        for (std::size_t k = 0; k != n; ++k) {
+            const X& x = in[base + k];
+            if (x.has_value()) {
+                word |= std::uint64_t(1) << k;
+                std::memcpy(value_out, std::addressof(*x), sizeof(T));
+                value_out += sizeof(T);
+            } else {
+                std::memcpy(error_out, std::addressof(x.error()), sizeof(E));
+                error_out += sizeof(E);
+            }
+        }
+        detail::store(bitmap + base / 8, word);
+    }
+    return l.size;
+}
+
+
+
+//
+// class columns_view<T, E>
+//
+// Encoded columns read in place, from a buffer that must outlive the view.
+// view_columns checks the header, that the bitmap agrees with the counts,
+// and the alignment of the columns, so that values() and errors() are
+// arrays in the buffer and decode() cannot read past it.
+//
+
+template <class T, class E>
+    requires detail::column_payloads<T, E>
+class columns_view {
+public:
+    std::size_t size() const noexcept { return count_; }
+    std::size_t value_count() const noexcept { return values_.size(); }
+    std::size_t error_count() const noexcept { return errors_.size(); }
+
+    bool has_value(std::size_t i) const noexcept {
+        return (word(i / detail::column_word_bits) >>
+                (i % detail::column_word_bits)) &
+               1;
+    }
+
+    std::span<const T> values() const noexcept { return values_; }
+    std::span<const E> errors() const noexcept { return errors_; }
+
+    // Assigns the i-th expected to out[i], for each i below size(). Words of
+    // the bitmap that are all values or all errors are copied without
+    // testing each bit.
+    template <std::ranges::contiguous_range O>
+        requires std::is_assignable_v<std::ranges::range_reference_t<O>,
+                                      expected<T, E>>
+    void decode(O&& out) const {
+        auto* dst = std::ranges::data(out);
+        const T* v = values_.data();
+        const E* e = errors_.data();
+        for (std::size_t base = 0; base < count_;
+             base += detail::column_word_bits) {
+            const std::size_t n =
+                std::min(count_ - base, detail::column_word_bits);
+            const std::uint64_t w = word(base / detail::column_word_bits);
+            if (w == 0) {
+                for (std::size_t k = 0; k != n; ++k)
+                    dst[base + k] = expected<T, E>(unexpect, *e++);
+            } else if (std::popcount(w) == static_cast<int>(n)) {
+                for (std::size_t k = 0; k != n; ++k)
+                    dst[base + k] = expected<T, E>(std::in_place, *v++);
+            } else {
+                for (std::size_t k = 0; k != n; ++k) {
+                    if ((w >> k) & 1)
+                        dst[base + k] = expected<T, E>(std::in_place, *v++);
+                    else
+                        dst[base + k] = expected<T, E>(unexpect, *e++);
+                }
+            }
+        }
+    }
+
+private:
+    template <class U, class G>
+        requires detail::column_payloads<U, G>
+    friend expected<columns_view<U, G>, encoding_errc>
+    view_columns(std::span<const std::byte> in);
+
+    columns_view(const std::byte* bitmap, std::size_t count,
+                 std::span<const T> values, std::span<const E> errors) noexcept
+        : bitmap_(bitmap), count_(count), values_(values), errors_(errors) {}
+
+    std::uint64_t word(std::size_t k) const noexcept {
+        return detail::load<std::uint64_t>(bitmap_ + 8 * k);
+    }
+
+    const std::byte* bitmap_;
+    std::size_t count_;
+    std::span<const T> values_;
+    std::span<const E> errors_;
+};
+
+template <class T, class E>
+    requires detail::column_payloads<T, E>
+expected<columns_view<T, E>, encoding_errc>
+view_columns(std::span<const std::byte> in) {
+    if (in.size() < detail::columns_header_size)
+        return unexpected(encoding_errc::truncated);
+    const std::byte* p = in.data();
+    if (detail::load<std::uint32_t>(p) != detail::columns_magic ||
+        detail::load<std::uint32_t>(p + 4) != detail::columns_version ||
+        detail::load<std::uint32_t>(p + 8) != sizeof(T) ||
+        detail::load<std::uint32_t>(p + 12) != sizeof(E))
+        return unexpected(encoding_errc::bad_header);
+
+    // The counts are checked against the size of the input before the
+    // layout is computed from them, so that it cannot overflow.
+    const std::uint64_t count = detail::load<std::uint64_t>(p + 16);
+    const std::uint64_t values = detail::load<std::uint64_t>(p + 24);
+    if (values > count)
+        return unexpected(encoding_errc::bad_header);
+    if (count > in.size())
+        return unexpected(encoding_errc::truncated);
+    const auto l = detail::layout_columns<T, E>(count, values);
+    if (in.size() < l.size)
+        return unexpected(encoding_errc::truncated);
+    if (!detail::is_aligned(p, detail::column_alignment<T, E>))
+        return unexpected(encoding_errc::misaligned);
+
+    // Counting the bits shows that the columns are as long as decode()
+    // needs; a stray bit past count would throw the count off.
+    const std::byte* bitmap = p + detail::columns_header_size;
+    const std::size_t words =
+        (count + detail::column_word_bits - 1) / detail::column_word_bits;
+    std::size_t set = 0;
+    for (std::size_t k = 0; k != words; ++k)
+        set += static_cast<std::size_t>(
+            std::popcount(detail::load<std::uint64_t>(bitmap + 8 * k)));
+    if (count % detail::column_word_bits != 0) {
+        const std::uint64_t last = detail::load<std::uint64_t>(
+            bitmap + 8 * (words - 1));
+        if (last >> (count % detail::column_word_bits) != 0)
+            return unexpected(encoding_errc::bad_header);
+    }
+    if (set != values)
+        return unexpected(encoding_errc::bad_header);
+
+    return columns_view<T, E>(
+        bitmap, count,
+        std::span<const T>(detail::objects_at<T>(p + l.values, values),
+                           values),
+        std::span<const E>(detail::objects_at<E>(p + l.errors, count - values),
+                           count - values));
+}
+
+} // namespace bst
+
+
+
+#endif
@@ -0,0 +1,294 @@
+#ifndef BST_EXPECTED_TRACE_HPP_
+#define BST_EXPECTED_TRACE_HPP_
+
+//
+// Errors that remember where they were created.
+//
+
+/*
+Overview
+========
+
+namespace bst {
+
+template <class E>
+class traced {
+public:
+    using error_type = E;
+
+    traced(const E&, std::source_location = std::source_location::current());
+    traced(E&&, std::source_location = std::source_location::current());
+
+    const E& get() const& noexcept;
+    E& get() & noexcept;
+    E&& get() && noexcept;
+    const E& operator*() const noexcept;
+    E& operator*() noexcept;
+    const E* operator->() const noexcept;
+    E* operator->() noexcept;
+
+    const std::source_location& where() const noexcept;
+    std::span<void* const> backtrace() const noexcept;
+
+    friend bool operator==(const traced&, const traced&);
+    template <class E2>
+        friend bool operator==(const traced&, const E2&);
+};
+
+template <class E>
+    unexpected<traced<std::decay_t<E>>>
+    unexpected_traced(E&& e,
+                      std::source_location = std::source_location::current());
+
+void enable_error_backtraces(bool on) noexcept;
+bool error_backtraces_enabled() noexcept;
+
+std::vector<std::string> symbolize(std::span<void* const> frames);
+
+} // namespace bst
+
+*/
+
+
+#include <expected/expected.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <source_location>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if __has_include(<execinfo.h>)
+#include <execinfo.h>
+#define BST_EXPECTED_HAS_EXECINFO
+#endif
+
+// Return addresses kept per backtrace, and backtraces kept per thread.
+#ifndef BST_EXPECTED_TRACE_DEPTH
+#define BST_EXPECTED_TRACE_DEPTH 16
+#endif
+
+#ifndef BST_EXPECTED_TRACE_RING_SIZE
+#define BST_EXPECTED_TRACE_RING_SIZE 64
+#endif
+
+
+namespace bst {
+
+//
+// Backtrace capture
+//
+// Capturing is off by default. When it is on, each traced error records the
+// return addresses of its callers into a ring buffer owned by the creating
+// thread, and keeps only a 64-bit id of the slot. Nothing is allocated; a
+// slot is reused once BST_EXPECTED_TRACE_RING_SIZE later errors have been
+// traced on the same thread, after which the older error has no backtrace.
+// A backtrace can only be read on the thread that captured it.
+//
+
+namespace detail {
+inline std::atomic<bool> backtraces_on{false};
+inline std::atomic<std::uint32_t> next_trace_thread{1};
+
+struct trace_slot {
+    std::uint64_t id;
+    std::uint32_t depth;
+    void* frames[BST_EXPECTED_TRACE_DEPTH];
+};
+
+// Zero-initialized, so that reaching it costs no thread_local guard.
+struct trace_ring {
+    std::uint32_t thread;
+    std::uint32_t next;
+    trace_slot slots[BST_EXPECTED_TRACE_RING_SIZE];
+};
+
+inline thread_local constinit trace_ring this_thread_traces{};
+
+// Records the callers of the function that called it and returns the id of
+// the slot.
+BST_EXPECTED_COLD inline std::uint64_t record_backtrace() noexcept {
+    auto& ring = this_thread_traces;
+    if (ring.thread == 0)
+        ring.thread =
+            next_trace_thread.fetch_add(1, std::memory_order_relaxed);
+    if (++ring.next == 0)
+        ring.next = 1;
+    const std::uint64_t id =
+        (std::uint64_t{ring.thread} << 32) | std::uint64_t{ring.next};
+    auto& slot = ring.slots[ring.next % BST_EXPECTED_TRACE_RING_SIZE];
+
+#if defined(BST_EXPECTED_HAS_EXECINFO)
+    // One more frame than kept, as the first is this function.
+    void* frames[BST_EXPECTED_TRACE_DEPTH + 1];
+    const int n = ::backtrace(frames, BST_EXPECTED_TRACE_DEPTH + 1);
+    slot.depth = n > 1 ? static_cast<std::uint32_t>(n - 1) : 0;
+    for (std::uint32_t i = 0; i < slot.depth; ++i)
+        slot.frames[i] = frames[i + 1];
+#elif defined(__GNUC__) || defined(__clang__)
+    slot.frames[0] = __builtin_return_address(0);
+    slot.depth = 1;
+#else
+    slot.depth = 0;
+#endif
+    slot.id = id;
+    return id;
+}
+
+// The id of a new backtrace of the caller, or zero if capturing is off.
+inline std::uint64_t capture_backtrace() noexcept {
+    if (!backtraces_on.load(std::memory_order_relaxed))
+        return 0;
+    return record_backtrace();
+}
+
+inline std::span<void* const> find_backtrace(std::uint64_t id) noexcept {
+    const auto& ring = this_thread_traces;
+    if (id == 0 || (id >> 32) != ring.thread)
+        return {};
+    const auto& slot =
+        ring.slots[(id & 0xffffffffu) % BST_EXPECTED_TRACE_RING_SIZE];
+    if (slot.id != id)
+        return {};
+    return {slot.frames, slot.depth};
+}
+} // namespace detail
+
+inline void enable_error_backtraces(bool on) noexcept {
+#if defined(BST_EXPECTED_HAS_EXECINFO)
+    // The first backtrace() loads the unwinder, which allocates; do it now
+    // rather than when the first error is traced.
+    if (on) {
+        void* frame;
+        ::backtrace(&frame, 1);
+    }
+#endif
+    detail::backtraces_on.store(on, std::memory_order_relaxed);
+}
+
+inline bool error_backtraces_enabled() noexcept {
+    return detail::backtraces_on.load(std::memory_order_relaxed);
+}
+
+
+
+//
+// class traced<E>
+//
+// An error together with the source location it was created at, and, when
+// backtraces are enabled, the return addresses that led there. The location
+// is a pointer to static data, so it costs nothing to capture; it is the
+// point where the traced<E> is constructed, so errors should be built at the
+// failure site, with unexpected_traced or by constructing the traced<E>
+// explicitly, rather than converted later by expected's constructors.
+//
+
+template <class E>
+class traced {
+public:
+    using error_type = E;
+
+    traced(const E& e,
+           std::source_location where = std::source_location::current())
+        : error_(e), where_(where), trace_(detail::capture_backtrace()) {}
+
+    traced(E&& e,
+           std::source_location where = std::source_location::current())
+        : error_(std::move(e)), where_(where),
+          trace_(detail::capture_backtrace()) {}
+
+    const E& get() const& noexcept { return error_; }
+    E& get() & noexcept { return error_; }
+    E&& get() && noexcept { return std::move(error_); }
+    const E& operator*() const noexcept { return error_; }
+    E& operator*() noexcept { return error_; }
+    const E* operator->() const noexcept { return std::addressof(error_); }
+    E* operator->() noexcept { return std::addressof(error_); }
+
+    const std::source_location& where() const noexcept { return where_; }
+
+    // The callers of the creation site, innermost first. Empty if
+    // backtraces were disabled at creation, the slot has been reused since,
+    // or this is not the thread that created the error.
+    std::span<void* const> backtrace() const noexcept {
+        return detail::find_backtrace(trace_);
+    }
+
+    friend bool operator==(const traced& x, const traced& y) {
+        return x.error_ == y.error_;
+    }
+
+    template <class E2>
+        requires(!std::is_same_v<E2, traced>)
+    friend bool operator==(const traced& x, const E2& y) {
+        return x.error_ == y;
+    }
+
+private:
+    E error_;
+    std::source_location where_;
+    std::uint64_t trace_;
+};
+
+
+
+//
+// unexpected_traced
+//
+// Wraps an error in a traced<E> that records the caller's location, for
+// returning from a function whose result is expected<T, traced<E>>.
+//
+
+template <class E>
+unexpected<traced<std::decay_t<E>>>
+unexpected_traced(E&& e,
+                  std::source_location where = std::source_location::current()) {
+    return unexpected<traced<std::decay_t<E>>>(
+        std::in_place, std::forward<E>(e), where);
+}
+
+
+
+//
+// symbolize
+//
+// Names for the return addresses of a backtrace, one per frame. With
+// execinfo these are "module(function+offset) [address]"; function names
+// need the program to be linked with -rdynamic. Elsewhere they are the bare
+// addresses. Allocates, so it is meant for reporting, not the failure path.
+//
+
+inline std::vector<std::string> symbolize(std::span<void* const> frames) {
+    std::vector<std::string> names;
+    names.reserve(frames.size());
+#if defined(BST_EXPECTED_HAS_EXECINFO)
+    if (frames.empty())
+        return names;
+    char** symbols = ::backtrace_symbols(frames.data(),
+                                         static_cast<int>(frames.size()));
+    if (symbols) {
+        for (std::size_t i = 0; i < frames.size(); ++i)
+            names.emplace_back(symbols[i]);
+        std::free(symbols);
+        return names;
+    }
+#endif
+    for (void* frame : frames) {
+        char buf[2 + 2 * sizeof(void*) + 1];
+        std::snprintf(buf, sizeof buf, "%p", frame);
+        names.emplace_back(buf);
+    }
+    return names;
+}
+
+} // namespace bst
+
+
+
+#endif
@@ -0,0 +1,76 @@
+#ifndef BST_EXPECTED_TRY_HPP_
+#define BST_EXPECTED_TRY_HPP_
+
+//
+// Macros that return early from a function when an expected holds an error.
+//
+
+/*
+Overview
+========
+
+BST_TRY(expr)               // GCC and Clang: an expression yielding the value
+BST_TRY_ASSIGN(lhs, expr)   // everywhere: a statement, lhs = value
+
+*/
+
+
+#include <expected/expected.hpp>
+
+#include <utility>
+
+
+//
+// BST_TRY(expr)
+//
+// Evaluates expr, which must yield an expected. If it holds an error, the
+// enclosing function returns unexpected(error); otherwise the macro yields
+// the value, or nothing for expected<void, E>. When expr is an rvalue its
+// error is moved into the returned unexpected, and from there into the
+// function's result, so E is never copied on the way out:
+//
+//     bst::expected<config, parse_error> load(std::string_view path) {
+//         auto text = BST_TRY(read_file(path));
+//         return parse(BST_TRY(tokenize(text)));
+//     }
+//
+// BST_TRY relies on statement expressions, so it is only defined for GCC
+// and Clang, and cannot be used in a coroutine; use co_await there (see
+// coroutine.hpp).
+//
+// BST_TRY_ASSIGN(lhs, expr) does the same as a statement, assigning the
+// value to lhs, which may be a declaration. It works with every compiler,
+// but must appear where a declaration can:
+//
+//     BST_TRY_ASSIGN(auto text, read_file(path));
+//
+
+#if defined(__GNUC__) || defined(__clang__)
+#define BST_TRY(...)                                                           \
+    __extension__({                                                            \
+        auto&& bst_try_result_ = (__VA_ARGS__);                                \
+        if (!bst_try_result_.has_value()) [[unlikely]]                         \
+            return ::bst::unexpected(                                          \
+                std::forward<decltype(bst_try_result_)>(bst_try_result_)       \
+                    .error());                                                 \
+        *std::forward<decltype(bst_try_result_)>(bst_try_result_);             \
+    })
+#endif
+
+#define BST_EXPECTED_CONCAT_IMPL(a, b) a##b
+#define BST_EXPECTED_CONCAT(a, b) BST_EXPECTED_CONCAT_IMPL(a, b)
+
+#define BST_TRY_ASSIGN(lhs, ...)                                               \
+    BST_TRY_ASSIGN_IMPL(BST_EXPECTED_CONCAT(bst_try_result_, __LINE__), lhs,   \
+                        __VA_ARGS__)
+
+#define BST_TRY_ASSIGN_IMPL(result, lhs, ...)                                  \
+    auto&& result = (__VA_ARGS__);                                             \
+    if (!result.has_value()) [[unlikely]]                                      \
+        return ::bst::unexpected(                                              \
+            std::forward<decltype(result)>(result).error());                   \
+    lhs = *std::forward<decltype(result)>(result)
+
+
+
+#endif
@@ -0,0 +1,389 @@
+#ifndef BST_EXPECTED_VALIDATED_HPP_
+#define BST_EXPECTED_VALIDATED_HPP_
+
+//
+// Results that carry every error found, not only the first.
+//
+
+/*
+Overview
+========
+
+namespace bst {
+
+template <class E, std::size_t N = 4>
+class error_list {
+public:
+    using value_type = E;
+    using size_type = std::size_t;
+    using iterator = E*;
+    using const_iterator = const E*;
+
+    error_list() noexcept;
+    explicit error_list(const E&);
+    explicit error_list(E&&);
+    error_list(const error_list&);
+    error_list(error_list&&) noexcept;
+    error_list& operator=(const error_list&);
+    error_list& operator=(error_list&&) noexcept;
+    ~error_list();
+
+    template <class... Args>
+        E& emplace_back(Args&&...);
+    void push_back(const E&);
+    void push_back(E&&);
+    template <std::size_t M>
+        void append(const error_list<E, M>&);
+    template <std::size_t M>
+        void append(error_list<E, M>&&);
+    void clear() noexcept;
+
+    size_type size() const noexcept;
+    bool empty() const noexcept;
+    size_type capacity() const noexcept;
+    bool is_inline() const noexcept;    // not spilled to the heap
+
+    E* data() noexcept;                 // also const
+    iterator begin() noexcept;          // also const, cbegin
+    iterator end() noexcept;            // also const, cend
+    E& operator[](size_type) noexcept;  // also const
+    E& front() noexcept;                // also const
+    E& back() noexcept;                 // also const
+
+    template <std::size_t M>
+        friend bool operator==(const error_list&, const error_list<E, M>&);
+};
+
+template <class T, class E, std::size_t N = 4>
+    using validated = expected<T, error_list<E, N>>;
+
+template <class T, std::size_t N = 4, class... Xs>
+    validated<T, E, N> combine(Xs&&... xs);
+template <std::size_t N = 4, class F, class... Xs>
+    validated<std::invoke_result_t<F, U...>, E, N> zip(F&& f, Xs&&... xs);
+
+} // namespace bst
+
+where each of xs is an expected<U, E> or a validated<U, E, M>.
+
+*/
+
+
+#include <expected/expected.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+
+namespace bst {
+
+//
+// class error_list<E, N>
+//
+// A sequence of errors that keeps the first N inline and moves to the heap
+// only when more are added, so that collecting the handful of errors a
+// record usually has does not allocate. The elements are contiguous either
+// way.
+//
+
+template <class E, std::size_t N = 4>
+    requires(N > 0 && std::is_nothrow_move_constructible_v<E>)
+class error_list {
+public:
+    using value_type = E;
+    using size_type = std::size_t;
+    using reference = E&;
+    using const_reference = const E&;
+    using iterator = E*;
+    using const_iterator = const E*;
+
+    error_list() noexcept {}
+
+    explicit error_list(const E& e) { emplace_back(e); }
+    explicit error_list(E&& e) { emplace_back(std::move(e)); }
+
+    // The destructor does not run if a copy throws, so the elements already
+    // copied, and the buffer, are released here.
+    error_list(const error_list& rhs) {
+        BST_EXPECTED_TRY {
+            append(rhs);
+        } BST_EXPECTED_CATCH_ALL {
+            release();
+            BST_EXPECTED_RETHROW;
+        }
+    }
+
+    error_list(error_list&& rhs) noexcept { take(std::move(rhs)); }
+
+    error_list& operator=(const error_list& rhs) {
+        if (this != &rhs) {
+            error_list tmp(rhs);
+            release();
+            take(std::move(tmp));
+        }
+        return *this;
+    }
+
+    error_list& operator=(error_list&& rhs) noexcept {
+        if (this != &rhs) {
+            release();
+            take(std::move(rhs));
+        }
+        return *this;
+    }
+
+    ~error_list() { release(); }
+
+    //
+    // Modifiers
+    //
+
+    template <class... Args>
+    E& emplace_back(Args&&... args) {
+        if (size_ == capacity_) [[unlikely]]
+            return grow_and_emplace(std::forward<Args>(args)...);
+        E* e = std::construct_at(data_ + size_, std::forward<Args>(args)...);
+        ++size_;
+        return *e;
+    }
+
+    void push_back(const E& e) { emplace_back(e); }
+    void push_back(E&& e) { emplace_back(std::move(e)); }
+
+    template <std::size_t M>
+    void append(const error_list<E, M>& rhs) {
+        reserve(size_ + rhs.size());
+        for (const E& e : rhs)
+            emplace_back(e);
+    }
+
+    template <std::size_t M>
+    void append(error_list<E, M>&& rhs) {
+        reserve(size_ + rhs.size());
+        for (E& e : rhs)
+            emplace_back(std::move(e));
+    }
+
+    void clear() noexcept {
+        std::destroy_n(data_, size_);
+        size_ = 0;
+    }
+
+    void reserve(size_type n) {
+        if (n > capacity_)
+            reallocate(n);
+    }
+
+    //
+    // Access
+    //
+
+    size_type size() const noexcept { return size_; }
+    bool empty() const noexcept { return size_ == 0; }
+    size_type capacity() const noexcept { return capacity_; }
+    bool is_inline() const noexcept { return data_ == inline_data(); }
+
+    E* data() noexcept { return data_; }
+    const E* data() const noexcept { return data_; }
+
+    iterator begin() noexcept { return data_; }
+    const_iterator begin() const noexcept { return data_; }
+    const_iterator cbegin() const noexcept { return data_; }
+    iterator end() noexcept { return data_ + size_; }
+    const_iterator end() const noexcept { return data_ + size_; }
+    const_iterator cend() const noexcept { return data_ + size_; }
+
+    E& operator[](size_type i) noexcept { return data_[i]; }
+    const E& operator[](size_type i) const noexcept { return data_[i]; }
+    E& front() noexcept { return data_[0]; }
+    const E& front() const noexcept { return data_[0]; }
+    E& back() noexcept { return data_[size_ - 1]; }
+    const E& back() const noexcept { return data_[size_ - 1]; }
+
+    template <std::size_t M>
+    friend bool operator==(const error_list& x, const error_list<E, M>& y) {
+        return std::equal(x.begin(), x.end(), y.begin(), y.end());
+    }
+
+private:
+    E* data_ = inline_data();
+    size_type size_ = 0;
+    size_type capacity_ = N;
+    union {
+        E inline_[N];
+    };
+
+    E* inline_data() noexcept { return inline_; }
+    const E* inline_data() const noexcept { return inline_; }
+
+    // Moves the first n elements of from, which ends up empty, to to.
+    static void relocate(E* from, size_type n, E* to) noexcept {
+        std::uninitialized_move_n(from, n, to);
+        std::destroy_n(from, n);
+    }
+
+    void adopt(E* data, size_type capacity) noexcept {
+        relocate(data_, size_, data);
+        if (!is_inline())
+            std::allocator<E>().deallocate(data_, capacity_);
+        data_ = data;
+        capacity_ = capacity;
+    }
+
+    void reallocate(size_type capacity) {
+        adopt(std::allocator<E>().allocate(capacity), capacity);
+    }
+
+    // The new element is built before the old ones move, as args may refer
+    // to one of them. Left to the inliner rather than kept out of line: a
+    // call here would make callers keep the argument in memory.
+    template <class... Args>
+    E& grow_and_emplace(Args&&... args) {
+        const size_type capacity = 2 * capacity_;
+        E* data = std::allocator<E>().allocate(capacity);
+        BST_EXPECTED_TRY {
+            std::construct_at(data + size_, std::forward<Args>(args)...);
+        } BST_EXPECTED_CATCH_ALL {
+            std::allocator<E>().deallocate(data, capacity);
+            BST_EXPECTED_RETHROW;
+        }
+        adopt(data, capacity);
+        return data_[size_++];
+    }
+
+    // Takes over rhs's elements, or its heap buffer, leaving it empty. This
+    // object holds no elements.
+    void take(error_list&& rhs) noexcept {
+        if (rhs.is_inline()) {
+            relocate(rhs.data_, rhs.size_, data_);
+        } else {
+            data_ = rhs.data_;
+            capacity_ = rhs.capacity_;
+            rhs.data_ = rhs.inline_data();
+            rhs.capacity_ = N;
+        }
+        size_ = rhs.size_;
+        rhs.size_ = 0;
+    }
+
+    void release() noexcept {
+        clear();
+        if (!is_inline())
+            std::allocator<E>().deallocate(data_, capacity_);
+        data_ = inline_data();
+        capacity_ = N;
+    }
+};
+
+template <class T, class E, std::size_t N = 4>
+using validated = expected<T, error_list<E, N>>;
+
+
+
+//
+// combine, zip
+//
+// Applicative combination of independent results: every input is looked at,
+// and the result holds either a value built from all of their values or the
+// errors of all the inputs that failed, in order. An input is an
+// expected<U, E>, contributing one error, or a validated<U, E, M>,
+// contributing all of its own.
+//
+// combine<T>(xs...) constructs T in place from the values, and zip(f, xs...)
+// holds the result of f called on them; neither builds anything when an
+// input has failed. Each input is moved from when passed as an rvalue.
+//
+
+namespace detail {
+template <class G>
+struct error_of_input {
+    using type = G;
+};
+
+template <class G, std::size_t M>
+struct error_of_input<error_list<G, M>> {
+    using type = G;
+};
+
+template <class X>
+using input_error_t = typename error_of_input<
+    typename std::remove_cvref_t<X>::error_type>::type;
+
+template <class X>
+concept validation_input =
+    is_expected<std::remove_cvref_t<X>>::value &&
+    !std::is_void_v<typename std::remove_cvref_t<X>::value_type>;
+
+template <class X, class...>
+struct first_input {
+    using type = X;
+};
+
+// The error type of the inputs, all of which must agree.
+template <class... Xs>
+using combined_error_t = input_error_t<typename first_input<Xs...>::type>;
+
+template <class E, std::size_t N, class X>
+void collect_errors(error_list<E, N>& errors, X&& x) {
+    if (x.has_value())
+        return;
+    if constexpr (is_expected<std::remove_cvref_t<X>>::value &&
+                  std::is_same_v<typename std::remove_cvref_t<X>::error_type,
+                                 E>)
+        errors.push_back(std::forward<X>(x).error());
+    else
+        errors.append(std::forward<X>(x).error());
+}
+
+template <class R, class... Xs>
+BST_EXPECTED_COLD R combined_errors(Xs&&... xs) {
+    using list = typename R::error_type;
+    list errors;
+    (collect_errors(errors, std::forward<Xs>(xs)), ...);
+    return R(unexpect, std::move(errors));
+}
+} // namespace detail
+
+template <class T, std::size_t N = 4, detail::validation_input... Xs>
+    requires(sizeof...(Xs) > 0 &&
+             (std::is_same_v<detail::input_error_t<Xs>,
+                             detail::combined_error_t<Xs...>> &&
+              ...) &&
+             std::is_constructible_v<T, decltype(*std::declval<Xs>())...>)
+validated<T, detail::combined_error_t<Xs...>, N> combine(Xs&&... xs) {
+    using R = validated<T, detail::combined_error_t<Xs...>, N>;
+    if ((xs.has_value() && ...))
+        return R(std::in_place, *std::forward<Xs>(xs)...);
+    return detail::combined_errors<R>(std::forward<Xs>(xs)...);
+}
+
+template <std::size_t N = 4, class F, detail::validation_input... Xs>
+    requires(sizeof...(Xs) > 0 &&
+             (std::is_same_v<detail::input_error_t<Xs>,
+                             detail::combined_error_t<Xs...>> &&
+              ...) &&
+             std::is_invocable_v<F, decltype(*std::declval<Xs>())...>)
+auto zip(F&& f, Xs&&... xs) {
+    using U = std::remove_cvref_t<
+        std::invoke_result_t<F, decltype(*std::declval<Xs>())...>>;
+    using R = validated<U, detail::combined_error_t<Xs...>, N>;
+    if (!(xs.has_value() && ...))
+        return detail::combined_errors<R>(std::forward<Xs>(xs)...);
+    if constexpr (std::is_void_v<U>) {
+        std::invoke(std::forward<F>(f), *std::forward<Xs>(xs)...);
+        return R();
+    } else {
+        return R(std::in_place,
+                 std::invoke(std::forward<F>(f), *std::forward<Xs>(xs)...));
+    }
+}
+
+} // namespace bst
+
+
+
+#endif
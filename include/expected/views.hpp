@@ -0,0 +1,265 @@
+#ifndef BST_EXPECTED_VIEWS_HPP_
+#define BST_EXPECTED_VIEWS_HPP_
+
+//
+// Lazy range adaptors over ranges of expected values.
+//
+
+/*
+Overview
+========
+
+namespace bst::views {
+
+inline constexpr unspecified values;            // the values, skipping errors
+inline constexpr unspecified errors;            // the errors, skipping values
+inline constexpr unspecified take_until_error;  // the values before the first
+                                                // error
+unspecified and_then(F f);                      // x.and_then(f) for each x
+
+} // namespace bst::views
+
+Each is used with operator| or called on a range:
+
+    for (const record& r : parse(lines) | bst::views::values)
+        ...
+
+values, errors and take_until_error yield references to the payloads of the
+underlying expecteds when the range yields references to them, and copies
+when it yields expecteds by value. In that case each element is computed
+once, even though it is both tested and read, and the view is single-pass.
+
+*/
+
+
+#include <expected/expected.hpp>
+
+#include <functional>
+#include <iterator>
+#include <optional>
+#include <ranges>
+#include <type_traits>
+#include <utility>
+
+
+namespace bst::views {
+
+namespace detail {
+template <class R>
+using range_expected_t =
+    std::remove_cvref_t<std::ranges::range_reference_t<R>>;
+
+template <class R>
+concept expected_range =
+    std::ranges::viewable_range<R> && std::ranges::input_range<R> &&
+    bst::detail::is_expected<range_expected_t<R>>::value;
+
+// The payload of an element of type Ref: a reference into the element when
+// Ref is a reference, otherwise a copy, as the element is a temporary.
+template <class Ref>
+struct value_of {
+    constexpr decltype(auto) operator()(Ref x) const {
+        using V = typename std::remove_cvref_t<Ref>::value_type;
+        if constexpr (std::is_reference_v<Ref> || std::is_reference_v<V>)
+            return *std::forward<Ref>(x);
+        else
+            return V(*std::move(x));
+    }
+};
+
+template <class Ref>
+struct error_of {
+    constexpr decltype(auto) operator()(Ref x) const {
+        using G = typename std::remove_cvref_t<Ref>::error_type;
+        if constexpr (std::is_reference_v<Ref>)
+            return std::forward<Ref>(x).error();
+        else
+            return G(std::move(x).error());
+    }
+};
+
+struct has_value {
+    template <class X>
+    constexpr bool operator()(const X& x) const noexcept {
+        return x.has_value();
+    }
+};
+
+struct has_error {
+    template <class X>
+    constexpr bool operator()(const X& x) const noexcept {
+        return !x.has_value();
+    }
+};
+
+// A range adaptor closure: r | adaptor and adaptor(r) both give make(r).
+template <class Make>
+struct adaptor {
+    Make make;
+
+    template <expected_range R>
+    constexpr auto operator()(R&& r) const {
+        return make(std::forward<R>(r));
+    }
+
+    template <expected_range R>
+    friend constexpr auto operator|(R&& r, const adaptor& a) {
+        return a.make(std::forward<R>(r));
+    }
+};
+
+template <class Make>
+adaptor(Make) -> adaptor<Make>;
+
+// A view of V that keeps its current element, for ranges that compute their
+// elements on dereference: filter and take_while read each element once to
+// test it and again to yield it, so a transform below them would run twice.
+// The element is yielded as an rvalue, to be moved from once it has passed
+// the test.
+template <std::ranges::input_range V>
+    requires std::ranges::view<V>
+class cache_latest_view
+    : public std::ranges::view_interface<cache_latest_view<V>> {
+    using element = std::ranges::range_reference_t<V>;
+
+    // Copying or moving the view does not carry the cached element along.
+    struct cache {
+        std::optional<element> x;
+
+        cache() = default;
+        cache(const cache&) noexcept {}
+        cache& operator=(const cache&) noexcept {
+            x.reset();
+            return *this;
+        }
+    };
+
+    class iterator {
+    public:
+        using iterator_concept = std::input_iterator_tag;
+        using value_type = std::remove_cvref_t<element>;
+        using difference_type = std::ranges::range_difference_t<V>;
+
+        iterator() = default;
+        iterator(cache_latest_view* parent, std::ranges::iterator_t<V> it)
+            : parent_(parent), it_(std::move(it)) {}
+
+        iterator(iterator&&) = default;
+        iterator& operator=(iterator&&) = default;
+
+        element&& operator*() const {
+            auto& c = parent_->cache_.x;
+            if (!c)
+                c.emplace(*it_);
+            return std::move(*c);
+        }
+
+        iterator& operator++() {
+            parent_->cache_.x.reset();
+            ++it_;
+            return *this;
+        }
+        void operator++(int) { ++*this; }
+
+        friend bool operator==(const iterator& i,
+                               const std::ranges::sentinel_t<V>& s) {
+            return i.it_ == s;
+        }
+
+    private:
+        cache_latest_view* parent_ = nullptr;
+        std::ranges::iterator_t<V> it_{};
+    };
+
+public:
+    cache_latest_view() = default;
+    constexpr explicit cache_latest_view(V base) : base_(std::move(base)) {}
+
+    iterator begin() {
+        cache_.x.reset();
+        return iterator(this, std::ranges::begin(base_));
+    }
+    auto end() { return std::ranges::end(base_); }
+
+private:
+    V base_{};
+    cache cache_;
+};
+
+template <class R>
+cache_latest_view(R&&) -> cache_latest_view<std::views::all_t<R>>;
+
+// r as a view whose elements can be tested and then read for the cost of
+// computing them once.
+template <class R>
+constexpr auto read_once(R&& r) {
+    if constexpr (std::is_reference_v<std::ranges::range_reference_t<R>>)
+        return std::views::all(std::forward<R>(r));
+    else
+        return cache_latest_view(std::forward<R>(r));
+}
+} // namespace detail
+
+
+
+//
+// values, errors
+//
+// The values, or the errors, of a range of expecteds, skipping the other
+// alternative.
+//
+
+inline constexpr detail::adaptor values{[]<class R>(R&& r) {
+    return std::views::filter(detail::read_once(std::forward<R>(r)),
+                              detail::has_value{}) |
+           std::views::transform(
+               detail::value_of<std::ranges::range_reference_t<R>>{});
+}};
+
+inline constexpr detail::adaptor errors{[]<class R>(R&& r) {
+    return std::views::filter(detail::read_once(std::forward<R>(r)),
+                              detail::has_error{}) |
+           std::views::transform(
+               detail::error_of<std::ranges::range_reference_t<R>>{});
+}};
+
+
+
+//
+// take_until_error
+//
+// The values of a range of expecteds up to its first error, which ends the
+// view. Elements after the error are never read.
+//
+
+inline constexpr detail::adaptor take_until_error{[]<class R>(R&& r) {
+    return std::views::take_while(detail::read_once(std::forward<R>(r)),
+                                  detail::has_value{}) |
+           std::views::transform(
+               detail::value_of<std::ranges::range_reference_t<R>>{});
+}};
+
+
+
+//
+// and_then
+//
+// Applies x.and_then(f) to each element x, giving a range of the resulting
+// expecteds; f runs only for elements holding a value.
+//
+
+template <class F>
+constexpr auto and_then(F f) {
+    return detail::adaptor{[f = std::move(f)]<class R>(R&& r) {
+        return std::views::transform(
+            std::forward<R>(r), [f]<class X>(X&& x) {
+                return std::forward<X>(x).and_then(f);
+            });
+    }};
+}
+
+} // namespace bst::views
+
+
+
+#endif
@@ -0,0 +1,127 @@
+//
+// The headers as a C++20 module: import bst.expected; makes every public
+// name of include/expected available without reparsing the headers in each
+// translation unit that uses them.
+//
+// The headers are included into the global module fragment and their names
+// re-exported, so a translation unit may import the module and include a
+// header as well. Macros are not exported: the BST_TRY family still needs
+// #include <expected/try.hpp>, and the configuration macros
+// (BST_EXPECTED_NO_EXCEPTIONS, BST_EXPECTED_INSTRUMENT) must be defined when
+// the module is built.
+//
+// algorithm.hpp is left out: its parallel overloads bring in <execution>,
+// whose backend (TBB with libstdc++) every user of the module would then have
+// to link. Include <expected/algorithm.hpp> alongside the import instead.
+//
+
+module;
+
+#include <expected/coroutine.hpp>
+#include <expected/error.hpp>
+#include <expected/expected.hpp>
+#include <expected/expected_array.hpp>
+#if __has_include(<sys/mman.h>)
+#include <expected/expected_log.hpp>
+#endif
+#include <expected/expected_slot.hpp>
+#include <expected/lazy_error.hpp>
+#include <expected/pmr.hpp>
+#include <expected/relocate.hpp>
+#include <expected/serialize.hpp>
+#include <expected/trace.hpp>
+#include <expected/validated.hpp>
+#include <expected/views.hpp>
+
+export module bst.expected;
+
+export namespace bst {
+
+// expected.hpp
+using bst::bad_expected_access;
+using bst::bad_expected_access_handler;
+using bst::enum_niche_traits;
+using bst::expected;
+using bst::expected_niche_traits;
+using bst::get_bad_expected_access_handler;
+using bst::pointer_niche_traits;
+using bst::set_bad_expected_access_handler;
+using bst::unexpect;
+using bst::unexpect_t;
+using bst::unexpected;
+
+#ifdef BST_EXPECTED_INSTRUMENT
+using bst::expected_counters;
+using bst::for_each_expected_counters;
+using bst::reset_expected_counters;
+using bst::write_expected_counters_json;
+#endif
+
+// error.hpp
+using bst::error;
+using bst::error_domain;
+using bst::generic_domain;
+
+// expected_array.hpp
+using bst::expected_array;
+
+#if __has_include(<sys/mman.h>)
+// expected_log.hpp
+using bst::expected_log;
+using bst::log_mode;
+#endif
+
+// expected_slot.hpp
+using bst::expected_slot;
+using bst::slot_state;
+
+// lazy_error.hpp
+using bst::lazy_error;
+using bst::unexpected_lazy;
+
+// relocate.hpp
+using bst::is_trivially_relocatable;
+using bst::is_trivially_relocatable_v;
+using bst::relocate_n;
+using bst::relocating_vector;
+using bst::uninitialized_relocate;
+
+// serialize.hpp
+using bst::columns_view;
+using bst::decode;
+using bst::encode;
+using bst::encode_columns;
+using bst::encoded_columns_size;
+using bst::encoded_size;
+using bst::encoding_errc;
+using bst::expected_view;
+using bst::record_size;
+using bst::serializer;
+using bst::view_columns;
+using bst::view_record;
+
+// trace.hpp
+using bst::enable_error_backtraces;
+using bst::error_backtraces_enabled;
+using bst::symbolize;
+using bst::traced;
+using bst::unexpected_traced;
+
+// validated.hpp
+using bst::combine;
+using bst::error_list;
+using bst::validated;
+using bst::zip;
+
+namespace pmr {
+using bst::pmr::expected;
+} // namespace pmr
+
+namespace views {
+using bst::views::and_then;
+using bst::views::errors;
+using bst::views::take_until_error;
+using bst::views::values;
+} // namespace views
+
+} // namespace bst
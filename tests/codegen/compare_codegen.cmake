@@ -0,0 +1,120 @@
+#
+# Compares the code generated for two functions in an assembly listing.
+#
+# Usage: cmake -DASM=<file.s> -DLHS=<symbol> -DRHS=<symbol> -P compare_codegen.cmake
+#
+# Both functions are reduced to their stream of mnemonics. Conditional jumps
+# become "jcc" and unconditional jumps are dropped, because the optimizer is
+# free to lay the blocks out differently: it may test a result with je or with
+# jne depending on which side falls through. Then we require that
+#   - both functions make exactly the same sequence of calls, i.e. nothing from
+#     expected.hpp was left out of line,
+#   - both test the same number of conditions, i.e. no intermediate expected
+#     is materialized and tested again, and
+#   - whatever LHS has beyond RHS is at most one more copy of RHS's return
+#     block and one register move.
+#
+# That last allowance is the one difference seen in practice. Where RHS jumps
+# to a shared exit, GCC copies the exit (packing the result into registers
+# and returning) into the end of LHS's success path. That trades a jump for
+# a few bytes and does no extra work on either path. Anything else LHS
+# does, such as a spill, a store of a temporary or an extra test, fails.
+#
+
+file(STRINGS ${ASM} lines)
+
+function(extract_function name out_insns out_calls out_branches out_exit)
+  set(inside FALSE)
+  set(insns "")
+  set(calls "")
+  set(branches 0)
+  set(block "")
+  set(exit "")
+  foreach(line IN LISTS lines)
+    if(line MATCHES "^_?${name}:")
+      set(inside TRUE)
+    elseif(inside AND line MATCHES "^[A-Za-z_][A-Za-z0-9_$]*:")
+      break()
+    elseif(inside AND line MATCHES "^\\.?L[A-Za-z0-9_$]*:")
+      set(block "")
+    elseif(inside AND line MATCHES "^[ \t]+([a-z][a-z0-9.]*)")
+      set(op ${CMAKE_MATCH_1})
+      if(op STREQUAL "jmp" OR op STREQUAL "b")
+        continue()
+      endif()
+      if(op MATCHES "^j[a-z]+$" OR op MATCHES "^(b\\.[a-z]+|cbn?z|tbn?z)$")
+        set(op jcc)
+        math(EXPR branches "${branches} + 1")
+      endif()
+      if(line MATCHES "^[ \t]+(call|bl)[a-z]*[ \t]+([^ \t]+)")
+        list(APPEND calls ${CMAKE_MATCH_2})
+      endif()
+      list(APPEND insns ${op})
+      list(APPEND block ${op})
+      if(op STREQUAL "ret")
+        set(exit "${block}")
+      endif()
+    endif()
+  endforeach()
+  if(NOT insns)
+    message(FATAL_ERROR "function ${name} not found in ${ASM}")
+  endif()
+  set(${out_insns} "${insns}" PARENT_SCOPE)
+  set(${out_calls} "${calls}" PARENT_SCOPE)
+  set(${out_branches} ${branches} PARENT_SCOPE)
+  set(${out_exit} "${exit}" PARENT_SCOPE)
+endfunction()
+
+# Removes one occurrence of each element of `items` from the list `var`;
+# those that are not found are left in `missing`.
+function(remove_each var items missing)
+  set(from "${${var}}")
+  set(left "")
+  foreach(item IN LISTS items)
+    list(FIND from ${item} i)
+    if(i EQUAL -1)
+      list(APPEND left ${item})
+    else()
+      list(REMOVE_AT from ${i})
+    endif()
+  endforeach()
+  set(${var} "${from}" PARENT_SCOPE)
+  set(${missing} "${left}" PARENT_SCOPE)
+endfunction()
+
+extract_function(${LHS} lhs_insns lhs_calls lhs_branches lhs_exit)
+extract_function(${RHS} rhs_insns rhs_calls rhs_branches rhs_exit)
+
+list(LENGTH lhs_insns lhs_count)
+list(LENGTH rhs_insns rhs_count)
+message(STATUS "${LHS}: ${lhs_count} instructions, calls: ${lhs_calls}")
+message(STATUS "${RHS}: ${rhs_count} instructions, calls: ${rhs_calls}")
+
+if(NOT lhs_calls STREQUAL rhs_calls)
+  message(FATAL_ERROR "${LHS} and ${RHS} make different calls")
+endif()
+
+if(NOT lhs_branches EQUAL rhs_branches)
+  message(FATAL_ERROR "${LHS} tests ${lhs_branches} conditions, "
+                      "${RHS} tests ${rhs_branches}")
+endif()
+
+# What LHS does beyond RHS.
+set(extra "${lhs_insns}")
+remove_each(extra "${rhs_insns}" unused)
+# Less one copy of the return block, and one register move.
+remove_each(extra "${rhs_exit}" unused)
+list(FIND extra movl i)
+if(i EQUAL -1)
+  list(FIND extra movq i)
+endif()
+if(i EQUAL -1)
+  list(FIND extra mov i)
+endif()
+if(NOT i EQUAL -1)
+  list(REMOVE_AT extra ${i})
+endif()
+
+if(extra)
+  message(FATAL_ERROR "${LHS} has instructions ${RHS} does not: ${extra}")
+endif()
@@ -0,0 +1,41 @@
+//
+// Codegen test for the monadic interface.
+//
+// chained() and hand_written() implement the same five stage pipeline, once
+// with and_then/transform and once with explicit branches. The stages are
+// only declared, so after optimization each function must consist of nothing
+// but the five calls and the has_value() tests between them. See
+// compare_codegen.cmake for the checks performed on the generated assembly.
+//
+
+#include <expected/expected.hpp>
+
+using result = bst::expected<int, int>;
+
+result parse(int x);
+result check_range(int x);
+int scale(int x);
+result check_even(int x);
+int offset(int x);
+
+extern "C" result chained(int x) {
+    return parse(x)
+        .and_then(check_range)
+        .transform(scale)
+        .and_then(check_even)
+        .transform(offset);
+}
+
+extern "C" result hand_written(int x) {
+    result a = parse(x);
+    if (!a)
+        return bst::unexpected(a.error());
+    result b = check_range(*a);
+    if (!b)
+        return bst::unexpected(b.error());
+    int c = scale(*b);
+    result d = check_even(c);
+    if (!d)
+        return bst::unexpected(d.error());
+    return offset(*d);
+}
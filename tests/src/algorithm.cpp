@@ -0,0 +1,247 @@
+#include <expected/algorithm.hpp>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <execution>
+#include <list>
+#include <memory>
+#include <numeric>
+#include <span>
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------------
+
+namespace {
+
+using result = bst::expected<int, std::string>;
+
+result check(int x) {
+    if (x < 0)
+        return bst::unexpected("negative " + std::to_string(x));
+    return x * 2;
+}
+
+} // namespace
+
+//------------------------------------------------------------------------------
+// collect
+
+TEST(CollectTests, AllValues) {
+    const std::vector<result> v{1, 2, 3};
+    auto r = bst::collect(v);
+    ASSERT_TRUE(r.has_value());
+    EXPECT_EQ(*r, (std::vector<int>{1, 2, 3}));
+    EXPECT_EQ(r->capacity(), 3u);
+
+    EXPECT_EQ(bst::collect(std::vector<result>{})->size(), 0u);
+}
+
+TEST(CollectTests, FirstError) {
+    const std::list<result> v{1, bst::unexpected(std::string("a")), 3,
+                              bst::unexpected(std::string("b"))};
+    EXPECT_EQ(bst::collect(v).error(), "a");
+}
+
+TEST(CollectTests, MovesFromRvalues) {
+    using E = bst::expected<std::unique_ptr<int>, int>;
+    std::vector<E> v;
+    v.emplace_back(std::make_unique<int>(1));
+    v.emplace_back(std::make_unique<int>(2));
+
+    auto r = bst::collect(std::move(v));
+    ASSERT_TRUE(r.has_value());
+    EXPECT_EQ(*(*r)[1], 2);
+}
+
+//------------------------------------------------------------------------------
+// traverse
+
+TEST(TraverseTests, Sequential) {
+    const std::vector<int> v{1, 2, 3};
+    EXPECT_EQ(bst::traverse(v, check).value(), (std::vector<int>{2, 4, 6}));
+
+    int calls = 0;
+    auto counted = [&](int x) {
+        ++calls;
+        return check(x);
+    };
+    EXPECT_EQ(bst::traverse(std::vector<int>{1, -2, -3, 4}, counted).error(),
+              "negative -2");
+    EXPECT_EQ(calls, 2);
+}
+
+TEST(TraverseTests, Policies) {
+    std::vector<int> v(1000);
+    std::iota(v.begin(), v.end(), 0);
+
+    auto seq = bst::traverse(std::execution::seq, v, check);
+    auto par = bst::traverse(std::execution::par, v, check);
+    auto unseq = bst::traverse(std::execution::par_unseq, v, check);
+    ASSERT_TRUE(par.has_value());
+    EXPECT_EQ(*seq, *par);
+    EXPECT_EQ(*seq, *unseq);
+    EXPECT_EQ((*par)[999], 1998);
+}
+
+TEST(TraverseTests, LowestIndexErrorWins) {
+    std::vector<int> v(1000);
+    std::iota(v.begin(), v.end(), 0);
+    v[700] = -700;
+    v[300] = -300;
+    v[900] = -900;
+
+    EXPECT_EQ(bst::traverse(std::execution::par, v, check).error(),
+              "negative -300");
+    EXPECT_EQ(bst::traverse(std::execution::seq, v, check).error(),
+              "negative -300");
+}
+
+TEST(TraverseTests, SkipsWorkAfterError) {
+    std::vector<int> v(1000);
+    std::iota(v.begin(), v.end(), 0);
+    v[0] = -1;
+
+    std::atomic<int> calls{0};
+    auto counted = [&](int x) {
+        calls.fetch_add(1, std::memory_order_relaxed);
+        return check(x);
+    };
+    EXPECT_EQ(bst::traverse(std::execution::seq, v, counted).error(),
+              "negative -1");
+    EXPECT_EQ(calls.load(), 1);
+}
+
+TEST(TraverseTests, ExceptionsPropagateUnderPolicy) {
+    std::vector<int> v(1000);
+    std::iota(v.begin(), v.end(), 0);
+    v[400] = -400;
+    auto throwing = [](int x) -> result {
+        if (x == 600 || x == 200)
+            throw x;
+        return check(x);
+    };
+
+    EXPECT_THROW(
+        try {
+            (void)bst::traverse(std::execution::par, v, throwing);
+        } catch (int x) {
+            EXPECT_EQ(x, 200);
+            throw;
+        },
+        int);
+    v[100] = -100;
+    EXPECT_EQ(bst::traverse(std::execution::par, v, throwing).error(),
+              "negative -100");
+}
+
+TEST(TraverseTests, NonDefaultConstructibleValues) {
+    struct boxed {
+        explicit boxed(int v) : v(v) {}
+        int v;
+    };
+    auto box = [](int x) -> bst::expected<boxed, int> {
+        if (x < 0)
+            return bst::unexpected(x);
+        return boxed(x);
+    };
+    const std::vector<int> v{4, 5, 6};
+
+    auto r = bst::traverse(std::execution::par, v, box);
+    ASSERT_TRUE(r.has_value());
+    EXPECT_EQ((*r)[2].v, 6);
+
+    auto flags = bst::traverse(std::execution::par, v,
+                               [](int x) -> bst::expected<bool, int> {
+                                   return x % 2 == 0;
+                               });
+    EXPECT_EQ(*flags, (std::vector<bool>{true, false, true}));
+}
+
+//------------------------------------------------------------------------------
+// values_or, select_values, errors_or
+
+namespace {
+
+enum class errc : short { bad = 1, worse };
+
+struct point {
+    double x, y, z;
+    friend bool operator==(const point&, const point&) = default;
+};
+
+struct node {
+    int v;
+};
+
+} // namespace
+
+// Pointers have a niche only when they opt in.
+template <>
+struct bst::expected_niche_traits<node*> : bst::pointer_niche_traits<node*> {};
+
+TEST(ValuesOrTests, TrivialPayloads) {
+    using E = bst::expected<int, errc>;
+    const std::vector<E> v{1, bst::unexpected(errc::bad), 3,
+                           bst::unexpected(errc::worse), 5};
+    std::vector<int> out(v.size());
+
+    EXPECT_EQ(bst::values_or(v, -1, out), 3u);
+    EXPECT_EQ(out, (std::vector<int>{1, -1, 3, -1, 5}));
+
+    const std::vector<int> fallbacks{10, 20, 30, 40, 50};
+    EXPECT_EQ(bst::select_values(std::span(v), fallbacks, std::span(out)), 3u);
+    EXPECT_EQ(out, (std::vector<int>{1, 20, 3, 40, 5}));
+
+    std::vector<errc> errors(v.size());
+    EXPECT_EQ(bst::errors_or(v, errc{}, errors), 2u);
+    EXPECT_EQ(errors, (std::vector<errc>{errc{}, errc::bad, errc{},
+                                         errc::worse, errc{}}));
+}
+
+TEST(ValuesOrTests, WidePayloads) {
+    using E = bst::expected<point, errc>;
+    const std::vector<E> v{point{1, 2, 3}, bst::unexpected(errc::bad)};
+    std::vector<point> out(2);
+
+    EXPECT_EQ(bst::values_or(v, point{0, 0, -1}, out), 1u);
+    EXPECT_EQ(out[0], (point{1, 2, 3}));
+    EXPECT_EQ(out[1], (point{0, 0, -1}));
+}
+
+TEST(ValuesOrTests, NichePayloads) {
+    node a{1}, b{2};
+    using E = bst::expected<node*, errc>;
+    static_assert(sizeof(E) == sizeof(node*));
+    const std::vector<E> v{&a, bst::unexpected(errc::bad), &b};
+    std::vector<node*> out(3);
+
+    EXPECT_EQ(bst::values_or(v, nullptr, out), 2u);
+    EXPECT_EQ(out, (std::vector<node*>{&a, nullptr, &b}));
+
+    std::vector<errc> errors(3);
+    EXPECT_EQ(bst::errors_or(v, errc{}, errors), 1u);
+    EXPECT_EQ(errors, (std::vector<errc>{errc{}, errc::bad, errc{}}));
+}
+
+TEST(ValuesOrTests, VoidValues) {
+    using E = bst::expected<void, errc>;
+    const std::vector<E> v{E(), bst::unexpected(errc::worse)};
+    std::vector<errc> out(2);
+
+    EXPECT_EQ(bst::errors_or(v, errc{}, out), 1u);
+    EXPECT_EQ(out[1], errc::worse);
+}
+
+TEST(ValuesOrTests, NonTrivialPayloads) {
+    const std::vector<result> v{check(1), check(-2), check(3)};
+    std::vector<int> out(3);
+    EXPECT_EQ(bst::values_or(v, 0, out), 2u);
+    EXPECT_EQ(out, (std::vector<int>{2, 0, 6}));
+
+    std::vector<std::string> errors(3);
+    EXPECT_EQ(bst::errors_or(v, std::string("ok"), errors), 1u);
+    EXPECT_EQ(errors,
+              (std::vector<std::string>{"ok", "negative -2", "ok"}));
+}
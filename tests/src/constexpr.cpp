@@ -0,0 +1,373 @@
+#include <expected/expected.hpp>
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+//------------------------------------------------------------------------------
+
+//
+// Compile-time tests. Every check below is a static_assert, so this file
+// only builds if the operations it uses can be evaluated in constant
+// expressions.
+//
+
+namespace {
+
+enum class errc { none, negative, too_large, odd };
+
+// Non-trivial alternatives, so that the user-provided special members and
+// the non-trivial assignment and swap paths are the ones evaluated.
+struct value {
+    constexpr value() noexcept : v(0) {}
+    constexpr explicit value(int v) noexcept : v(v) {}
+    constexpr value(const value& rhs) : v(rhs.v) {}
+    constexpr value(value&& rhs) noexcept : v(rhs.v) { rhs.v = -1; }
+    constexpr value& operator=(const value& rhs) {
+        v = rhs.v;
+        return *this;
+    }
+    constexpr value& operator=(value&& rhs) noexcept {
+        v = rhs.v;
+        rhs.v = -1;
+        return *this;
+    }
+    constexpr ~value() {}
+
+    friend constexpr bool operator==(const value&, const value&) = default;
+
+    int v;
+};
+
+// A move that may throw, which sends assignment through the rollback path of
+// reinit_expected.
+struct fragile {
+    constexpr explicit fragile(int v) noexcept : v(v) {}
+    constexpr fragile(const fragile& rhs) : v(rhs.v) {}
+    constexpr fragile(fragile&& rhs) noexcept(false) : v(rhs.v) {}
+    constexpr fragile& operator=(const fragile&) = default;
+    constexpr fragile& operator=(fragile&&) = default;
+    constexpr ~fragile() {}
+
+    int v;
+};
+
+// The same, assigned under the basic guarantee.
+struct tolerant : fragile {
+    using fragile::fragile;
+};
+
+// An error with a niche, so that expected<void, small_errc> is one byte.
+enum class small_errc : unsigned char { bad = 1, worse };
+
+} // namespace
+
+template <>
+struct bst::expected_basic_guarantee<tolerant, value> : std::true_type {};
+
+template <>
+struct bst::expected_niche_traits<small_errc>
+    : bst::enum_niche_traits<small_errc, small_errc(0)> {};
+
+namespace {
+
+using result = bst::expected<int, errc>;
+using status = bst::expected<void, errc>;
+
+//------------------------------------------------------------------------------
+// Construction and observers
+
+static_assert(result().value() == 0);
+static_assert(result(3).value() == 3);
+static_assert(*result(std::in_place, 4) == 4);
+static_assert(result(bst::unexpect, errc::odd).error() == errc::odd);
+static_assert(result(bst::unexpected(errc::odd)).error() == errc::odd);
+static_assert(!result(bst::unexpected(errc::odd)).has_value());
+static_assert(result(bst::unexpected(errc::odd)).value_or(9) == 9);
+static_assert(result(2).value_or(9) == 2);
+static_assert(bst::expected<long, errc>(result(5)).value() == 5);
+static_assert(status().has_value());
+static_assert(status(bst::unexpect, errc::odd).error() == errc::odd);
+
+static_assert(bst::unexpected(errc::odd).error() == errc::odd);
+static_assert(bst::unexpected(1) == bst::unexpected(1));
+
+//------------------------------------------------------------------------------
+// Assignment, emplace and swap
+
+template <class T, class E>
+constexpr bool flips() {
+    using X = bst::expected<T, E>;
+    const X v(std::in_place, 1);
+    const X e(bst::unexpect, 2);
+
+    X x = v;
+    x = e; // copy, value to error
+    if (x.has_value() || x.error().v != 2)
+        return false;
+    x = v; // copy, error to value
+    if (!x.has_value() || x->v != 1)
+        return false;
+    x = X(bst::unexpect, 3); // move, value to error
+    if (x.error().v != 3)
+        return false;
+    x = X(std::in_place, 4); // move, error to value
+    if (x->v != 4)
+        return false;
+    x = bst::unexpected<E>(std::in_place, 5);
+    if (x.error().v != 5)
+        return false;
+    x = T(6);
+    if (x->v != 6)
+        return false;
+    x.emplace(7);
+    return x->v == 7;
+}
+
+static_assert(flips<value, value>());
+static_assert(flips<value, fragile>());
+static_assert(flips<fragile, value>());
+static_assert(flips<tolerant, value>());
+
+template <class T, class E>
+constexpr bool swaps() {
+    using X = bst::expected<T, E>;
+    X a(std::in_place, 1);
+    X b(bst::unexpect, 2);
+
+    a.swap(b); // value with error
+    if (a.error().v != 2 || b->v != 1)
+        return false;
+    swap(a, b); // error with value
+    if (a->v != 1 || b.error().v != 2)
+        return false;
+
+    X c(std::in_place, 3);
+    a.swap(c); // value with value
+    X d(bst::unexpect, 4);
+    b.swap(d); // error with error
+    return a->v == 3 && c->v == 1 && b.error().v == 4 && d.error().v == 2;
+}
+
+static_assert(swaps<value, value>());
+static_assert(swaps<value, fragile>());
+static_assert(swaps<fragile, value>());
+static_assert(swaps<tolerant, value>());
+
+constexpr bool void_ops() {
+    using X = bst::expected<void, value>;
+    X a;
+    X b(bst::unexpect, 2);
+    a = b;
+    if (a.error().v != 2)
+        return false;
+    a.emplace();
+    a.swap(b);
+    if (a.error().v != 2 || !b.has_value())
+        return false;
+    b = bst::unexpected(value(3));
+    b = X();
+    return b.has_value() && a == X(bst::unexpect, 2);
+}
+
+static_assert(void_ops());
+
+constexpr bool unexpected_ops() {
+    bst::unexpected<value> a(std::in_place, 1);
+    bst::unexpected<value> b(std::in_place, 2);
+    a.swap(b);
+    swap(a, b);
+    bst::unexpected<std::vector<int>> c(std::in_place, {1, 2, 3});
+    return a.error().v == 1 && c.error().size() == 3 && a != b;
+}
+
+static_assert(unexpected_ops());
+
+// Pointers, and references with an error that would fit beside a pointer's
+// niche. Pointers have a niche only where one is opted into, so these stay
+// usable in constant expressions.
+constexpr bool pointers() {
+    int a = 1;
+    bst::expected<int*, errc> p(&a);
+    bst::expected<int*, errc> q(bst::unexpect, errc::odd);
+    p.swap(q);
+    if (p.error() != errc::odd || *q != &a)
+        return false;
+    p = q;
+    **p = 2;
+    q = bst::unexpected(errc::negative);
+    const auto deref = [](int* x) -> result { return *x; };
+    return a == 2 && q.error() == errc::negative &&
+           p.and_then(deref).value() == 2 &&
+           q.and_then(deref).error() == errc::negative;
+}
+
+static_assert(pointers());
+
+constexpr bst::expected<int*, int> no_pointer(bst::unexpect, 4);
+static_assert(!no_pointer.has_value() && no_pointer.error() == 4);
+
+constexpr bool references() {
+    int a = 1;
+    int b = 2;
+    bst::expected<int&, errc> r(a);
+    r = b;
+    *r = 3;
+    bst::expected<const int&, errc> c(r);
+    r = bst::unexpected(errc::odd);
+    return b == 3 && *c == 3 && r.error() == errc::odd;
+}
+
+static_assert(references());
+
+//------------------------------------------------------------------------------
+// expected<void, E> with a niche in E
+
+using small_status = bst::expected<void, small_errc>;
+
+static_assert(sizeof(small_status) == sizeof(small_errc));
+
+constexpr bool void_niche() {
+    small_status a;
+    small_status b(bst::unexpect, small_errc::worse);
+    a = b;
+    if (a.has_value() || a.error() != small_errc::worse)
+        return false;
+    a.emplace();
+    a.swap(b);
+    if (a.error() != small_errc::worse || !b.has_value())
+        return false;
+    b = bst::unexpected(small_errc::bad);
+    small_status c(std::move(b));
+    b = small_status();
+    return b.has_value() && c.error() == small_errc::bad &&
+           a != b && b.transform([] { return 1; }).value() == 1 &&
+           a.or_else([](small_errc) { return small_status(); }).has_value();
+}
+
+static_assert(void_niche());
+
+// Every third entry is an error. Read back at run time, the table has to
+// agree with the niche the run-time code looks for.
+constexpr auto status_table = [] {
+    std::array<small_status, 16> t{};
+    for (std::size_t i = 0; i < t.size(); i += 3)
+        t[i] = bst::unexpected(small_errc::bad);
+    return t;
+}();
+
+static_assert(status_table[3].error() == small_errc::bad);
+static_assert(status_table[4].has_value());
+
+//------------------------------------------------------------------------------
+// Monadic operations
+
+constexpr result half(int x) {
+    if (x % 2)
+        return bst::unexpected(errc::odd);
+    return x / 2;
+}
+
+static_assert(result(8).and_then(half).and_then(half).value() == 2);
+static_assert(result(6).and_then(half).and_then(half).error() == errc::odd);
+static_assert(result(3).transform([](int x) { return x + 1; }).value() == 4);
+static_assert(result(bst::unexpect, errc::odd)
+                  .or_else([](errc) { return result(0); })
+                  .value() == 0);
+static_assert(result(bst::unexpect, errc::odd)
+                  .transform_error([](errc e) { return static_cast<int>(e); })
+                  .error() == 3);
+static_assert(status().and_then([] { return result(1); }).value() == 1);
+static_assert(status().transform([] { return 2; }).value() == 2);
+static_assert(status(bst::unexpect, errc::odd)
+                  .transform_error([](errc) { return 0; })
+                  .error() == 0);
+
+// An allocating payload through a chain.
+static_assert(bst::expected<std::vector<int>, errc>(std::in_place, 3, 1)
+                  .transform([](std::vector<int> v) {
+                      v.push_back(2);
+                      return v;
+                  })
+                  .and_then([](const std::vector<int>& v) {
+                      return result(v[0] + v[3]);
+                  })
+                  .value() == 3);
+
+//------------------------------------------------------------------------------
+// Lookup tables
+
+// Classifies every byte: even values below 200 map to their half.
+constexpr result classify(int x) {
+    if (x >= 200)
+        return bst::unexpected(errc::too_large);
+    return half(x);
+}
+
+constexpr auto make_table() {
+    std::array<result, 256> table{};
+    for (std::size_t i = 0; i < table.size(); ++i)
+        table[i] = classify(static_cast<int>(i));
+    return table;
+}
+
+constexpr auto table = make_table();
+
+static_assert(table[10].value() == 5);
+static_assert(table[11].error() == errc::odd);
+static_assert(table[254].error() == errc::too_large);
+
+// The same table, built through swaps and transform_error into a table of
+// messages.
+constexpr const char* describe(errc e) {
+    switch (e) {
+    case errc::odd:
+        return "odd";
+    case errc::too_large:
+        return "too large";
+    default:
+        return "other";
+    }
+}
+
+using message_result = bst::expected<int, const char*>;
+
+constexpr auto make_message_table() {
+    std::array<message_result, 256> messages{};
+    for (std::size_t i = 0; i < messages.size(); ++i) {
+        message_result m = table[i].transform_error(describe);
+        messages[i].swap(m);
+    }
+    return messages;
+}
+
+constexpr auto messages = make_message_table();
+
+static_assert(messages[10].value() == 5);
+static_assert(messages[11].error()[0] == 'o');
+static_assert(messages[254].error()[0] == 't');
+
+} // namespace
+
+//------------------------------------------------------------------------------
+
+TEST(ConstexprTests, TablesMatchRuntime) {
+    for (std::size_t i = 0; i < table.size(); ++i) {
+        EXPECT_EQ(table[i], classify(static_cast<int>(i)));
+        EXPECT_EQ(messages[i].has_value(), table[i].has_value());
+    }
+}
+
+TEST(ConstexprTests, NicheTableMatchesRuntime) {
+    for (std::size_t i = 0; i < status_table.size(); ++i) {
+        const small_status& s = status_table[i];
+        EXPECT_EQ(s.has_value(), i % 3 != 0) << i;
+        if (!s.has_value()) {
+            EXPECT_EQ(s.error(), small_errc::bad);
+        }
+    }
+}
@@ -0,0 +1,130 @@
+#include <expected/error.hpp>
+#include <expected/expected.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <system_error>
+#include <type_traits>
+
+//------------------------------------------------------------------------------
+
+namespace {
+
+enum class db_errc { timeout = 1, conflict = 2 };
+
+class db_domain final : public bst::error_domain {
+public:
+    const char* name() const noexcept override { return "db"; }
+    std::string message(const bst::error& e) const override {
+        switch (static_cast<db_errc>(e.code())) {
+        case db_errc::timeout:
+            return "timed out";
+        case db_errc::conflict:
+            return "conflict";
+        }
+        return "unknown";
+    }
+};
+
+const bst::error_domain& error_domain_of(db_errc) {
+    static const db_domain domain;
+    return domain;
+}
+
+// A custom payload: the failing byte range of a parse.
+struct span_payload {
+    std::uint32_t offset;
+    std::uint32_t length;
+};
+
+class parse_domain final : public bst::error_domain {
+public:
+    const char* name() const noexcept override { return "parse"; }
+    std::string message(const bst::error& e) const override {
+        auto s = e.payload<span_payload>();
+        return "bad input at " + std::to_string(s.offset) + "+" +
+               std::to_string(s.length);
+    }
+};
+
+const parse_domain parse;
+
+} // namespace
+
+//------------------------------------------------------------------------------
+
+TEST(ErrorTests, Codes) {
+    bst::error none;
+    EXPECT_EQ(static_cast<bool>(none), false);
+    EXPECT_EQ(none.message(), "no error");
+
+    bst::error e = db_errc::timeout;
+    EXPECT_EQ(static_cast<bool>(e), true);
+    EXPECT_EQ(e.domain(), &error_domain_of(db_errc{}));
+    EXPECT_EQ(e.code(), 1);
+    EXPECT_EQ(e.message(), "timed out");
+    EXPECT_EQ(std::string(e.domain()->name()), "db");
+
+    EXPECT_EQ(e == db_errc::timeout, true);
+    EXPECT_EQ(e == db_errc::conflict, false);
+    EXPECT_EQ(e == bst::error(db_errc::timeout), true);
+    EXPECT_EQ(e == none, false);
+}
+
+TEST(ErrorTests, GenericDomain) {
+    bst::error e = std::errc::invalid_argument;
+    EXPECT_EQ(e.domain(), &bst::generic_domain());
+    EXPECT_EQ(e.message(),
+              std::make_error_code(std::errc::invalid_argument).message());
+
+    // Same code, different domain.
+    bst::error d(error_domain_of(db_errc{}),
+                 static_cast<std::intptr_t>(std::errc::invalid_argument));
+    EXPECT_EQ(e == d, false);
+}
+
+TEST(ErrorTests, CustomPayload) {
+    bst::error e(parse, span_payload{10, 4});
+    EXPECT_EQ(e.payload<span_payload>().offset, 10u);
+    EXPECT_EQ(e.message(), "bad input at 10+4");
+    EXPECT_EQ(e == bst::error(parse, span_payload{10, 4}), true);
+    EXPECT_EQ(e == bst::error(parse, span_payload{10, 5}), false);
+}
+
+// Payloads are compared byte for byte, so one whose bytes do not determine
+// its value is refused: padding is indeterminate, and +0.0 == -0.0.
+struct padded_payload {
+    char c;
+    int i;
+};
+
+static_assert(bst::error::is_payload_v<span_payload>);
+static_assert(!bst::error::is_payload_v<padded_payload>);
+static_assert(!bst::error::is_payload_v<double>);
+static_assert(!std::is_constructible_v<bst::error, const bst::error_domain&,
+                                       padded_payload>);
+
+TEST(ErrorTests, PayloadComparesByValue) {
+    // Whatever the payload bytes held before, equal values compare equal.
+    span_payload x;
+    std::memset(&x, 0xff, sizeof(x));
+    x.offset = 10;
+    x.length = 4;
+    EXPECT_EQ(bst::error(parse, x), bst::error(parse, span_payload{10, 4}));
+    EXPECT_NE(bst::error(parse, x), bst::error(parse, std::uint32_t(10)));
+}
+
+TEST(ErrorTests, InExpected) {
+    bst::expected<int, bst::error> r =
+        bst::unexpected(bst::error(db_errc::conflict));
+    EXPECT_EQ(r.has_value(), false);
+    EXPECT_EQ(r == bst::unexpected(db_errc::conflict), true);
+    EXPECT_EQ(r == bst::unexpected(bst::error(db_errc::timeout)), false);
+    EXPECT_EQ(r.error().message(), "conflict");
+
+    bst::expected<int, bst::error> g = bst::unexpected(std::errc::timed_out);
+    EXPECT_EQ(g.error() == std::errc::timed_out, true);
+}
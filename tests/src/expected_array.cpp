@@ -0,0 +1,188 @@
+#include <expected/expected_array.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------------
+
+namespace static_tests {
+
+static_assert(
+    std::random_access_iterator<bst::expected_array<int, int>::iterator>);
+static_assert(
+    std::random_access_iterator<bst::expected_array<int, int>::const_iterator>);
+
+} // namespace static_tests
+
+namespace {
+
+// Every third slot holds an error, so the pattern straddles bitmap words.
+template <class A>
+A make_array(int n) {
+    A a;
+    for (int i = 0; i < n; ++i) {
+        if (i % 3 == 0)
+            a.emplace_error(i);
+        else
+            a.emplace_value(i);
+    }
+    return a;
+}
+
+} // namespace
+
+//------------------------------------------------------------------------------
+// Construction and access
+
+TEST(ExpectedArrayTests, PushAndAccess) {
+    bst::expected_array<std::string, int> a;
+    a.push_back(bst::expected<std::string, int>("a value"));
+    a.push_back(bst::expected<std::string, int>(bst::unexpect, 7));
+    a.emplace_value(3, 'x');
+
+    ASSERT_EQ(a.size(), 3u);
+    EXPECT_EQ(a[0].has_value(), true);
+    EXPECT_EQ(*a[0], "a value");
+    EXPECT_EQ(a[0]->size(), 7u);
+    EXPECT_EQ(a[1].has_value(), false);
+    EXPECT_EQ(a[1].error(), 7);
+    EXPECT_EQ(a[2].value(), "xxx");
+    EXPECT_THROW(a[1].value(), bst::bad_expected_access<int>);
+    EXPECT_EQ(a[1].value_or("default"), "default");
+
+    bst::expected<std::string, int> e = a[1];
+    EXPECT_EQ(e.error(), 7);
+}
+
+TEST(ExpectedArrayTests, AssignThroughReference) {
+    bst::expected_array<std::string, int> a;
+    a.emplace_value("one");
+    a.emplace_error(2);
+
+    a[0] = a[1];
+    EXPECT_EQ(a[0].has_value(), false);
+    EXPECT_EQ(a[0].error(), 2);
+
+    a[1] = bst::expected<std::string, int>("two");
+    EXPECT_EQ(*a[1], "two");
+
+    a.set_value(0, "zero");
+    a.set_error(1, 1);
+    using E = bst::expected<std::string, int>;
+    EXPECT_EQ(a[0] == E("zero"), true);
+    EXPECT_EQ(a[1] == E(bst::unexpect, 1), true);
+}
+
+TEST(ExpectedArrayTests, GrowthCopyAndMove) {
+    bst::expected_array<std::string, int> a;
+    for (int i = 0; i < 200; ++i) {
+        if (i % 3 == 0)
+            a.emplace_error(i);
+        else
+            a.emplace_value(std::string(40, static_cast<char>('a' + i % 26)));
+    }
+    ASSERT_EQ(a.size(), 200u);
+    EXPECT_GE(a.capacity(), 200u);
+
+    auto b = a;
+    auto c = std::move(a);
+    EXPECT_EQ(a.size(), 0u);
+    for (int i = 0; i < 200; ++i) {
+        ASSERT_EQ(b[i].has_value(), i % 3 != 0);
+        if (i % 3 == 0)
+            EXPECT_EQ(c[i].error(), i);
+        else
+            EXPECT_EQ(*c[i], *b[i]);
+    }
+
+    c.pop_back();
+    EXPECT_EQ(c.size(), 199u);
+    EXPECT_EQ(c.count_values(), 132u);
+    c.clear();
+    EXPECT_EQ(c.empty(), true);
+    EXPECT_EQ(c.count_values(), 0u);
+}
+
+TEST(ExpectedArrayTests, Iterators) {
+    std::vector<bst::expected<int, int>> v{1, bst::unexpected(2), 3};
+    bst::expected_array<int, int> a(v.begin(), v.end());
+
+    int values = 0;
+    for (auto e : a)
+        values += e.has_value();
+    EXPECT_EQ(values, 2);
+
+    const auto& ca = a;
+    EXPECT_EQ(ca.end() - ca.begin(), 3);
+    EXPECT_EQ(ca.begin()[2].value(), 3);
+    EXPECT_EQ((*std::next(a.begin())).error(), 2);
+}
+
+//------------------------------------------------------------------------------
+// Bulk queries
+
+TEST(ExpectedArrayTests, CountAndFirstError) {
+    bst::expected_array<std::int64_t, int> a;
+    EXPECT_EQ(a.count_values(), 0u);
+    EXPECT_EQ(a.first_error(), 0u);
+
+    for (int i = 0; i < 130; ++i)
+        a.emplace_value(i);
+    EXPECT_EQ(a.count_values(), 130u);
+    EXPECT_EQ(a.first_error(), 130u);
+
+    a.set_error(129, 1);
+    a.set_error(70, 2);
+    EXPECT_EQ(a.count_values(), 128u);
+    EXPECT_EQ(a.count_errors(), 2u);
+    EXPECT_EQ(a.first_error(), 70u);
+}
+
+TEST(ExpectedArrayTests, Partition) {
+    bst::expected_array<std::string, int> a;
+    for (int i = 0; i < 150; ++i) {
+        if (i % 3 == 0)
+            a.emplace_error(i);
+        else
+            a.emplace_value(std::to_string(i));
+    }
+
+    const auto n = a.partition();
+    EXPECT_EQ(n, 100u);
+    EXPECT_EQ(a.first_error(), n);
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        ASSERT_EQ(a[i].has_value(), i < n);
+        if (i < n)
+            EXPECT_NE(std::stoi(*a[i]) % 3, 0);
+        else
+            EXPECT_EQ(a[i].error() % 3, 0);
+    }
+}
+
+TEST(ExpectedArrayTests, ValuesOr) {
+    auto dense = make_array<bst::expected_array<std::int64_t, int>>(200);
+    for (int i = 64; i < 128; ++i)
+        dense.set_value(i, i);
+    for (int i = 128; i < 192; ++i)
+        dense.set_error(i, i);
+
+    const auto v = dense.values_or(-1);
+    ASSERT_EQ(v.size(), 200u);
+    for (int i = 0; i < 200; ++i) {
+        if (dense[i].has_value())
+            EXPECT_EQ(v[i], i);
+        else
+            EXPECT_EQ(v[i], -1);
+    }
+
+    bst::expected_array<std::string, int> sparse;
+    sparse.emplace_value("x");
+    sparse.emplace_error(1);
+    EXPECT_EQ(sparse.values_or("none"),
+              (std::vector<std::string>{"x", "none"}));
+}
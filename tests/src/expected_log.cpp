@@ -0,0 +1,182 @@
+#include <expected/expected_log.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+//------------------------------------------------------------------------------
+
+namespace {
+
+enum class errc : std::int32_t { invalid = 1, overflow };
+
+struct record {
+    std::int64_t id;
+    double amount;
+    friend bool operator==(const record&, const record&) = default;
+};
+
+using log_type = bst::expected_log<record, errc>;
+using result = bst::expected<record, errc>;
+
+// Small blocks, so that a few hundred entries span several of them.
+constexpr std::uint64_t block = 128;
+
+// Entry i is an error when i is a multiple of 7.
+result entry(std::uint64_t i) {
+    if (i % 7 == 0)
+        return bst::unexpected(i % 2 ? errc::invalid : errc::overflow);
+    return record{static_cast<std::int64_t>(i), 0.5 * i};
+}
+
+class ExpectedLogTests : public ::testing::Test {
+protected:
+    void SetUp() override {
+        path_ = std::filesystem::temp_directory_path() /
+                ("bst_expected_log_" + std::to_string(::getpid()) + "_" +
+                 ::testing::UnitTest::GetInstance()
+                     ->current_test_info()
+                     ->name());
+    }
+
+    void TearDown() override {
+        std::error_code ec;
+        std::filesystem::remove(path_, ec);
+    }
+
+    log_type create_with(std::uint64_t n) {
+        auto log = log_type::create(path_, block);
+        EXPECT_TRUE(log.has_value());
+        for (std::uint64_t i = 0; i < n; ++i)
+            EXPECT_TRUE(log->push_back(entry(i)));
+        return std::move(*log);
+    }
+
+    std::filesystem::path path_;
+};
+
+} // namespace
+
+//------------------------------------------------------------------------------
+
+TEST_F(ExpectedLogTests, AppendAndRead) {
+    const auto log = create_with(1000);
+    ASSERT_EQ(log.size(), 1000u);
+    for (std::uint64_t i = 0; i < 1000; ++i) {
+        EXPECT_EQ(log.has_value(i), i % 7 != 0) << i;
+        EXPECT_EQ(log[i], entry(i)) << i;
+    }
+}
+
+TEST_F(ExpectedLogTests, ErrorsInOrder) {
+    const auto log = create_with(1000);
+    std::vector<std::uint64_t> seen;
+    log.for_each_error([&](std::uint64_t i, const errc& e) {
+        seen.push_back(i);
+        EXPECT_EQ(e, entry(i).error());
+    });
+    ASSERT_EQ(seen.size(), 143u);
+    EXPECT_EQ(log.count_errors(), 143u);
+    for (std::size_t k = 0; k < seen.size(); ++k)
+        EXPECT_EQ(seen[k], 7 * k);
+}
+
+TEST_F(ExpectedLogTests, ReopenAndResume) {
+    {
+        auto log = create_with(300);
+        ASSERT_TRUE(log.flush());
+        EXPECT_EQ(log.flushed_size(), 300u);
+    }
+    {
+        auto log = log_type::open(path_, bst::log_mode::write);
+        ASSERT_TRUE(log.has_value());
+        ASSERT_EQ(log->size(), 300u);
+        for (std::uint64_t i = 300; i < 700; ++i)
+            ASSERT_TRUE(log->push_back(entry(i)));
+    }
+
+    const auto log = log_type::open(path_);
+    ASSERT_TRUE(log.has_value());
+    ASSERT_EQ(log->size(), 700u);
+    EXPECT_EQ(log->flushed_size(), 300u);
+    for (std::uint64_t i = 0; i < 700; ++i)
+        EXPECT_EQ((*log)[i], entry(i)) << i;
+    EXPECT_EQ(log->count_errors(), 100u);
+}
+
+TEST_F(ExpectedLogTests, SurvivesTheWriterDying) {
+    const pid_t pid = ::fork();
+    ASSERT_GE(pid, 0);
+    if (pid == 0) {
+        // Neither flushed nor unmapped: the process just ends.
+        auto log = create_with(500);
+        ::_exit(log.size() == 500 ? 0 : 1);
+    }
+    int status = 0;
+    ASSERT_EQ(::waitpid(pid, &status, 0), pid);
+    ASSERT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    auto log = log_type::open(path_, bst::log_mode::write);
+    ASSERT_TRUE(log.has_value());
+    ASSERT_EQ(log->size(), 500u);
+    EXPECT_EQ(log->flushed_size(), 0u);
+    for (std::uint64_t i = 500; i < 600; ++i)
+        ASSERT_TRUE(log->push_back(entry(i)));
+    for (std::uint64_t i = 0; i < 600; ++i)
+        EXPECT_EQ((*log)[i], entry(i)) << i;
+}
+
+TEST_F(ExpectedLogTests, UncommittedEntriesAreOverwritten) {
+    auto log = create_with(200);
+    ASSERT_TRUE(log.flush());
+    for (std::uint64_t i = 200; i < 260; ++i)
+        ASSERT_TRUE(log.push_back(entry(i)));
+
+    // Dropping back to the flushed entries is what recovery after a power
+    // failure does. The bits and errors left past the count must not leak
+    // into what is appended next.
+    log.truncate(log.flushed_size());
+    ASSERT_EQ(log.size(), 200u);
+    for (std::uint64_t i = 200; i < 260; ++i)
+        ASSERT_TRUE(log.push_back(bst::unexpected(errc::invalid)));
+
+    EXPECT_EQ(log[203], result(bst::unexpect, errc::invalid));
+    EXPECT_EQ(log[259], result(bst::unexpect, errc::invalid));
+    EXPECT_EQ(log[199], entry(199));
+    EXPECT_EQ(log.count_errors(), 29u + 60u);
+}
+
+TEST_F(ExpectedLogTests, ReaderSeesCommittedEntries) {
+    auto writer = create_with(10);
+    auto reader = log_type::open(path_);
+    ASSERT_TRUE(reader.has_value());
+    EXPECT_EQ(reader->size(), 10u);
+
+    ASSERT_TRUE(writer.push_back(entry(10)));
+    EXPECT_EQ(reader->size(), 11u);
+    EXPECT_EQ((*reader)[10], entry(10));
+    EXPECT_FALSE(reader->push_back(entry(11)));
+}
+
+TEST_F(ExpectedLogTests, RejectsOtherFiles) {
+    create_with(10);
+    EXPECT_EQ((bst::expected_log<std::int64_t, errc>::open(path_)).error(),
+              std::errc::invalid_argument);
+
+    std::ofstream(path_, std::ios::trunc) << "not a log";
+    EXPECT_EQ(log_type::open(path_).error(), std::errc::invalid_argument);
+
+    EXPECT_EQ(log_type::open(path_.string() + ".missing").error(),
+              std::errc::no_such_file_or_directory);
+    EXPECT_EQ(log_type::create(path_, 100).error(),
+              std::errc::invalid_argument);
+}
@@ -0,0 +1,148 @@
+#include <expected/expected_slot.hpp>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+//------------------------------------------------------------------------------
+
+namespace {
+
+using slot = bst::expected_slot<std::string, int>;
+
+struct throws_on_copy {
+    throws_on_copy() = default;
+    throws_on_copy(const throws_on_copy&) { throw 1; }
+};
+
+} // namespace
+
+//------------------------------------------------------------------------------
+
+TEST(ExpectedSlotTests, StartsEmpty) {
+    slot s;
+    EXPECT_EQ(s.state(), bst::slot_state::empty);
+    EXPECT_FALSE(s.ready());
+    EXPECT_EQ(s.try_get(), nullptr);
+}
+
+TEST(ExpectedSlotTests, SetValue) {
+    slot s;
+    EXPECT_TRUE(s.set_value(3, 'x'));
+    EXPECT_EQ(s.state(), bst::slot_state::value);
+    ASSERT_NE(s.try_get(), nullptr);
+    EXPECT_EQ(**s.try_get(), "xxx");
+    EXPECT_EQ(*s.wait(), "xxx");
+}
+
+TEST(ExpectedSlotTests, SetError) {
+    slot s;
+    EXPECT_TRUE(s.set_error(7));
+    EXPECT_EQ(s.state(), bst::slot_state::error);
+    EXPECT_EQ(s.wait().error(), 7);
+}
+
+TEST(ExpectedSlotTests, Publish) {
+    slot s;
+    const bst::expected<std::string, int> r("done");
+    EXPECT_TRUE(s.publish(r));
+    EXPECT_EQ(s.wait(), r);
+
+    slot t;
+    EXPECT_TRUE(t.publish(bst::expected<std::string, int>(bst::unexpect, 2)));
+    EXPECT_EQ(t.state(), bst::slot_state::error);
+}
+
+TEST(ExpectedSlotTests, OnlyTheFirstPublishWins) {
+    slot s;
+    EXPECT_TRUE(s.set_value("first"));
+    EXPECT_FALSE(s.set_value("second"));
+    EXPECT_FALSE(s.set_error(1));
+    EXPECT_EQ(*s.wait(), "first");
+}
+
+TEST(ExpectedSlotTests, TakeEmptiesTheSlot) {
+    slot s;
+    s.set_value("a");
+    EXPECT_EQ(*s.take(), "a");
+    EXPECT_FALSE(s.ready());
+
+    EXPECT_TRUE(s.set_error(4));
+    EXPECT_EQ(s.take().error(), 4);
+
+    s.set_value("b");
+    s.reset();
+    EXPECT_EQ(s.state(), bst::slot_state::empty);
+}
+
+TEST(ExpectedSlotTests, Void) {
+    bst::expected_slot<void, int> s;
+    EXPECT_TRUE(s.set_value());
+    EXPECT_TRUE(s.wait().has_value());
+}
+
+TEST(ExpectedSlotTests, DestroysTheResult) {
+    auto p = std::make_shared<int>(1);
+    {
+        bst::expected_slot<std::shared_ptr<int>, int> s;
+        s.set_value(p);
+        EXPECT_EQ(p.use_count(), 2);
+    }
+    EXPECT_EQ(p.use_count(), 1);
+}
+
+TEST(ExpectedSlotTests, ThrowingConstructionLeavesTheSlotEmpty) {
+    bst::expected_slot<throws_on_copy, int> s;
+    const throws_on_copy x;
+    EXPECT_THROW(s.set_value(x), int);
+    EXPECT_EQ(s.state(), bst::slot_state::empty);
+    EXPECT_TRUE(s.set_error(1));
+}
+
+TEST(ExpectedSlotTests, WaitBlocksUntilPublished) {
+    slot s;
+    std::thread producer([&] { s.set_value("from another thread"); });
+    EXPECT_EQ(*s.wait(), "from another thread");
+    producer.join();
+}
+
+TEST(ExpectedSlotTests, StreamBetweenThreads) {
+    constexpr int n = 10000;
+    bst::expected_slot<int, int> s;
+
+    std::thread producer([&] {
+        for (int i = 0; i < n; ++i) {
+            // Spin until the consumer has taken the previous result.
+            while (!(i % 3 ? s.set_value(i) : s.set_error(i)))
+                std::this_thread::yield();
+        }
+    });
+
+    long long sum = 0;
+    for (int i = 0; i < n; ++i) {
+        auto r = s.take();
+        EXPECT_EQ(r.has_value(), i % 3 != 0);
+        sum += r ? *r : r.error();
+    }
+    producer.join();
+    EXPECT_EQ(sum, static_cast<long long>(n) * (n - 1) / 2);
+}
+
+TEST(ExpectedSlotTests, ConcurrentProducers) {
+    bst::expected_slot<int, int> s;
+    std::vector<std::thread> producers;
+    std::atomic<int> winners{0};
+    for (int i = 0; i < 8; ++i)
+        producers.emplace_back([&, i] {
+            if (s.set_value(i))
+                ++winners;
+        });
+    for (auto& t : producers)
+        t.join();
+    EXPECT_EQ(winners, 1);
+    EXPECT_TRUE(s.ready());
+}
@@ -0,0 +1,259 @@
+//
+// Tests for the instrumented build. This file is compiled with
+// BST_EXPECTED_INSTRUMENT defined, so every expected counts what it does.
+//
+
+#include <expected/expected.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <string_view>
+
+#ifndef BST_EXPECTED_INSTRUMENT
+#error "this file must be compiled with BST_EXPECTED_INSTRUMENT"
+#endif
+
+//------------------------------------------------------------------------------
+
+namespace {
+
+struct payload {
+    payload(int v) : v(v) {}
+    payload(const payload& rhs) : v(rhs.v) {}
+    payload(payload&& rhs) noexcept : v(rhs.v) {}
+    payload& operator=(const payload&) = default;
+    payload& operator=(payload&&) = default;
+
+    int v;
+};
+
+struct failure {
+    failure(int code) : code(code) {}
+    failure(const failure& rhs) : code(rhs.code) {}
+    failure(failure&& rhs) noexcept : code(rhs.code) {}
+    failure& operator=(const failure&) = default;
+    failure& operator=(failure&&) = default;
+
+    int code;
+};
+
+// Neither copy nor move is noexcept, which sends assignment of a value over
+// an error through a temporary.
+struct may_throw {
+    may_throw(int v) : v(v) {}
+    may_throw(const may_throw& rhs) : v(rhs.v) {}
+    may_throw(may_throw&& rhs) : v(rhs.v) {}
+    may_throw& operator=(const may_throw&) = default;
+    may_throw& operator=(may_throw&&) = default;
+
+    int v;
+};
+
+using result = bst::expected<payload, failure>;
+
+std::uint64_t get(const std::atomic<std::uint64_t>& c) { return c.load(); }
+
+class InstrumentTests : public ::testing::Test {
+protected:
+    void SetUp() override { bst::reset_expected_counters(); }
+};
+
+std::string json() {
+    std::FILE* f = std::tmpfile();
+    bst::write_expected_counters_json(f);
+    std::string out(static_cast<std::size_t>(std::ftell(f)), '\0');
+    std::rewind(f);
+    out.resize(std::fread(out.data(), 1, out.size(), f));
+    std::fclose(f);
+    return out;
+}
+
+} // namespace
+
+//------------------------------------------------------------------------------
+
+TEST_F(InstrumentTests, CopiesAndMoves) {
+    result a(payload(1));
+    const auto& c = bst::expected_counters_of<payload, failure>();
+
+    result b(a);
+    result d(std::move(b));
+    EXPECT_EQ(get(c.copy_constructions), 1u);
+    EXPECT_EQ(get(c.move_constructions), 1u);
+
+    b = a;
+    d = std::move(b);
+    EXPECT_EQ(get(c.copy_assignments), 1u);
+    EXPECT_EQ(get(c.move_assignments), 1u);
+    EXPECT_EQ(get(c.error_constructions), 0u);
+}
+
+TEST_F(InstrumentTests, ConvertingConstructionsCountAsCopiesAndMoves) {
+    bst::expected<int, int> narrow(3);
+    bst::expected<long, long> a(narrow);
+    bst::expected<long, long> b(std::move(narrow));
+
+    const auto& c = bst::expected_counters_of<long, long>();
+    EXPECT_EQ(get(c.copy_constructions), 1u);
+    EXPECT_EQ(get(c.move_constructions), 1u);
+}
+
+TEST_F(InstrumentTests, ErrorConstructions) {
+    const auto& c = bst::expected_counters_of<payload, failure>();
+
+    result a(bst::unexpect, 1);
+    result b = bst::unexpected(failure(2));
+    EXPECT_EQ(get(c.error_constructions), 2u);
+
+    // Propagated by and_then into a new expected, and copied with a.
+    auto r = a.and_then([](const payload& p) { return result(p); });
+    result copy(a);
+    EXPECT_EQ(get(c.error_constructions), 4u);
+
+    // Switching from the value to the error creates one; assigning to an
+    // existing error does not.
+    result v(payload(3));
+    v = b;
+    b = a;
+    EXPECT_EQ(get(c.error_constructions), 5u);
+}
+
+TEST_F(InstrumentTests, ReinitTemporaries) {
+    bst::expected<may_throw, failure> e(may_throw(1));
+    const auto& c = bst::expected_counters_of<may_throw, failure>();
+
+    // The copy of the error may throw, so it is made aside first; then the
+    // error is moved aside while the value is built.
+    const bst::unexpected<failure> err(failure(2));
+    e = err;
+    e = may_throw(3);
+    EXPECT_EQ(get(c.reinit_temporaries), 2u);
+
+    // No temporary when the new alternative cannot throw.
+    result r(payload(1));
+    r = bst::unexpected(failure(2));
+    EXPECT_EQ(
+        get(bst::expected_counters_of<payload, failure>().reinit_temporaries),
+        0u);
+}
+
+TEST_F(InstrumentTests, ValueOrCopies) {
+    result a(payload(1));
+    const auto& c = bst::expected_counters_of<payload, failure>();
+
+    EXPECT_EQ(a.value_or(payload(0)).v, 1);
+    EXPECT_EQ(std::move(a).value_or(payload(0)).v, 1);
+    EXPECT_EQ(get(c.value_or_copies), 1u);
+
+    int x = 4;
+    bst::expected<int&, failure> ref(x);
+    EXPECT_EQ(ref.value_or(0), 4);
+    EXPECT_EQ(get(bst::expected_counters_of<int&, failure>().value_or_copies),
+              1u);
+}
+
+TEST_F(InstrumentTests, BadAccessThrows) {
+    result a(bst::unexpect, 1);
+    bst::expected<void, failure> v(bst::unexpect, 2);
+
+    EXPECT_THROW(a.value(), bst::bad_expected_access<failure>);
+    EXPECT_THROW(std::move(a).value(), bst::bad_expected_access<failure>);
+    EXPECT_THROW(v.value(), bst::bad_expected_access<failure>);
+
+    EXPECT_EQ(
+        get(bst::expected_counters_of<payload, failure>().bad_access_throws),
+        2u);
+    EXPECT_EQ(get(bst::expected_counters_of<void, failure>().bad_access_throws),
+              1u);
+}
+
+TEST_F(InstrumentTests, Void) {
+    using E = bst::expected<void, failure>;
+    const auto& c = bst::expected_counters_of<void, failure>();
+
+    E ok;
+    E err(bst::unexpect, 1);
+    E copy(err);
+    ok = err;
+    EXPECT_EQ(get(c.copy_constructions), 1u);
+    EXPECT_EQ(get(c.copy_assignments), 1u);
+    EXPECT_EQ(get(c.error_constructions), 3u);
+}
+
+TEST_F(InstrumentTests, TrivialConstructionsAreNotCounted) {
+    bst::expected<int, int> a(1);
+    bst::expected<int, int> b(a);
+    bst::expected<int, int> c(std::move(a));
+
+    const auto& n = bst::expected_counters_of<int, int>();
+    EXPECT_EQ(get(n.copy_constructions), 0u);
+    EXPECT_EQ(get(n.move_constructions), 0u);
+}
+
+TEST_F(InstrumentTests, Registry) {
+    result a(payload(1));
+    result b(a);
+
+    bool found = false;
+    bst::for_each_expected_counters(
+        [&](std::string_view name, const bst::expected_counters& c) {
+            if (name.find("payload") != std::string_view::npos &&
+                name.find("failure") != std::string_view::npos) {
+                EXPECT_FALSE(found);
+                EXPECT_EQ(get(c.copy_constructions), 1u);
+                found = true;
+            }
+        });
+    EXPECT_TRUE(found);
+
+    bst::reset_expected_counters();
+    EXPECT_EQ(
+        get(bst::expected_counters_of<payload, failure>().copy_constructions),
+        0u);
+}
+
+TEST_F(InstrumentTests, Json) {
+    result a(bst::unexpect, 1);
+    result b(a);
+
+    const std::string out = json();
+    EXPECT_EQ(out.front(), '{');
+    EXPECT_NE(out.find("bst::expected<"), std::string::npos);
+    EXPECT_NE(out.find("\"copy_constructions\": 1"), std::string::npos);
+    EXPECT_NE(out.find("\"error_constructions\": 2"), std::string::npos);
+}
+
+#ifndef _WIN32
+TEST_F(InstrumentTests, DumpsAtExit) {
+    const std::string path = ::testing::TempDir() + "expected_counters.json";
+    std::remove(path.c_str());
+
+    EXPECT_EXIT(
+        {
+            setenv("BST_EXPECTED_COUNTERS", path.c_str(), 1);
+            result a(bst::unexpect, 7);
+            result b(a);
+            std::exit(0);
+        },
+        ::testing::ExitedWithCode(0), "");
+
+    std::ifstream in(path);
+    const std::string out{std::istreambuf_iterator<char>(in),
+                          std::istreambuf_iterator<char>()};
+    EXPECT_NE(out.find("failure"), std::string::npos);
+    EXPECT_NE(out.find("\"copy_constructions\": 1"), std::string::npos);
+}
+#endif
+
+// Counting is skipped in constant evaluation.
+static_assert([] {
+    bst::expected<int, long> a(bst::unexpect, 1L);
+    bst::expected<long, long> b(a);
+    b = 2L;
+    return b.value();
+}() == 2);
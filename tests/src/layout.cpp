@@ -0,0 +1,156 @@
+#include <expected/expected.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <type_traits>
+
+//------------------------------------------------------------------------------
+
+//
+// Layout matrix: the size of expected<T, E> for common pairs of alternatives.
+//
+
+namespace layout_tests {
+
+enum class errc : int { bad = 1, worse = 2 };
+enum class small_errc : unsigned char { bad = 1, worse = 2 };
+struct not_found {};
+struct node {
+    int value;
+};
+
+// Only declared here, and completed further down.
+struct forward_declared;
+
+} // namespace layout_tests
+
+template <>
+struct bst::expected_niche_traits<layout_tests::errc>
+    : bst::enum_niche_traits<layout_tests::errc, layout_tests::errc(0)> {};
+
+template <>
+struct bst::expected_niche_traits<layout_tests::small_errc>
+    : bst::enum_niche_traits<layout_tests::small_errc,
+                             layout_tests::small_errc(0)> {};
+
+template <>
+struct bst::expected_niche_traits<layout_tests::node*>
+    : bst::pointer_niche_traits<layout_tests::node*> {};
+
+template <>
+struct bst::expected_niche_traits<std::unique_ptr<layout_tests::node>>
+    : bst::pointer_niche_traits<std::unique_ptr<layout_tests::node>> {};
+
+namespace layout_tests {
+
+// The size of T followed by a bool discriminant.
+template <class T>
+constexpr std::size_t with_flag =
+    (sizeof(T) + 1 + alignof(T) - 1) / alignof(T) * alignof(T);
+
+// expected<void, E>: a niche in E carries the discriminant.
+static_assert(sizeof(bst::expected<void, errc>) == sizeof(errc));
+static_assert(sizeof(bst::expected<void, small_errc>) == 1);
+static_assert(sizeof(bst::expected<void, node*>) == sizeof(node*));
+static_assert(sizeof(bst::expected<void, std::unique_ptr<node>>) ==
+              sizeof(node*));
+static_assert(sizeof(bst::expected<void, int*>) == with_flag<int*>);
+static_assert(sizeof(bst::expected<void, int>) == with_flag<int>);
+static_assert(sizeof(bst::expected<void, std::string>) ==
+              with_flag<std::string>);
+static_assert(sizeof(bst::expected<void, not_found>) == 2);
+
+// expected<T, Empty>: one byte of discriminant beyond T, rounded up to the
+// alignment of T, or nothing when T has a niche.
+static_assert(sizeof(bst::expected<char, not_found>) == 2);
+static_assert(sizeof(bst::expected<int, not_found>) == with_flag<int>);
+static_assert(sizeof(bst::expected<double, not_found>) == with_flag<double>);
+static_assert(sizeof(bst::expected<std::string, not_found>) ==
+              with_flag<std::string>);
+static_assert(sizeof(bst::expected<node*, not_found>) == sizeof(node*));
+static_assert(sizeof(bst::expected<int*, not_found>) == with_flag<int*>);
+static_assert(sizeof(bst::expected<errc, not_found>) == sizeof(errc));
+static_assert(sizeof(bst::expected<small_errc, not_found>) == 1);
+
+// Non-empty errors.
+static_assert(sizeof(bst::expected<int, errc>) == 2 * sizeof(int));
+static_assert(sizeof(bst::expected<node*, errc>) == sizeof(node*));
+static_assert(sizeof(bst::expected<node*, small_errc>) == sizeof(node*));
+static_assert(sizeof(bst::expected<int*, errc>) == with_flag<int*>);
+static_assert(sizeof(bst::expected<errc, small_errc>) == 2 * sizeof(errc));
+static_assert(sizeof(bst::expected<std::string, std::error_code>) ==
+              with_flag<std::string>);
+
+// Niche layouts keep trivial copy construction trivial.
+static_assert(
+    std::is_trivially_copy_constructible_v<bst::expected<void, errc>>);
+static_assert(
+    std::is_trivially_copy_constructible_v<bst::expected<void, node*>>);
+
+// A pointer to a type that is still incomplete gets the same layout as it
+// does once the type is complete: pointers have a niche only where one is
+// opted into, never because of what the pointee looks like at first use.
+static_assert(sizeof(bst::expected<forward_declared*, errc>) ==
+              with_flag<forward_declared*>);
+
+struct forward_declared {
+    std::int64_t value;
+};
+
+static_assert(sizeof(bst::expected<forward_declared*, errc>) ==
+              with_flag<forward_declared*>);
+
+} // namespace layout_tests
+
+//------------------------------------------------------------------------------
+// expected<void, E> with a niche in E
+
+TEST(LayoutTests, VoidWithEnumNiche) {
+    using layout_tests::errc;
+    using E = bst::expected<void, errc>;
+
+    E e;
+    EXPECT_EQ(e.has_value(), true);
+
+    e = bst::unexpected(errc::worse);
+    EXPECT_EQ(e.has_value(), false);
+    EXPECT_EQ(e.error(), errc::worse);
+
+    E copy = e;
+    EXPECT_EQ(copy.error(), errc::worse);
+
+    e.emplace();
+    EXPECT_EQ(e.has_value(), true);
+    EXPECT_EQ(e, E());
+    EXPECT_NE(e, copy);
+
+    e.swap(copy);
+    EXPECT_EQ(e.error(), errc::worse);
+    EXPECT_EQ(copy.has_value(), true);
+
+    EXPECT_EQ(e.or_else([](errc) -> E { return {}; }).has_value(), true);
+    EXPECT_EQ(copy.transform([] { return 3; }).value(), 3);
+}
+
+TEST(LayoutTests, VoidWithPointerNiche) {
+    using E = bst::expected<void, std::unique_ptr<layout_tests::node>>;
+
+    E e;
+    EXPECT_EQ(e.has_value(), true);
+
+    e = bst::unexpected(std::make_unique<layout_tests::node>(7));
+    ASSERT_EQ(e.has_value(), false);
+    EXPECT_EQ(e.error()->value, 7);
+
+    E moved = std::move(e);
+    ASSERT_EQ(moved.has_value(), false);
+    EXPECT_EQ(moved.error()->value, 7);
+
+    moved = E();
+    EXPECT_EQ(moved.has_value(), true);
+}
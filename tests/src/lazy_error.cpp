@@ -0,0 +1,92 @@
+#include <expected/lazy_error.hpp>
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+//------------------------------------------------------------------------------
+
+namespace {
+
+struct message_error {
+    int code;
+    std::string message;
+
+    friend bool operator==(const message_error&,
+                           const message_error&) = default;
+};
+
+using lazy_message = bst::lazy_error<message_error>;
+
+// Counts how many times the error was built.
+bst::expected<int, lazy_message> parse(bool fail, int& built) {
+    if (fail)
+        return bst::unexpected_lazy([&built] {
+            ++built;
+            return message_error{42, "parse failed: " + std::to_string(42)};
+        });
+    return 1;
+}
+
+} // namespace
+
+//------------------------------------------------------------------------------
+// Deferral
+
+TEST(LazyErrorTests, NotBuiltUntilRead) {
+    int built = 0;
+    auto r = parse(true, built);
+    EXPECT_EQ(r.has_value(), false);
+    EXPECT_EQ(built, 0);
+    EXPECT_EQ(r.error().is_materialized(), false);
+
+    EXPECT_EQ(r.error()->code, 42);
+    EXPECT_EQ(r.error().get().message, "parse failed: 42");
+    EXPECT_EQ(built, 1);
+    EXPECT_EQ(r.error().is_materialized(), true);
+}
+
+TEST(LazyErrorTests, EagerConstruction) {
+    bst::expected<int, lazy_message> r(bst::unexpect,
+                                       message_error{1, "eager"});
+    EXPECT_EQ(r.error().is_materialized(), true);
+    EXPECT_EQ(r.error(), (message_error{1, "eager"}));
+}
+
+TEST(LazyErrorTests, CopyAndMove) {
+    int built = 0;
+    auto r1 = parse(true, built);
+    auto r2 = r1;
+    auto r3 = std::move(r1);
+    EXPECT_EQ(built, 0);
+
+    const message_error& e2 = r2.error();
+    EXPECT_EQ(e2.code, 42);
+    EXPECT_EQ(built, 1);
+    EXPECT_EQ(r3.error(), r2.error());
+    EXPECT_EQ(built, 2);
+
+    r2 = parse(true, built);
+    EXPECT_EQ(r2.error().is_materialized(), false);
+    r3 = r2;
+    EXPECT_EQ(built, 2);
+    EXPECT_EQ(r3.error()->message, "parse failed: 42");
+    EXPECT_EQ(built, 3);
+}
+
+TEST(LazyErrorTests, ThrowingFactoryStaysPending) {
+    bst::lazy_error<int> e([]() -> int { throw 1; });
+    EXPECT_THROW(e.get(), int);
+    EXPECT_EQ(e.is_materialized(), false);
+}
+
+TEST(LazyErrorTests, ValueThrows) {
+    int built = 0;
+    auto r = parse(true, built);
+    try {
+        r.value();
+        FAIL();
+    } catch (const bst::bad_expected_access<lazy_message>& e) {
+        EXPECT_EQ(e.error()->code, 42);
+    }
+}
@@ -0,0 +1,249 @@
+//
+// Tests for the no-exceptions mode. This file is compiled with exceptions
+// disabled, so every try/catch in the library must be compiled out.
+//
+
+#include <expected/expected.hpp>
+#include <expected/relocate.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#ifndef BST_EXPECTED_NO_EXCEPTIONS
+#error "BST_EXPECTED_NO_EXCEPTIONS should follow the compiler's setting"
+#endif
+
+//------------------------------------------------------------------------------
+
+namespace {
+
+// Copy and move are not noexcept, which sends assignment through the
+// temporary-and-rollback paths of reinit_expected when exceptions are on.
+struct may_throw {
+    may_throw(int v) : v(v) {}
+    may_throw(const may_throw& rhs) : v(rhs.v) {}
+    may_throw(may_throw&& rhs) : v(rhs.v) {}
+    may_throw& operator=(const may_throw&) = default;
+    may_throw& operator=(may_throw&&) = default;
+
+    int v;
+};
+
+// Copy may throw, move is noexcept.
+struct nothrow_move {
+    nothrow_move(int v) : v(v) {}
+    nothrow_move(const nothrow_move& rhs) : v(rhs.v) {}
+    nothrow_move(nothrow_move&& rhs) noexcept : v(rhs.v) {}
+    nothrow_move& operator=(const nothrow_move&) = default;
+    nothrow_move& operator=(nothrow_move&&) = default;
+
+    int v;
+};
+
+// Counts its copies and moves. Only the move constructor's noexcept differs
+// between the two.
+template <bool NothrowMove>
+struct counted {
+    counted(int v) : v(v) {}
+    counted(const counted& rhs) : v(rhs.v) { ++copies; }
+    counted(counted&& rhs) noexcept(NothrowMove) : v(rhs.v) { ++moves; }
+    counted& operator=(const counted&) = default;
+    counted& operator=(counted&&) = default;
+
+    static void reset() { copies = moves = 0; }
+
+    static inline int copies = 0;
+    static inline int moves = 0;
+    int v;
+};
+
+template <class T, class E>
+void check_value(const bst::expected<T, E>& e, int v) {
+    ASSERT_EQ(e.has_value(), true);
+    EXPECT_EQ(e->v, v);
+}
+
+template <class T, class E>
+void check_error(const bst::expected<T, E>& e, int v) {
+    ASSERT_EQ(e.has_value(), false);
+    EXPECT_EQ(e.error(), v);
+}
+
+template <class T>
+void copy_assignment_paths() {
+    using E = bst::expected<T, int>;
+
+    E a(1), b(2), c(bst::unexpect, 3), d(bst::unexpect, 4);
+
+    a = b; // value <- value
+    check_value(a, 2);
+    a = c; // value <- error
+    check_error(a, 3);
+    a = d; // error <- error
+    check_error(a, 4);
+    a = b; // error <- value
+    check_value(a, 2);
+}
+
+template <class T>
+void move_assignment_paths() {
+    using E = bst::expected<T, int>;
+
+    E a(1);
+    a = E(2);
+    check_value(a, 2);
+    a = E(bst::unexpect, 3);
+    check_error(a, 3);
+    a = E(bst::unexpect, 4);
+    check_error(a, 4);
+    a = E(5);
+    check_value(a, 5);
+}
+
+template <class T>
+void value_and_unexpected_assignment_paths() {
+    using E = bst::expected<T, int>;
+
+    E a(bst::unexpect, 1);
+    T v(2);
+    a = v;
+    check_value(a, 2);
+    a = T(3);
+    check_value(a, 3);
+
+    const bst::unexpected<int> u(4);
+    a = u;
+    check_error(a, 4);
+    a = bst::unexpected(5);
+    check_error(a, 5);
+}
+
+template <class T>
+void swap_paths() {
+    using E = bst::expected<T, int>;
+
+    E a(1), b(bst::unexpect, 2);
+    a.swap(b);
+    check_error(a, 2);
+    check_value(b, 1);
+    a.swap(b);
+    check_value(a, 1);
+    check_error(b, 2);
+}
+
+} // namespace
+
+//------------------------------------------------------------------------------
+// Assignment
+
+TEST(NoExceptionsTests, CopyAssignment) {
+    copy_assignment_paths<may_throw>();
+    copy_assignment_paths<nothrow_move>();
+}
+
+TEST(NoExceptionsTests, MoveAssignment) {
+    move_assignment_paths<may_throw>();
+    move_assignment_paths<nothrow_move>();
+}
+
+TEST(NoExceptionsTests, ValueAndUnexpectedAssignment) {
+    value_and_unexpected_assignment_paths<may_throw>();
+    value_and_unexpected_assignment_paths<nothrow_move>();
+}
+
+TEST(NoExceptionsTests, Swap) {
+    swap_paths<may_throw>();
+    swap_paths<nothrow_move>();
+}
+
+// With exceptions, switching to an alternative whose construction may throw
+// goes through a temporary: the new error is built aside and moved in, or
+// the old error is moved aside to be put back. Without them it is built in
+// place and nothing is moved.
+TEST(NoExceptionsTests, SwitchingMakesNoTemporaries) {
+    using T = counted<false>;
+    using G = counted<true>;
+    using E = bst::expected<T, G>;
+
+    E a(1);
+    const E error(bst::unexpect, 2);
+    const E value(3);
+    T::reset();
+    G::reset();
+
+    a = error; // value to error, copying the error
+    ASSERT_EQ(a.has_value(), false);
+    EXPECT_EQ(a.error().v, 2);
+    EXPECT_EQ(G::copies, 1);
+    EXPECT_EQ(G::moves, 0);
+
+    a = value; // error to value, copying the value
+    ASSERT_EQ(a.has_value(), true);
+    EXPECT_EQ(a->v, 3);
+    EXPECT_EQ(T::copies, 1);
+    EXPECT_EQ(T::moves, 0);
+    EXPECT_EQ(G::moves, 0);
+
+    a = bst::unexpected<G>(4); // value to error, moving the error
+    EXPECT_EQ(a.error().v, 4);
+    a = T(5); // error to value, moving the value
+    EXPECT_EQ(a->v, 5);
+    EXPECT_EQ(T::moves, 1);
+    EXPECT_EQ(G::moves, 1);
+    EXPECT_EQ(T::copies, 1);
+    EXPECT_EQ(G::copies, 1);
+}
+
+TEST(NoExceptionsTests, RelocatingVector) {
+    bst::relocating_vector<bst::expected<std::string, int>> v;
+    for (int i = 0; i < 20; ++i)
+        v.emplace_back(std::to_string(i));
+    auto w = v;
+    EXPECT_EQ(w.size(), 20u);
+    EXPECT_EQ(*w[19], "19");
+}
+
+//------------------------------------------------------------------------------
+// Failure handler
+
+namespace {
+
+[[noreturn]] void report_and_exit(const bst::bad_expected_access<void>& e) {
+    std::fprintf(stderr, "handler: %s\n", e.what());
+    std::exit(3);
+}
+
+} // namespace
+
+TEST(NoExceptionsTests, HandlerInstallation) {
+    auto old = bst::set_bad_expected_access_handler(&report_and_exit);
+    EXPECT_EQ(bst::get_bad_expected_access_handler(), &report_and_exit);
+    EXPECT_EQ(bst::set_bad_expected_access_handler(old), &report_and_exit);
+    EXPECT_EQ(bst::get_bad_expected_access_handler(), old);
+}
+
+TEST(NoExceptionsTests, DefaultHandlerAborts) {
+    bst::expected<int, int> e(bst::unexpect, 1);
+    EXPECT_DEATH(e.value(), "");
+}
+
+TEST(NoExceptionsTests, ValueCallsHandler) {
+    bst::expected<int, std::string> e1(bst::unexpect, "failed");
+    bst::expected<void, int> e2(bst::unexpect, 1);
+
+    EXPECT_EXIT(
+        {
+            bst::set_bad_expected_access_handler(&report_and_exit);
+            e1.value();
+        },
+        testing::ExitedWithCode(3), "handler: bad expected access");
+    EXPECT_EXIT(
+        {
+            bst::set_bad_expected_access_handler(&report_and_exit);
+            std::move(e2).value();
+        },
+        testing::ExitedWithCode(3), "handler: bad expected access");
+}
@@ -0,0 +1,168 @@
+#include <expected/pmr.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+//------------------------------------------------------------------------------
+
+namespace {
+
+using string = std::pmr::string;
+using result = bst::pmr::expected<string, string>;
+using alloc = std::pmr::polymorphic_allocator<>;
+
+enum class errc { failed = 1 };
+
+// Long enough not to fit in a string's inline buffer.
+constexpr std::string_view long_value =
+    "a value that is too long to be stored inline";
+constexpr std::string_view long_error =
+    "an error that is too long to be stored inline";
+
+// Counts the allocations that reach it.
+class counting_resource : public std::pmr::memory_resource {
+public:
+    std::size_t allocations = 0;
+
+private:
+    void* do_allocate(std::size_t bytes, std::size_t align) override {
+        ++allocations;
+        return std::pmr::new_delete_resource()->allocate(bytes, align);
+    }
+
+    void do_deallocate(void* p, std::size_t bytes,
+                       std::size_t align) override {
+        std::pmr::new_delete_resource()->deallocate(p, bytes, align);
+    }
+
+    bool do_is_equal(const memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+// Makes the default resource count, and provides an arena that cannot fall
+// back to the heap.
+class PmrTests : public ::testing::Test {
+protected:
+    void SetUp() override {
+        previous_ = std::pmr::set_default_resource(&default_);
+    }
+
+    void TearDown() override {
+        std::pmr::set_default_resource(previous_);
+        EXPECT_EQ(default_.allocations, 0u);
+    }
+
+    bool in_arena(const string& s) const {
+        return s.get_allocator().resource() == &arena_;
+    }
+
+    counting_resource default_;
+    std::byte buffer_[16 * 1024];
+    std::pmr::monotonic_buffer_resource arena_{
+        buffer_, sizeof buffer_, std::pmr::null_memory_resource()};
+
+private:
+    std::pmr::memory_resource* previous_ = nullptr;
+};
+
+template <class T, class E>
+concept has_pmr_alias = requires { typename bst::pmr::expected<T, E>; };
+
+} // namespace
+
+//------------------------------------------------------------------------------
+
+TEST(UsesAllocatorTests, EitherAlternative) {
+    EXPECT_TRUE((std::uses_allocator_v<bst::expected<string, errc>, alloc>));
+    EXPECT_TRUE((std::uses_allocator_v<bst::expected<int, string>, alloc>));
+    EXPECT_TRUE((std::uses_allocator_v<bst::expected<void, string>, alloc>));
+    EXPECT_FALSE((std::uses_allocator_v<bst::expected<int, errc>, alloc>));
+    EXPECT_FALSE((std::uses_allocator_v<bst::expected<int&, string>, alloc>));
+
+    EXPECT_TRUE((has_pmr_alias<string, errc>));
+    EXPECT_FALSE((has_pmr_alias<int, errc>));
+}
+
+TEST_F(PmrTests, ContainerPassesItsResource) {
+    std::pmr::vector<result> v(&arena_);
+    v.reserve(4);
+    v.emplace_back(long_value);
+    v.emplace_back(bst::unexpect, long_error);
+    v.push_back(v[0]);
+    v.push_back(v[1]);
+
+    ASSERT_TRUE(v[2].has_value());
+    EXPECT_TRUE(in_arena(*v[2]));
+    ASSERT_FALSE(v[3].has_value());
+    EXPECT_TRUE(in_arena(v[3].error()));
+    EXPECT_EQ(v[3].error(), long_error);
+}
+
+TEST_F(PmrTests, AllocatorExtendedConstructors) {
+    const alloc a(&arena_);
+    result x(std::allocator_arg, a, std::in_place, long_value);
+    result e(std::allocator_arg, a, bst::unexpect, long_error);
+    result copy(std::allocator_arg, a, e);
+    result moved(std::allocator_arg, a, std::move(x));
+    result from_unexpected(std::allocator_arg, a,
+                           bst::unexpected<std::string_view>(long_error));
+
+    EXPECT_TRUE(in_arena(copy.error()));
+    EXPECT_TRUE(in_arena(*moved));
+    EXPECT_TRUE(in_arena(from_unexpected.error()));
+
+    bst::expected<string, errc> only_value(std::allocator_arg, a, long_value);
+    bst::expected<string, errc> only_error(std::allocator_arg, a,
+                                           bst::unexpect, errc::failed);
+    EXPECT_TRUE(in_arena(*only_value));
+    EXPECT_EQ(only_error.error(), errc::failed);
+
+    bst::expected<void, string> void_error(std::allocator_arg, a,
+                                           bst::unexpect, long_error);
+    EXPECT_TRUE(in_arena(void_error.error()));
+}
+
+TEST_F(PmrTests, AssignmentKeepsTheResource) {
+    const alloc a(&arena_);
+    result x(std::allocator_arg, a, long_value);
+    const result e(std::allocator_arg, a, bst::unexpect, long_error);
+
+    x = e;
+    ASSERT_FALSE(x.has_value());
+    EXPECT_TRUE(in_arena(x.error()));
+
+    x = long_value;
+    ASSERT_TRUE(x.has_value());
+    EXPECT_TRUE(in_arena(*x));
+
+    x = bst::unexpected<std::string_view>(long_error);
+    ASSERT_FALSE(x.has_value());
+    EXPECT_TRUE(in_arena(x.error()));
+
+    result y(std::allocator_arg, a, long_value);
+    x = std::move(y);
+    ASSERT_TRUE(x.has_value());
+    EXPECT_TRUE(in_arena(*x));
+}
+
+TEST_F(PmrTests, SwapMovesTheResources) {
+    std::byte other_buffer[1024];
+    std::pmr::monotonic_buffer_resource other(
+        other_buffer, sizeof other_buffer, std::pmr::null_memory_resource());
+
+    result x(std::allocator_arg, alloc(&arena_), long_value);
+    result y(std::allocator_arg, alloc(&other), bst::unexpect, long_error);
+    swap(x, y);
+
+    ASSERT_FALSE(x.has_value());
+    EXPECT_EQ(x.error().get_allocator().resource(), &other);
+    ASSERT_TRUE(y.has_value());
+    EXPECT_TRUE(in_arena(*y));
+}
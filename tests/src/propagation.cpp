@@ -0,0 +1,211 @@
+#include <expected/coroutine.hpp>
+#include <expected/try.hpp>
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+//------------------------------------------------------------------------------
+
+namespace {
+
+// Counts copies, so the tests can check that errors are only ever moved.
+struct counted_error {
+    static inline int copies = 0;
+
+    explicit counted_error(int code) : code(code) {}
+    counted_error(const counted_error& rhs) : code(rhs.code) { ++copies; }
+    counted_error(counted_error&&) noexcept = default;
+    counted_error& operator=(const counted_error& rhs) {
+        code = rhs.code;
+        ++copies;
+        return *this;
+    }
+    counted_error& operator=(counted_error&&) noexcept = default;
+
+    int code;
+};
+
+using result = bst::expected<int, counted_error>;
+using void_result = bst::expected<void, counted_error>;
+
+result leaf(int v) {
+    if (v < 0)
+        return bst::unexpected(counted_error(v));
+    return v;
+}
+
+void_result check(int v) {
+    if (v < 0)
+        return bst::unexpected(counted_error(v));
+    return {};
+}
+
+} // namespace
+
+//------------------------------------------------------------------------------
+// BST_TRY
+
+namespace {
+
+int reached = 0;
+
+#ifdef BST_TRY
+result try_chain(int a, int b) {
+    int x = BST_TRY(leaf(a));
+    ++reached;
+    BST_TRY(check(b));
+    ++reached;
+    return x + BST_TRY(leaf(b));
+}
+#endif
+
+result try_assign_chain(int a, int b) {
+    BST_TRY_ASSIGN(int x, leaf(a));
+    ++reached;
+    BST_TRY_ASSIGN(const int y, leaf(b));
+    ++reached;
+    return x + y;
+}
+
+} // namespace
+
+#ifdef BST_TRY
+TEST(TryTests, Expression) {
+    counted_error::copies = 0;
+    reached = 0;
+    EXPECT_EQ(try_chain(1, 2).value(), 3);
+    EXPECT_EQ(reached, 2);
+
+    reached = 0;
+    EXPECT_EQ(try_chain(-1, 2).error().code, -1);
+    EXPECT_EQ(reached, 0);
+
+    reached = 0;
+    EXPECT_EQ(try_chain(1, -2).error().code, -2);
+    EXPECT_EQ(reached, 1);
+    EXPECT_EQ(counted_error::copies, 0);
+}
+#endif
+
+TEST(TryTests, Assign) {
+    counted_error::copies = 0;
+    reached = 0;
+    EXPECT_EQ(try_assign_chain(1, 2).value(), 3);
+    EXPECT_EQ(reached, 2);
+
+    reached = 0;
+    EXPECT_EQ(try_assign_chain(1, -2).error().code, -2);
+    EXPECT_EQ(reached, 1);
+    EXPECT_EQ(counted_error::copies, 0);
+}
+
+//------------------------------------------------------------------------------
+// Coroutines
+
+namespace {
+
+result co_chain(int a, int b) {
+    int x = co_await leaf(a);
+    ++reached;
+    co_await check(b);
+    ++reached;
+    co_return x + co_await leaf(b);
+}
+
+void_result co_void(int a) {
+    co_await leaf(a);
+    ++reached;
+}
+
+bst::expected<std::string, counted_error> co_convert(int a) {
+    result r = leaf(a);
+    int x = co_await r; // lvalue: a failure copies the error
+    co_return std::to_string(x);
+}
+
+result co_unexpected(int a) {
+    if (a < 0)
+        co_return bst::unexpected(counted_error(a));
+    co_return a;
+}
+
+} // namespace
+
+TEST(CoroutineTests, ShortCircuits) {
+    counted_error::copies = 0;
+    reached = 0;
+    EXPECT_EQ(co_chain(1, 2).value(), 3);
+    EXPECT_EQ(reached, 2);
+
+    reached = 0;
+    EXPECT_EQ(co_chain(-1, 2).error().code, -1);
+    EXPECT_EQ(reached, 0);
+
+    reached = 0;
+    EXPECT_EQ(co_chain(1, -2).error().code, -2);
+    EXPECT_EQ(reached, 1);
+    EXPECT_EQ(counted_error::copies, 0);
+}
+
+TEST(CoroutineTests, Void) {
+    reached = 0;
+    EXPECT_EQ(co_void(1).has_value(), true);
+    EXPECT_EQ(reached, 1);
+    EXPECT_EQ(co_void(-1).error().code, -1);
+    EXPECT_EQ(reached, 1);
+}
+
+TEST(CoroutineTests, LvaluesAndReturns) {
+    counted_error::copies = 0;
+    EXPECT_EQ(co_convert(5).value(), "5");
+    EXPECT_EQ(co_convert(-5).error().code, -5);
+    EXPECT_EQ(counted_error::copies, 1);
+
+    EXPECT_EQ(co_unexpected(4).value(), 4);
+    EXPECT_EQ(co_unexpected(-4).error().code, -4);
+}
+
+TEST(CoroutineTests, ExceptionsPropagate) {
+    auto f = [](bool fail) -> result {
+        if (fail)
+            throw 1;
+        co_return 0;
+    };
+    EXPECT_EQ(f(false).value(), 0);
+    EXPECT_THROW(f(true), int);
+}
+
+// Some compilers convert the return object before running the body; drive
+// the promise by hand to cover that order.
+TEST(CoroutineTests, EagerReturnObjectConversion) {
+    bst::detail::expected_promise<int, counted_error> p;
+    result r = p.get_return_object();
+    p.return_value(7);
+    EXPECT_EQ(r.value(), 7);
+
+    bst::detail::expected_promise<void, counted_error> q;
+    void_result v = q.get_return_object();
+    q.emplace(bst::unexpect, counted_error(3));
+    EXPECT_EQ(v.error().code, 3);
+}
+
+// Moving the return object carries the result with it, whether the body has
+// already run or not.
+TEST(CoroutineTests, ReturnObjectMoves) {
+    using holder = bst::detail::expected_return<std::string, counted_error>;
+
+    bst::detail::expected_promise<std::string, counted_error> p;
+    holder h = p.get_return_object();
+    p.return_value(std::string(40, 'x'));
+    holder moved(std::move(h));
+    bst::expected<std::string, counted_error> r = moved;
+    EXPECT_EQ(r.value(), std::string(40, 'x'));
+
+    bst::detail::expected_promise<std::string, counted_error> q;
+    holder g = q.get_return_object();
+    holder early(std::move(g));
+    q.emplace(bst::unexpect, counted_error(5));
+    bst::expected<std::string, counted_error> s = early;
+    EXPECT_EQ(s.error().code, 5);
+}
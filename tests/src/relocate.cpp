@@ -0,0 +1,136 @@
+#include <expected/relocate.hpp>
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <type_traits>
+
+//------------------------------------------------------------------------------
+
+namespace static_tests {
+
+struct opted_in {
+    opted_in() = default;
+    opted_in(const opted_in&) {}
+};
+
+} // namespace static_tests
+
+template <>
+struct bst::is_trivially_relocatable<static_tests::opted_in> : std::true_type {
+};
+
+namespace static_tests {
+
+static_assert(bst::is_trivially_relocatable_v<bst::expected<int, int>>);
+static_assert(
+    bst::is_trivially_relocatable_v<bst::expected<std::unique_ptr<int>, int>>);
+static_assert(bst::is_trivially_relocatable_v<bst::expected<void, int>>);
+static_assert(
+    bst::is_trivially_relocatable_v<bst::expected<std::string&, int>>);
+static_assert(bst::is_trivially_relocatable_v<bst::unexpected<int>>);
+static_assert(bst::is_trivially_relocatable_v<bst::expected<opted_in, int>>);
+static_assert(
+    !bst::is_trivially_relocatable_v<bst::expected<std::string, int>>);
+static_assert(
+    !bst::is_trivially_relocatable_v<bst::expected<int, std::string>>);
+
+} // namespace static_tests
+
+//------------------------------------------------------------------------------
+// Relocation
+
+TEST(RelocateTests, TriviallyRelocatable) {
+    using E = bst::expected<std::unique_ptr<int>, int>;
+
+    alignas(E) unsigned char src[3 * sizeof(E)];
+    alignas(E) unsigned char dst[3 * sizeof(E)];
+    E* s = reinterpret_cast<E*>(src);
+    E* d = reinterpret_cast<E*>(dst);
+
+    std::construct_at(s + 0, std::make_unique<int>(1));
+    std::construct_at(s + 1, bst::unexpect, 2);
+    std::construct_at(s + 2, std::make_unique<int>(3));
+
+    EXPECT_EQ(bst::relocate_n(s, 3, d), d + 3);
+    EXPECT_EQ(**d[0], 1);
+    EXPECT_EQ(d[1].error(), 2);
+    EXPECT_EQ(**d[2], 3);
+
+    std::destroy(d, d + 3);
+}
+
+TEST(RelocateTests, NonTriviallyRelocatable) {
+    using E = bst::expected<std::string, int>;
+
+    alignas(E) unsigned char src[2 * sizeof(E)];
+    alignas(E) unsigned char dst[2 * sizeof(E)];
+    E* s = reinterpret_cast<E*>(src);
+    E* d = reinterpret_cast<E*>(dst);
+
+    std::construct_at(s + 0, "a string too long for the small buffer");
+    std::construct_at(s + 1, bst::unexpect, 5);
+
+    EXPECT_EQ(bst::uninitialized_relocate(s, s + 2, d), d + 2);
+    EXPECT_EQ(*d[0], "a string too long for the small buffer");
+    EXPECT_EQ(d[1].error(), 5);
+
+    std::destroy(d, d + 2);
+}
+
+//------------------------------------------------------------------------------
+// relocating_vector
+
+TEST(RelocatingVectorTests, Growth) {
+    bst::relocating_vector<bst::expected<std::unique_ptr<int>, int>> v;
+    for (int i = 0; i < 100; ++i) {
+        if (i % 3)
+            v.emplace_back(std::make_unique<int>(i));
+        else
+            v.emplace_back(bst::unexpect, i);
+    }
+
+    EXPECT_EQ(v.size(), 100u);
+    EXPECT_GE(v.capacity(), 100u);
+    for (int i = 0; i < 100; ++i) {
+        if (i % 3)
+            EXPECT_EQ(**v[i], i);
+        else
+            EXPECT_EQ(v[i].error(), i);
+    }
+
+    v.pop_back();
+    EXPECT_EQ(v.size(), 99u);
+    v.clear();
+    EXPECT_EQ(v.empty(), true);
+}
+
+TEST(RelocatingVectorTests, SelfReferencingPush) {
+    bst::relocating_vector<bst::expected<std::string, int>> v;
+    v.emplace_back("first element, longer than the small buffer");
+    for (int i = 0; i < 10; ++i)
+        v.push_back(v.front());
+
+    EXPECT_EQ(v.size(), 11u);
+    for (const auto& e : v)
+        EXPECT_EQ(*e, "first element, longer than the small buffer");
+}
+
+TEST(RelocatingVectorTests, CopyAndMove) {
+    bst::relocating_vector<bst::expected<std::string, int>> v1;
+    v1.emplace_back("x");
+    v1.emplace_back(bst::unexpect, 1);
+
+    auto v2 = v1;
+    EXPECT_EQ(v2.size(), 2u);
+    EXPECT_EQ(*v2[0], "x");
+    EXPECT_EQ(v2[1].error(), 1);
+
+    auto v3 = std::move(v1);
+    EXPECT_EQ(v3.size(), 2u);
+    EXPECT_EQ(v1.size(), 0u);
+
+    v1 = v3;
+    EXPECT_EQ(v1.size(), 2u);
+}
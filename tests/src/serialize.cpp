@@ -0,0 +1,266 @@
+#include <expected/serialize.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------------
+
+namespace {
+
+enum class errc : std::int32_t { invalid = 1, overflow };
+
+struct point {
+    std::int32_t x, y, z;
+    friend bool operator==(const point&, const point&) = default;
+};
+
+using result = bst::expected<std::int64_t, errc>;
+
+// Storage aligned to 8 bytes, as the encodings assume.
+struct buffer {
+    explicit buffer(std::size_t bytes) : words((bytes + 7) / 8) {}
+
+    std::span<std::byte> bytes() { return std::as_writable_bytes(span()); }
+    std::span<const std::byte> cbytes() { return std::as_bytes(span()); }
+    std::span<std::uint64_t> span() { return words; }
+
+    std::vector<std::uint64_t> words;
+};
+
+} // namespace
+
+// A string encoded as its characters.
+template <>
+struct bst::serializer<std::string> {
+    static std::size_t size(const std::string& s) { return s.size(); }
+
+    static void write(const std::string& s, std::span<std::byte> out) {
+        std::memcpy(out.data(), s.data(), s.size());
+    }
+
+    static bst::expected<std::string, bst::encoding_errc>
+    read(std::span<const std::byte> in) {
+        return std::string(reinterpret_cast<const char*>(in.data()),
+                           in.size());
+    }
+};
+
+//------------------------------------------------------------------------------
+// Records
+
+TEST(SerializeTests, RecordLayout) {
+    buffer b(64);
+    const result x = 0x0102030405060708;
+    ASSERT_EQ(bst::encoded_size(x), 16u);
+    ASSERT_EQ(bst::encode(x, b.bytes()), 16u);
+
+    const auto bytes = b.cbytes();
+    EXPECT_EQ(bytes[0], std::byte{1});
+    EXPECT_EQ(bytes[3], std::byte{0});
+    std::uint32_t n = 0;
+    std::memcpy(&n, bytes.data() + 4, 4);
+    EXPECT_EQ(n, 8u);
+    std::int64_t v = 0;
+    std::memcpy(&v, bytes.data() + 8, 8);
+    EXPECT_EQ(v, *x);
+
+    // The error is 4 bytes, padded to 8 with zeros.
+    b.words.assign(b.words.size(), ~std::uint64_t(0));
+    const result e = bst::unexpected(errc::overflow);
+    ASSERT_EQ(bst::encode(e, b.bytes()), 16u);
+    EXPECT_EQ(bytes[0], std::byte{0});
+    std::memcpy(&n, bytes.data() + 4, 4);
+    EXPECT_EQ(n, 4u);
+    for (std::size_t i = 12; i != 16; ++i)
+        EXPECT_EQ(bytes[i], std::byte{0});
+}
+
+TEST(SerializeTests, RecordRoundTrip) {
+    buffer b(64);
+    for (const result& x : {result(42), result(bst::unexpect, errc::invalid)}) {
+        ASSERT_TRUE(bst::encode(x, b.bytes()));
+        const auto d = bst::decode<std::int64_t, errc>(b.cbytes());
+        ASSERT_TRUE(d.has_value());
+        EXPECT_EQ(*d, x);
+    }
+
+    const bst::expected<void, errc> ok;
+    ASSERT_EQ(bst::encode(ok, b.bytes()), 8u);
+    EXPECT_TRUE((bst::decode<void, errc>(b.cbytes()))->has_value());
+}
+
+TEST(SerializeTests, RecordsInSequence) {
+    const std::vector<bst::expected<point, errc>> in = {
+        point{1, 2, 3}, bst::unexpected(errc::invalid), point{4, 5, 6}};
+    buffer b(128);
+    std::size_t used = 0;
+    for (const auto& x : in)
+        used += *bst::encode(x, b.bytes().subspan(used));
+
+    std::vector<bst::expected<point, errc>> out;
+    auto rest = b.cbytes().first(used);
+    while (!rest.empty()) {
+        out.push_back(*bst::decode<point, errc>(rest));
+        rest = rest.subspan(*bst::record_size(rest));
+    }
+    EXPECT_EQ(out, in);
+}
+
+TEST(SerializeTests, RejectsBadRecords) {
+    buffer b(64);
+    const result x = 7;
+    EXPECT_EQ(bst::encode(x, b.bytes().first(15)).error(),
+              bst::encoding_errc::buffer_too_small);
+    ASSERT_TRUE(bst::encode(x, b.bytes()));
+
+    EXPECT_EQ((bst::decode<std::int64_t, errc>(b.cbytes().first(12))).error(),
+              bst::encoding_errc::truncated);
+    EXPECT_EQ((bst::decode<std::int32_t, errc>(b.cbytes())).error(),
+              bst::encoding_errc::bad_header);
+
+    b.bytes()[0] = std::byte{2};
+    EXPECT_EQ((bst::decode<std::int64_t, errc>(b.cbytes())).error(),
+              bst::encoding_errc::bad_header);
+    EXPECT_EQ(bst::record_size(b.cbytes()).error(),
+              bst::encoding_errc::bad_header);
+}
+
+TEST(SerializeTests, ViewReadsInPlace) {
+    buffer b(64);
+    const bst::expected<point, errc> x = point{1, 2, 3};
+    ASSERT_TRUE(bst::encode(x, b.bytes()));
+
+    const auto v = bst::view_record<point, errc>(b.cbytes());
+    ASSERT_TRUE(v.has_value());
+    ASSERT_TRUE(v->has_value());
+    EXPECT_EQ(**v, x.value());
+    EXPECT_EQ(reinterpret_cast<const std::byte*>(&**v), b.cbytes().data() + 8);
+    EXPECT_EQ(v->size(), 24u);
+    EXPECT_EQ(v->get(), x);
+
+    const bst::expected<point, errc> e = bst::unexpected(errc::overflow);
+    ASSERT_TRUE(bst::encode(e, b.bytes()));
+    const auto ve = bst::view_record<point, errc>(b.cbytes());
+    ASSERT_FALSE(ve->has_value());
+    EXPECT_EQ(ve->error(), errc::overflow);
+
+    // A record that starts 4 bytes into the buffer has a misaligned payload.
+    ASSERT_TRUE(bst::encode(result(1), b.bytes().subspan(4)));
+    EXPECT_EQ((bst::view_record<std::int64_t, errc>(b.cbytes().subspan(4)))
+                  .error(),
+              bst::encoding_errc::misaligned);
+    EXPECT_EQ((bst::decode<std::int64_t, errc>(b.cbytes().subspan(4)))->value(),
+              1);
+}
+
+TEST(SerializeTests, CustomSerializer) {
+    using text_result = bst::expected<std::string, errc>;
+    buffer b(128);
+    const text_result x = "a value longer than a short string";
+    ASSERT_EQ(bst::encode(x, b.bytes()), 8u + 40u);
+    EXPECT_EQ(*(bst::decode<std::string, errc>(b.cbytes())), x);
+
+    const bst::expected<int, std::string> e =
+        bst::unexpected(std::string("failed"));
+    ASSERT_EQ(bst::encode(e, b.bytes()), 16u);
+    EXPECT_EQ((bst::decode<int, std::string>(b.cbytes()))->error(), "failed");
+}
+
+//------------------------------------------------------------------------------
+// Columns
+
+namespace {
+
+// Every fifth element is an error, so the pattern straddles bitmap words.
+std::vector<result> make_results(int n) {
+    std::vector<result> v;
+    for (int i = 0; i < n; ++i) {
+        if (i % 5 == 0)
+            v.emplace_back(bst::unexpect, errc::overflow);
+        else
+            v.emplace_back(i);
+    }
+    return v;
+}
+
+} // namespace
+
+TEST(SerializeTests, ColumnsRoundTrip) {
+    for (int n : {0, 1, 63, 64, 65, 200}) {
+        const auto in = make_results(n);
+        const std::size_t size = bst::encoded_columns_size(in);
+        buffer b(size);
+        ASSERT_EQ(bst::encode_columns(in, b.bytes()), size);
+
+        const auto v = bst::view_columns<std::int64_t, errc>(b.cbytes());
+        ASSERT_TRUE(v.has_value()) << n;
+        ASSERT_EQ(v->size(), in.size());
+        EXPECT_EQ(v->error_count(), (in.size() + 4) / 5);
+        EXPECT_EQ(v->value_count() + v->error_count(), in.size());
+
+        std::vector<result> out(in.size());
+        v->decode(out);
+        EXPECT_EQ(out, in);
+    }
+}
+
+TEST(SerializeTests, ColumnsReadInPlace) {
+    const auto in = make_results(10);
+    buffer b(bst::encoded_columns_size(in));
+    ASSERT_TRUE(bst::encode_columns(in, b.bytes()));
+
+    const auto v = bst::view_columns<std::int64_t, errc>(b.cbytes());
+    ASSERT_TRUE(v.has_value());
+    EXPECT_EQ(v->values().size(), 8u);
+    EXPECT_EQ(v->values()[0], 1);
+    EXPECT_EQ(v->values()[4], 6);
+    EXPECT_EQ(v->errors().size(), 2u);
+    EXPECT_EQ(v->errors()[1], errc::overflow);
+    EXPECT_FALSE(v->has_value(5));
+    EXPECT_TRUE(v->has_value(9));
+
+    const auto* first = reinterpret_cast<const std::byte*>(v->values().data());
+    EXPECT_GT(first, b.cbytes().data());
+    EXPECT_LT(first, b.cbytes().data() + b.cbytes().size());
+}
+
+TEST(SerializeTests, RejectsBadColumns) {
+    const auto in = make_results(70);
+    buffer b(bst::encoded_columns_size(in) + 8);
+    const std::size_t size = *bst::encode_columns(in, b.bytes());
+
+    EXPECT_EQ(bst::encode_columns(in, b.bytes().first(size - 1)).error(),
+              bst::encoding_errc::buffer_too_small);
+    const auto short_input = b.cbytes().first(size - 8);
+    EXPECT_EQ((bst::view_columns<std::int64_t, errc>(short_input)).error(),
+              bst::encoding_errc::truncated);
+    EXPECT_EQ((bst::view_columns<std::int32_t, errc>(b.cbytes())).error(),
+              bst::encoding_errc::bad_header);
+
+    // A bit past the last element would make the columns disagree with the
+    // bitmap.
+    b.span()[4 + 1] |= std::uint64_t(1) << 63;
+    EXPECT_EQ((bst::view_columns<std::int64_t, errc>(b.cbytes())).error(),
+              bst::encoding_errc::bad_header);
+    b.span()[4 + 1] &= ~(std::uint64_t(1) << 63);
+
+    // So would a count of values that is off by one.
+    b.span()[3] += 1;
+    EXPECT_EQ((bst::view_columns<std::int64_t, errc>(b.cbytes())).error(),
+              bst::encoding_errc::bad_header);
+    b.span()[3] -= 1;
+    EXPECT_TRUE((bst::view_columns<std::int64_t, errc>(b.cbytes())));
+
+    buffer shifted(size + 8);
+    std::memcpy(shifted.bytes().data() + 4, b.cbytes().data(), size);
+    EXPECT_EQ((bst::view_columns<std::int64_t, errc>(
+                   shifted.cbytes().subspan(4, size)))
+                  .error(),
+              bst::encoding_errc::misaligned);
+}
@@ -3,7 +3,9 @@
 #include <gtest/gtest.h>
 
 #include <memory>
+#include <string>
 #include <type_traits>
+#include <utility>
 
 //------------------------------------------------------------------------------
 
@@ -66,6 +68,81 @@ static_assert(std::is_constructible_v<bst::expected<int, int>,
 static_assert(
     std::is_constructible_v<bst::expected<A, int>, bst::expected<int, int>&&>);
 
+// Niche layout: the discriminant lives in the spare bits of T.
+enum class errc : int { bad = 1, worse = 2 };
+enum class color : unsigned char { red, green, blue };
+struct empty_error {};
+struct node {
+    int value;
+};
+struct big {
+    int data[64];
+};
+
+} // namespace static_tests
+
+template <>
+struct bst::expected_niche_traits<static_tests::color>
+    : bst::enum_niche_traits<static_tests::color,
+                             static_tests::color(0xff)> {};
+
+template <>
+struct bst::expected_niche_traits<static_tests::node*>
+    : bst::pointer_niche_traits<static_tests::node*> {};
+
+template <>
+struct bst::expected_niche_traits<std::unique_ptr<static_tests::node>>
+    : bst::pointer_niche_traits<std::unique_ptr<static_tests::node>> {};
+
+template <>
+struct bst::expected_niche_traits<std::reference_wrapper<static_tests::node>>
+    : bst::pointer_niche_traits<std::reference_wrapper<static_tests::node>> {};
+
+template <>
+struct bst::expected_niche_traits<static_tests::big*>
+    : bst::pointer_niche_traits<static_tests::big*> {};
+
+template <>
+struct bst::expected_niche_traits<const static_tests::big*>
+    : bst::pointer_niche_traits<const static_tests::big*> {};
+
+namespace static_tests {
+
+static_assert(sizeof(bst::expected<node*, errc>) == sizeof(node*));
+static_assert(sizeof(bst::expected<node*, short>) == sizeof(node*));
+static_assert(sizeof(bst::expected<node*, char>) == sizeof(node*));
+static_assert(sizeof(bst::expected<std::unique_ptr<node>, errc>) ==
+              sizeof(node*));
+static_assert(sizeof(bst::expected<std::reference_wrapper<node>, errc>) ==
+              sizeof(node*));
+static_assert(sizeof(bst::expected<node*, empty_error>) == sizeof(node*));
+static_assert(sizeof(bst::expected<color, empty_error>) == sizeof(color));
+
+// No niche, or the error does not fit beside it. Pointers have a niche only
+// where it is opted into.
+static_assert(sizeof(bst::expected<int*, errc>) > sizeof(int*));
+static_assert(sizeof(bst::expected<char*, errc>) > sizeof(char*));
+static_assert(sizeof(bst::expected<node*, long long>) > sizeof(node*));
+static_assert(sizeof(bst::expected<color, errc>) > sizeof(errc));
+static_assert(sizeof(bst::expected<int, errc>) > sizeof(int));
+
+// Niche layouts keep trivial copy construction trivial.
+static_assert(
+    std::is_trivially_copy_constructible_v<bst::expected<node*, errc>>);
+
+// References are held as a pointer, sharing the niche of the pointer.
+static_assert(sizeof(bst::expected<big&, errc>) == sizeof(big*));
+static_assert(sizeof(bst::expected<const big&, empty_error>) == sizeof(big*));
+static_assert(
+    std::is_trivially_copy_constructible_v<bst::expected<big&, errc>>);
+static_assert(std::is_constructible_v<bst::expected<const big&, errc>,
+                                      bst::expected<big&, errc>>);
+static_assert(!std::is_constructible_v<bst::expected<big&, errc>,
+                                       bst::expected<const big&, errc>>);
+static_assert(!std::is_constructible_v<bst::expected<const big&, errc>, big>);
+static_assert(!std::is_constructible_v<bst::expected<const big&, errc>,
+                                       const big&&>);
+
 } // namespace static_tests
 
 //------------------------------------------------------------------------------
@@ -262,6 +339,86 @@ TEST(AssignmentTests, MoveAssignFromUserDeclared) {
     EXPECT_EQ(*e1, 100);
 }
 
+namespace {
+
+// Neither alternative is nothrow move constructible, and either can be told
+// to throw on its next copy or move.
+struct fragile {
+    static inline int moves = 0;
+    static inline bool fail = false;
+
+    explicit fragile(int v) : v(v) {}
+    fragile(const fragile& rhs) : v(rhs.v) { check(); }
+    fragile(fragile&& rhs) noexcept(false) : v(rhs.v) {
+        ++moves;
+        check();
+    }
+    fragile& operator=(const fragile&) = default;
+    fragile& operator=(fragile&&) = default;
+
+    static void check() {
+        if (fail)
+            throw 1;
+    }
+
+    int v;
+};
+
+struct fragile_error {
+    fragile_error() noexcept = default;
+    explicit fragile_error(int code) noexcept : code(code) {}
+    fragile_error(const fragile_error&) = default;
+    fragile_error(fragile_error&& rhs) noexcept(false) : code(rhs.code) {}
+    fragile_error& operator=(const fragile_error&) = default;
+    fragile_error& operator=(fragile_error&&) = default;
+
+    int code = 0;
+};
+
+struct strong_error : fragile_error {
+    using fragile_error::fragile_error;
+};
+
+} // namespace
+
+template <>
+struct bst::expected_basic_guarantee<fragile, fragile_error>
+    : std::true_type {};
+
+static_assert(
+    std::is_move_assignable_v<bst::expected<fragile, fragile_error>>);
+static_assert(
+    !std::is_move_assignable_v<bst::expected<fragile, strong_error>>);
+
+TEST(AssignmentTests, BasicGuaranteeConstructsInPlace) {
+    using E = bst::expected<fragile, fragile_error>;
+    E e1 = bst::unexpected(fragile_error(3));
+    E e2(std::in_place, 7);
+
+    fragile::moves = 0;
+    e1 = std::move(e2);
+    EXPECT_EQ(e1->v, 7);
+    EXPECT_EQ(fragile::moves, 1);
+
+    e1 = bst::unexpected(fragile_error(4));
+    EXPECT_EQ(e1.error().code, 4);
+    e1 = fragile(8);
+    EXPECT_EQ(e1->v, 8);
+    EXPECT_EQ(fragile::moves, 2);
+}
+
+TEST(AssignmentTests, BasicGuaranteeLeavesErrorOnThrow) {
+    using E = bst::expected<fragile, fragile_error>;
+    E e1 = bst::unexpected(fragile_error(3));
+    const E e2(std::in_place, 7);
+
+    fragile::fail = true;
+    EXPECT_THROW(e1 = e2, int);
+    fragile::fail = false;
+    ASSERT_EQ(e1.has_value(), false);
+    EXPECT_EQ(e1.error().code, 0);
+}
+
 //------------------------------------------------------------------------------
 // Swapping
 
@@ -308,3 +465,263 @@ TEST(SwapTests, InactiveWithActive) {
     EXPECT_EQ(*e1, 2);
     EXPECT_EQ(e2.error(), 1);
 }
+
+//------------------------------------------------------------------------------
+// Observers
+
+TEST(ObserverTests, ValueThrowsOnError) {
+    bst::expected<int, std::string> e1(bst::unexpect, "failed");
+    try {
+        e1.value();
+        FAIL() << "value() did not throw";
+    } catch (const bst::bad_expected_access<std::string>& ex) {
+        EXPECT_EQ(ex.error(), "failed");
+    }
+
+    try {
+        std::move(e1).value();
+        FAIL() << "value() did not throw";
+    } catch (const bst::bad_expected_access<std::string>& ex) {
+        EXPECT_EQ(ex.error(), "failed");
+    }
+
+    bst::expected<void, int> e2(bst::unexpect, 3);
+    EXPECT_THROW(e2.value(), bst::bad_expected_access<int>);
+
+    bst::expected<int, std::string> e3(1);
+    EXPECT_EQ(e3.value(), 1);
+}
+
+//------------------------------------------------------------------------------
+// Monadic operations
+
+TEST(MonadicTests, AndThen) {
+    auto half = [](int x) -> bst::expected<int, int> {
+        if (x % 2)
+            return bst::unexpected(x);
+        return x / 2;
+    };
+
+    bst::expected<int, int> e1(8);
+    auto e2 = e1.and_then(half).and_then(half);
+    EXPECT_EQ(e2.has_value(), true);
+    EXPECT_EQ(*e2, 2);
+
+    auto e3 = e1.and_then(half).and_then(half).and_then(half).and_then(half);
+    EXPECT_EQ(e3.has_value(), false);
+    EXPECT_EQ(e3.error(), 1);
+
+    bst::expected<int, int> e4(bst::unexpect, 7);
+    EXPECT_EQ(e4.and_then(half).error(), 7);
+}
+
+TEST(MonadicTests, AndThenMovesValue) {
+    bst::expected<std::unique_ptr<int>, int> e1(std::make_unique<int>(42));
+    auto e2 = std::move(e1).and_then(
+        [](std::unique_ptr<int>&& p) -> bst::expected<int, int> { return *p; });
+    EXPECT_EQ(*e2, 42);
+}
+
+TEST(MonadicTests, OrElse) {
+    auto recover = [](int err) -> bst::expected<int, int> {
+        if (err < 0)
+            return bst::unexpected(err);
+        return 0;
+    };
+
+    bst::expected<int, int> e1(bst::unexpect, 3);
+    auto e2 = e1.or_else(recover);
+    EXPECT_EQ(e2.has_value(), true);
+    EXPECT_EQ(*e2, 0);
+
+    bst::expected<int, int> e3(bst::unexpect, -3);
+    EXPECT_EQ(e3.or_else(recover).error(), -3);
+
+    const bst::expected<int, int> e4(5);
+    EXPECT_EQ(*e4.or_else(recover), 5);
+}
+
+TEST(MonadicTests, Transform) {
+    bst::expected<int, int> e1(21);
+    auto e2 = e1.transform([](int x) { return std::to_string(x * 2); });
+    static_assert(
+        std::is_same_v<decltype(e2), bst::expected<std::string, int>>);
+    EXPECT_EQ(*e2, "42");
+
+    auto e3 = e1.transform([](int) {});
+    static_assert(std::is_same_v<decltype(e3), bst::expected<void, int>>);
+    EXPECT_EQ(e3.has_value(), true);
+
+    bst::expected<int, int> e4(bst::unexpect, 9);
+    EXPECT_EQ(e4.transform([](int x) { return x + 1; }).error(), 9);
+}
+
+TEST(MonadicTests, TransformError) {
+    bst::expected<int, int> e1(bst::unexpect, 4);
+    auto e2 = e1.transform_error([](int e) { return std::to_string(e); });
+    static_assert(
+        std::is_same_v<decltype(e2), bst::expected<int, std::string>>);
+    EXPECT_EQ(e2.error(), "4");
+
+    bst::expected<int, int> e3(4);
+    EXPECT_EQ(*e3.transform_error([](int e) { return e + 1; }), 4);
+    EXPECT_EQ(e1.transform_or([](int e) { return e + 1; }).error(), 5);
+}
+
+TEST(MonadicTests, VoidExpected) {
+    bst::expected<void, int> e1;
+    auto e2 = e1.and_then([] { return bst::expected<int, int>(3); });
+    EXPECT_EQ(*e2, 3);
+
+    auto e3 = e1.transform([] { return 4; });
+    EXPECT_EQ(*e3, 4);
+
+    bst::expected<void, int> e4(bst::unexpect, 5);
+    EXPECT_EQ(e4.transform([] { return 4; }).error(), 5);
+    EXPECT_EQ(e4.transform_error([](int e) { return e * 2; }).error(), 10);
+    EXPECT_EQ(
+        e4.or_else([](int) { return bst::expected<void, long>(); }).has_value(),
+        true);
+}
+
+//------------------------------------------------------------------------------
+// Niche layout
+
+TEST(NicheTests, Pointer) {
+    static_tests::node x{42};
+    bst::expected<static_tests::node*, static_tests::errc> e1(&x);
+    EXPECT_EQ(e1.has_value(), true);
+    EXPECT_EQ((*e1)->value, 42);
+
+    bst::expected<static_tests::node*, static_tests::errc> e2(nullptr);
+    EXPECT_EQ(e2.has_value(), true);
+    EXPECT_EQ(*e2, nullptr);
+
+    e1 = bst::unexpected(static_tests::errc::worse);
+    EXPECT_EQ(e1.has_value(), false);
+    EXPECT_EQ(e1.error(), static_tests::errc::worse);
+
+    e2 = e1;
+    EXPECT_EQ(e2.has_value(), false);
+    EXPECT_EQ(e2.error(), static_tests::errc::worse);
+
+    e1 = &x;
+    EXPECT_EQ(e1.has_value(), true);
+    EXPECT_EQ(*e1, &x);
+
+    e1.swap(e2);
+    EXPECT_EQ(e1.has_value(), false);
+    EXPECT_EQ(e1.error(), static_tests::errc::worse);
+    EXPECT_EQ(*e2, &x);
+}
+
+TEST(NicheTests, UniquePtr) {
+    using E = bst::expected<std::unique_ptr<static_tests::node>, static_tests::errc>;
+
+    E e1(std::make_unique<static_tests::node>(7));
+    E e2(bst::unexpect, static_tests::errc::bad);
+    EXPECT_EQ(e2.has_value(), false);
+    EXPECT_EQ(e2.error(), static_tests::errc::bad);
+
+    e2 = std::move(e1);
+    EXPECT_EQ(e2.has_value(), true);
+    EXPECT_EQ((*e2)->value, 7);
+
+    e2 = bst::unexpected(static_tests::errc::worse);
+    EXPECT_EQ(e2.has_value(), false);
+
+    E e3(std::move(e2));
+    EXPECT_EQ(e3.has_value(), false);
+    EXPECT_EQ(e3.error(), static_tests::errc::worse);
+
+    e3.emplace(new static_tests::node{3});
+    EXPECT_EQ(e3.has_value(), true);
+    EXPECT_EQ((*e3)->value, 3);
+}
+
+TEST(NicheTests, Enum) {
+    using E = bst::expected<static_tests::color, static_tests::empty_error>;
+
+    E e1(static_tests::color::blue);
+    EXPECT_EQ(e1.has_value(), true);
+    EXPECT_EQ(*e1, static_tests::color::blue);
+
+    e1 = bst::unexpected(static_tests::empty_error{});
+    EXPECT_EQ(e1.has_value(), false);
+
+    auto e2 = e1.or_else([](static_tests::empty_error) {
+        return E(static_tests::color::red);
+    });
+    EXPECT_EQ(*e2, static_tests::color::red);
+}
+
+//------------------------------------------------------------------------------
+// References
+
+TEST(ReferenceTests, BindAndRebind) {
+    int a = 1, b = 2;
+    bst::expected<int&, std::string> e(a);
+    EXPECT_EQ(&*e, &a);
+    EXPECT_EQ(&e.value(), &a);
+
+    *e = 10;
+    EXPECT_EQ(a, 10);
+
+    e = b; // rebinds, a is untouched
+    EXPECT_EQ(&*e, &b);
+    EXPECT_EQ(a, 10);
+
+    e = bst::unexpected(std::string("missing"));
+    EXPECT_EQ(e.has_value(), false);
+    EXPECT_EQ(e.error(), "missing");
+    EXPECT_THROW(e.value(), bst::bad_expected_access<std::string>);
+    EXPECT_EQ(e.value_or(5), 5);
+
+    e.emplace(a);
+    EXPECT_EQ(e.value_or(5), 10);
+}
+
+TEST(ReferenceTests, ConvertToConst) {
+    std::string s = "cached";
+    bst::expected<std::string&, int> e(s);
+    bst::expected<const std::string&, int> c = e;
+    EXPECT_EQ(&*c, &s);
+    EXPECT_EQ(c->size(), 6u);
+
+    bst::expected<const std::string&, int> u(bst::unexpect, 3);
+    EXPECT_EQ(u.error(), 3);
+
+    bst::expected<std::string, int> copy = c;
+    EXPECT_EQ(*copy, "cached");
+    EXPECT_EQ(c == copy, true);
+    EXPECT_EQ(c == std::string("cached"), true);
+    EXPECT_EQ(u == bst::unexpected(3), true);
+}
+
+TEST(ReferenceTests, Monadic) {
+    std::pair<int, std::string> p{1, "second"};
+    bst::expected<std::pair<int, std::string>&, int> e(p);
+
+    // A projection returning a reference stays a reference.
+    auto second = e.transform(
+        [](auto& v) -> std::string& { return v.second; });
+    static_assert(
+        std::is_same_v<decltype(second), bst::expected<std::string&, int>>);
+    EXPECT_EQ(&*second, &p.second);
+
+    auto size = second.transform([](const std::string& v) { return v.size(); });
+    EXPECT_EQ(*size, 6u);
+
+    auto chained = e.and_then([](auto& v) {
+        return bst::expected<int, int>(v.first + 1);
+    });
+    EXPECT_EQ(*chained, 2);
+
+    bst::expected<std::pair<int, std::string>&, int> err(bst::unexpect, 4);
+    auto text = err.transform_error([](int v) { return std::to_string(v); });
+    EXPECT_EQ(text.error(), "4");
+    auto recovered = err.or_else([&p](int) {
+        return bst::expected<std::pair<int, std::string>&, int>(p);
+    });
+    EXPECT_EQ(&*recovered, &p);
+}
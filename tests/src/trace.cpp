@@ -0,0 +1,118 @@
+#include <expected/trace.hpp>
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <string_view>
+#include <thread>
+
+//------------------------------------------------------------------------------
+
+namespace {
+
+enum class io_errc { eof = 1, timeout };
+
+using result = bst::expected<int, bst::traced<io_errc>>;
+
+int failing_line = 0;
+
+result read_byte(bool fail) {
+    if (fail) {
+        failing_line = __LINE__ + 1;
+        return bst::unexpected_traced(io_errc::timeout);
+    }
+    return 7;
+}
+
+result read_header(bool fail) {
+    return read_byte(fail).transform([](int b) { return b * 2; });
+}
+
+// Turns backtraces on for the duration of a test.
+class TraceTests : public ::testing::Test {
+protected:
+    void SetUp() override { bst::enable_error_backtraces(true); }
+    void TearDown() override { bst::enable_error_backtraces(false); }
+};
+
+} // namespace
+
+//------------------------------------------------------------------------------
+
+TEST(TracedTests, RecordsTheCreationSite) {
+    auto r = read_header(true);
+    ASSERT_FALSE(r);
+    EXPECT_EQ(*r.error(), io_errc::timeout);
+    EXPECT_EQ(r.error().where().line(), static_cast<unsigned>(failing_line));
+    EXPECT_NE(std::string_view(r.error().where().function_name())
+                  .find("read_byte"),
+              std::string_view::npos);
+}
+
+TEST(TracedTests, NoBacktraceWhenDisabled) {
+    ASSERT_FALSE(bst::error_backtraces_enabled());
+    auto r = read_header(true);
+    EXPECT_TRUE(r.error().backtrace().empty());
+}
+
+TEST(TracedTests, ComparesTheError) {
+    bst::traced<io_errc> a(io_errc::eof);
+    bst::traced<io_errc> b(io_errc::eof);
+    EXPECT_EQ(a, b);
+    EXPECT_EQ(a, io_errc::eof);
+    EXPECT_NE(a, io_errc::timeout);
+    EXPECT_NE(a.where().line(), b.where().line());
+}
+
+TEST(TracedTests, CarriesAnyError) {
+    bst::expected<int, bst::traced<std::string>> r =
+        bst::unexpected_traced(std::string("no such file"));
+    EXPECT_EQ(r.error()->size(), 12u);
+    EXPECT_EQ(std::move(r).error().get(), "no such file");
+}
+
+TEST_F(TraceTests, CapturesABacktrace) {
+    auto r = read_header(true);
+    auto frames = r.error().backtrace();
+    ASSERT_FALSE(frames.empty());
+    EXPECT_LE(frames.size(), std::size_t{BST_EXPECTED_TRACE_DEPTH});
+
+    auto names = bst::symbolize(frames);
+    ASSERT_EQ(names.size(), frames.size());
+    for (const auto& n : names)
+        EXPECT_FALSE(n.empty());
+}
+
+TEST_F(TraceTests, CopiesShareTheBacktrace) {
+    auto r = read_header(true);
+    auto copy = r;
+    EXPECT_EQ(copy.error().backtrace().data(), r.error().backtrace().data());
+    EXPECT_EQ(copy.error().where().line(), r.error().where().line());
+}
+
+TEST_F(TraceTests, OldBacktracesAreOverwritten) {
+    auto first = read_header(true);
+    ASSERT_FALSE(first.error().backtrace().empty());
+
+    for (int i = 0; i < BST_EXPECTED_TRACE_RING_SIZE - 1; ++i)
+        static_cast<void>(read_header(true));
+    EXPECT_FALSE(first.error().backtrace().empty());
+
+    static_cast<void>(read_header(true));
+    EXPECT_TRUE(first.error().backtrace().empty());
+}
+
+TEST_F(TraceTests, OnlyReadableOnTheCreatingThread) {
+    auto r = read_header(true);
+    ASSERT_FALSE(r.error().backtrace().empty());
+
+    bool empty_elsewhere = false;
+    std::thread([&] {
+        static_cast<void>(read_header(true));
+        empty_elsewhere = r.error().backtrace().empty();
+    }).join();
+    EXPECT_TRUE(empty_elsewhere);
+    EXPECT_FALSE(r.error().backtrace().empty());
+}
+
+TEST(SymbolizeTests, Empty) { EXPECT_TRUE(bst::symbolize({}).empty()); }
@@ -0,0 +1,218 @@
+#include <expected/validated.hpp>
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+//------------------------------------------------------------------------------
+
+namespace {
+
+struct field_error {
+    std::string field;
+    std::string reason;
+
+    friend bool operator==(const field_error&, const field_error&) = default;
+};
+
+using checked_string = bst::expected<std::string, field_error>;
+using checked_int = bst::expected<int, field_error>;
+
+checked_string check_name(std::string s) {
+    if (s.empty())
+        return bst::unexpected(field_error{"name", "empty"});
+    return s;
+}
+
+checked_int check_port(int p) {
+    if (p <= 0 || p > 65535)
+        return bst::unexpected(field_error{"port", "out of range"});
+    return p;
+}
+
+struct endpoint {
+    endpoint(std::string host, int port) : host(std::move(host)), port(port) {}
+    endpoint(const endpoint&) = delete;
+    endpoint(endpoint&&) = delete;
+
+    std::string host;
+    int port;
+};
+
+std::vector<std::string> fields(const bst::error_list<field_error>& errors) {
+    std::vector<std::string> v;
+    for (const auto& e : errors)
+        v.push_back(e.field);
+    return v;
+}
+
+// Counts live instances; copying the one marked throws.
+struct throwing_copy {
+    static inline int live = 0;
+
+    explicit throwing_copy(bool fail) : fail(fail) { ++live; }
+    throwing_copy(const throwing_copy& x) : fail(x.fail) {
+        if (fail)
+            throw 1;
+        ++live;
+    }
+    throwing_copy(throwing_copy&& x) noexcept : fail(x.fail) { ++live; }
+    ~throwing_copy() { --live; }
+
+    bool fail;
+};
+
+} // namespace
+
+//------------------------------------------------------------------------------
+// error_list
+
+TEST(ErrorListTests, StaysInlineUpToN) {
+    bst::error_list<std::string, 2> l;
+    EXPECT_TRUE(l.empty());
+    l.push_back("a");
+    l.emplace_back(1, 'b');
+    EXPECT_TRUE(l.is_inline());
+    EXPECT_EQ(l.capacity(), 2u);
+
+    l.push_back("c");
+    EXPECT_FALSE(l.is_inline());
+    EXPECT_EQ(l.size(), 3u);
+    EXPECT_EQ(std::vector<std::string>(l.begin(), l.end()),
+              (std::vector<std::string>{"a", "b", "c"}));
+}
+
+TEST(ErrorListTests, EmplaceFromOwnElementWhileGrowing) {
+    bst::error_list<std::string, 1> l;
+    l.push_back("only");
+    l.push_back(l.front());
+    EXPECT_EQ(l[1], "only");
+}
+
+TEST(ErrorListTests, CopyAndMove) {
+    for (int n : {2, 5}) {
+        bst::error_list<std::unique_ptr<int>, 3> l;
+        for (int i = 0; i < n; ++i)
+            l.emplace_back(std::make_unique<int>(i));
+
+        auto moved = std::move(l);
+        EXPECT_TRUE(l.empty());
+        EXPECT_TRUE(l.is_inline());
+        ASSERT_EQ(moved.size(), static_cast<std::size_t>(n));
+        EXPECT_EQ(*moved.back(), n - 1);
+
+        l = std::move(moved);
+        EXPECT_EQ(l.size(), static_cast<std::size_t>(n));
+    }
+
+    bst::error_list<std::string, 1> a;
+    a.push_back("x");
+    a.push_back("y");
+    bst::error_list<std::string, 1> b(a);
+    EXPECT_EQ(a, b);
+    b = a;
+    EXPECT_EQ(b.size(), 2u);
+    b.clear();
+    EXPECT_TRUE(b.empty());
+}
+
+TEST(ErrorListTests, FailedCopyReleasesWhatItCopied) {
+    {
+        bst::error_list<throwing_copy, 2> l;
+        for (int i = 0; i < 4; ++i)
+            l.emplace_back(false);
+        l.emplace_back(true);
+        ASSERT_EQ(throwing_copy::live, 5);
+
+        using list = bst::error_list<throwing_copy, 2>;
+        EXPECT_THROW(list copy(l), int);
+        EXPECT_EQ(throwing_copy::live, 5);
+    }
+    EXPECT_EQ(throwing_copy::live, 0);
+}
+
+TEST(ErrorListTests, AppendAndCompareAcrossCapacities) {
+    bst::error_list<int, 2> a;
+    a.push_back(1);
+    bst::error_list<int, 8> b;
+    b.push_back(2);
+    b.push_back(3);
+    a.append(b);
+    bst::error_list<int, 8> c;
+    for (int i : {1, 2, 3})
+        c.push_back(i);
+    EXPECT_EQ(a, c);
+    EXPECT_NE(a, b);
+}
+
+//------------------------------------------------------------------------------
+// combine, zip
+
+TEST(CombineTests, BuildsTheValueInPlace) {
+    auto r = bst::combine<endpoint>(check_name("localhost"), check_port(80));
+    ASSERT_TRUE(r);
+    EXPECT_EQ(r->host, "localhost");
+    EXPECT_EQ(r->port, 80);
+}
+
+TEST(CombineTests, CollectsEveryError) {
+    auto r = bst::combine<endpoint>(check_name(""), check_port(0));
+    ASSERT_FALSE(r);
+    EXPECT_EQ(fields(r.error()), (std::vector<std::string>{"name", "port"}));
+    EXPECT_TRUE(r.error().is_inline());
+
+    auto one = bst::combine<endpoint>(check_name("h"), check_port(-1));
+    EXPECT_EQ(fields(one.error()), (std::vector<std::string>{"port"}));
+}
+
+TEST(CombineTests, NestsValidated) {
+    auto host = bst::combine<endpoint>(check_name(""), check_port(0));
+    auto r = bst::zip(
+        [](const endpoint& e, int retries) { return e.port * retries; },
+        std::move(host), checked_int(bst::unexpect, field_error{"retries", ""}));
+    ASSERT_FALSE(r);
+    EXPECT_EQ(fields(r.error()),
+              (std::vector<std::string>{"name", "port", "retries"}));
+}
+
+TEST(CombineTests, SpillsPastN) {
+    auto r = bst::combine<std::tuple<int, int, int>, 1>(
+        check_port(0), check_port(0), check_port(0));
+    ASSERT_FALSE(r);
+    EXPECT_EQ(r.error().size(), 3u);
+    EXPECT_FALSE(r.error().is_inline());
+}
+
+TEST(ZipTests, CallsFOnlyWhenAllSucceed) {
+    int calls = 0;
+    auto add = [&](int a, int b) {
+        ++calls;
+        return a + b;
+    };
+    auto ok = bst::zip(add, check_port(1), check_port(2));
+    EXPECT_EQ(ok, 3);
+
+    auto bad = bst::zip(add, check_port(1), check_port(0));
+    EXPECT_FALSE(bad);
+    EXPECT_EQ(calls, 1);
+}
+
+TEST(ZipTests, VoidResult) {
+    int sum = 0;
+    auto r = bst::zip([&](int a, int b) { sum = a + b; }, check_port(1),
+                      check_port(2));
+    static_assert(
+        std::is_same_v<decltype(r), bst::validated<void, field_error>>);
+    EXPECT_TRUE(r);
+    EXPECT_EQ(sum, 3);
+}
+
+TEST(ZipTests, MovesFromRvalueInputs) {
+    bst::expected<std::unique_ptr<int>, field_error> p(std::make_unique<int>(4));
+    auto r = bst::zip([](std::unique_ptr<int> q) { return *q; }, std::move(p));
+    EXPECT_EQ(r, 4);
+    EXPECT_EQ(*p, nullptr);
+}
@@ -0,0 +1,142 @@
+#include <expected/views.hpp>
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <ranges>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+//------------------------------------------------------------------------------
+
+namespace {
+
+using result = bst::expected<std::string, int>;
+
+std::vector<result> sample() {
+    return {result("a"), bst::unexpected(1), result("b"), bst::unexpected(2),
+            result("c")};
+}
+
+template <class R>
+auto to_vector(R&& r) {
+    std::vector<std::remove_cvref_t<std::ranges::range_reference_t<R>>> v;
+    for (auto&& x : r)
+        v.push_back(x);
+    return v;
+}
+
+} // namespace
+
+//------------------------------------------------------------------------------
+
+TEST(ViewsTests, Values) {
+    auto v = sample();
+    auto values = v | bst::views::values;
+    static_assert(
+        std::is_same_v<std::ranges::range_reference_t<decltype(values)>,
+                       std::string&>);
+    EXPECT_EQ(to_vector(values), (std::vector<std::string>{"a", "b", "c"}));
+
+    // References into the stored values.
+    for (std::string& s : values)
+        s += "!";
+    EXPECT_EQ(*v[2], "b!");
+
+    const auto& cv = v;
+    static_assert(std::is_same_v<
+                  std::ranges::range_reference_t<decltype(bst::views::values(
+                      cv))>,
+                  const std::string&>);
+}
+
+TEST(ViewsTests, Errors) {
+    auto v = sample();
+    EXPECT_EQ(to_vector(v | bst::views::errors), (std::vector<int>{1, 2}));
+
+    for (int& e : bst::views::errors(v))
+        e *= 10;
+    EXPECT_EQ(v[3].error(), 20);
+}
+
+TEST(ViewsTests, TakeUntilError) {
+    auto v = sample();
+    EXPECT_EQ(to_vector(v | bst::views::take_until_error),
+              (std::vector<std::string>{"a"}));
+
+    std::vector<result> all_values{result("x"), result("y")};
+    EXPECT_EQ(to_vector(all_values | bst::views::take_until_error),
+              (std::vector<std::string>{"x", "y"}));
+}
+
+TEST(ViewsTests, AndThen) {
+    auto v = sample();
+    auto sized = v | bst::views::and_then([](const std::string& s) {
+                     return s == "b" ? result(bst::unexpect, 3)
+                                     : result(s + s);
+                 });
+    EXPECT_EQ(to_vector(sized | bst::views::values),
+              (std::vector<std::string>{"aa", "cc"}));
+    EXPECT_EQ(to_vector(sized | bst::views::errors),
+              (std::vector<int>{1, 3, 2}));
+}
+
+TEST(ViewsTests, ComputedElementsAreReadOnce) {
+    auto v = sample();
+    int calls = 0;
+    auto doubled = v | bst::views::and_then([&](const std::string& s) {
+                       ++calls;
+                       return result(s + s);
+                   });
+
+    EXPECT_EQ(to_vector(doubled | bst::views::values),
+              (std::vector<std::string>{"aa", "bb", "cc"}));
+    EXPECT_EQ(calls, 3);
+
+    calls = 0;
+    EXPECT_EQ(to_vector(doubled | bst::views::take_until_error),
+              (std::vector<std::string>{"aa"}));
+    EXPECT_EQ(calls, 1);
+
+    calls = 0;
+    EXPECT_EQ(to_vector(doubled | bst::views::errors),
+              (std::vector<int>{1, 2}));
+    EXPECT_EQ(calls, 3);
+}
+
+TEST(ViewsTests, LazyInputRanges) {
+    // A single-pass range of temporaries: the views yield copies.
+    std::istringstream in("1 -2 3 -4 5");
+    auto parsed = std::views::istream<int>(in) |
+                  std::views::transform([](int x) {
+                      return x < 0 ? bst::expected<int, int>(bst::unexpect, x)
+                                   : bst::expected<int, int>(x);
+                  });
+    auto values = parsed | bst::views::take_until_error;
+    static_assert(
+        std::is_same_v<std::ranges::range_reference_t<decltype(values)>, int>);
+
+    std::vector<int> seen;
+    for (int x : values)
+        seen.push_back(x);
+    EXPECT_EQ(seen, (std::vector<int>{1}));
+
+    // Nothing past the error was read.
+    int next = 0;
+    in >> next;
+    EXPECT_EQ(next, 3);
+}
+
+TEST(ViewsTests, MoveOnlyPayloads) {
+    using E = bst::expected<std::unique_ptr<int>, int>;
+    std::vector<E> v;
+    v.emplace_back(std::make_unique<int>(4));
+    v.emplace_back(bst::unexpect, 1);
+
+    int sum = 0;
+    for (const auto& p : v | bst::views::values)
+        sum += *p;
+    EXPECT_EQ(sum, 4);
+}